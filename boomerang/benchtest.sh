@@ -0,0 +1,111 @@
+#!/bin/bash
+# benchtest.sh performance regression test script
+# Decompiles the test programs of several platforms, a few at a time, with the -B switch so that boomerang records the
+# wall time of each phase, its peak memory use and the size of the IR. The results are compared with a baseline, and
+# any test whose phase times or peak memory grew by more than the threshold is reported as a regression.
+#
+# Usage: ./benchtest.sh [-j jobs] [-t percent] [-b baseline] [-u] [boomerang switches]
+#	-j jobs			number of decompilations to run at once (default: the number of processors)
+#	-t percent		regression threshold (default 10%)
+#	-b baseline		baseline file (default benchtest.baseline)
+#	-u				write the results as the new baseline instead of comparing
+# The results are left in benchtest/results, one line per test:
+#	test decode decompile codegen total peakKB procs bbs stmts exps proofs proofsTrue proofsOutOfBudget proofCacheHits
+#	sigClonesAvoided defaultSigsReused
+# (times in seconds). The exit status is 1 if there was a regression.
+#
+
+JOBS=`getconf _NPROCESSORS_ONLN 2>/dev/null || echo 1`
+THRESHOLD=10
+BASELINE=benchtest.baseline
+UPDATE=0
+while getopts "j:t:b:u" opt; do
+	case $opt in
+		j) JOBS=$OPTARG;;
+		t) THRESHOLD=$OPTARG;;
+		b) BASELINE=$OPTARG;;
+		u) UPDATE=1;;
+		*) echo "usage: $0 [-j jobs] [-t percent] [-b baseline] [-u] [boomerang switches]"; exit 2;;
+	esac
+done
+shift $((OPTIND - 1))
+
+# Store the remaining command line switches in BOOMSW
+export BOOMSW=$*
+PLATFORMS="pentium sparc ppc OSX windows"
+
+# Clean up
+rm -rf benchtest
+mkdir benchtest
+
+# Decompile one test program, e.g. test/sparc/fib; its statistics go to benchtest/sparc-fib.stats
+benchOne() {
+	NAME=`echo $1 | sed -e 's|^test/||' -e 's|/|-|g'`
+	sh -c "./boomerang -o benchtest/$NAME -B benchtest/$NAME.stats $BOOMSW $1 >/dev/null 2>&1"
+	echo -n "."
+}
+export -f benchOne
+
+# Run the tests. Skip the assembler sources and .sed corrections that live beside the programs
+for p in $PLATFORMS; do
+	for f in test/$p/*; do
+		if [[ -f $f ]]; then
+			case $f in
+				*.s|*.sed|*.c|*.h|*.txt) ;;
+				*) echo $f;;
+			esac
+		fi
+	done
+done > benchtest/tests
+echo "Running `wc -l < benchtest/tests` tests, $JOBS at a time"
+xargs -P $JOBS -n 1 bash -c 'benchOne "$0"' < benchtest/tests
+echo
+
+# Gather one line per test; a test with no statistics did not get as far as writing its code
+while read f; do
+	NAME=`echo $f | sed -e 's|^test/||' -e 's|/|-|g'`
+	if [[ -f benchtest/$NAME.stats ]]; then
+		echo "$NAME `awk '{ printf "%s ", $2 }' benchtest/$NAME.stats`"
+	else
+		echo "$NAME FAILED"
+	fi
+done < benchtest/tests | sort > benchtest/results
+
+if [[ $UPDATE -eq 1 ]]; then
+	cp benchtest/results $BASELINE
+	echo "Baseline written to $BASELINE"
+	exit 0
+fi
+if [[ ! -f $BASELINE ]]; then
+	echo "No baseline $BASELINE; run with -u to make one"
+	exit 2
+fi
+
+# Compare with the baseline. Times below 0.05 seconds are too noisy to compare; IR size changes are reported but
+# are not regressions
+awk -v thr=$THRESHOLD '
+	BEGIN { col[2] = "decode"; col[3] = "decompile"; col[4] = "codegen"; col[5] = "total"; col[6] = "peakKB"
+			col[7] = "procs"; col[8] = "bbs"; col[9] = "stmts"; col[10] = "exps"
+			col[11] = "proofs"; col[12] = "proofsTrue"; col[13] = "proofsOutOfBudget"; col[14] = "proofCacheHits"
+			col[15] = "sigClonesAvoided"; col[16] = "defaultSigsReused" }
+	NR == FNR { seen[$1] = 1; for (i = 2; i <= NF; i++) base[$1, i] = $i; next }
+	!($1 in seen) { print $1 ": not in the baseline"; next }
+	$2 == "FAILED" { if (base[$1, 2] != "FAILED") { print $1 ": FAILED"; bad = 1 }; next }
+	base[$1, 2] == "FAILED" { print $1 ": now decompiles"; next }
+	{
+		oldTotal += base[$1, 5]; newTotal += $5
+		for (i = 2; i <= 6; i++) {
+			if (i < 6 && base[$1, i] < 0.05) continue
+			if ($i > base[$1, i] * (1 + thr / 100)) {
+				printf "%s: %s regressed from %s to %s\n", $1, col[i], base[$1, i], $i
+				bad = 1
+			}
+		}
+		for (i = 7; i <= 16; i++)
+			if (base[$1, i] != "" && $i != base[$1, i])
+				printf "%s: %s changed from %s to %s\n", $1, col[i], base[$1, i], $i
+	}
+	END {
+		printf "Total time %.2f sec, baseline %.2f sec\n", newTotal, oldTotal
+		exit bad
+	}' $BASELINE benchtest/results
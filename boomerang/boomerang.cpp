@@ -30,17 +30,27 @@
 #include <sys/stat.h>		// For mkdir
 #include <unistd.h>			// For unlink
 #include <csignal>
+#include <sys/time.h>		// For gettimeofday
+#include <sys/resource.h>	// For getrusage
+#include <sys/socket.h>		// For the -K service
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <sys/select.h>
+#include <fcntl.h>			// For open
 #endif
+#include <sstream>
+#include <set>
 #if defined(_MSC_VER) || defined(__MINGW32__)
 #include <windows.h>
 #endif
 #include "prog.h"
 #include "proc.h"
+#include "signature.h"
 #include "BinaryFile.h"
 #include "frontend.h"
 #include "hllcode.h"
 #include "codegen/chllcode.h"
-//#include "transformer.h"
+#include "transformer.h"
 #include "boomerang.h"
 #include "log.h"
 #if USE_XML
@@ -66,7 +76,7 @@ Boomerang *Boomerang::boomerang = NULL;
  * - The path to the executable is "./"
  * - The output directory is "./output/"
  */
-Boomerang::Boomerang() : logger(NULL), vFlag(false), printRtl(false),
+Boomerang::Boomerang() : logger(NULL), watchersMutex(true), vFlag(false), printRtl(false),
     noBranchSimplify(false), noRemoveNull(false), noLocals(false),
     noRemoveLabels(false), noDataflow(false), noDecompile(false), stopBeforeDecompile(false),
     traceDecoder(false), dotFile(NULL), numToPropagate(-1),
@@ -76,9 +86,10 @@ Boomerang::Boomerang() : logger(NULL), vFlag(false), printRtl(false),
     noRemoveReturns(false), debugDecoder(false), decodeThruIndCall(false), ofsIndCallReport(NULL),
     noDecodeChildren(false), debugProof(false), debugUnused(false),
     loadBeforeDecompile(false), saveBeforeDecompile(false),
-    noProve(false), noChangeSignatures(false), conTypeAnalysis(false), dfaTypeAnalysis(true),
-    propMaxDepth(3), generateCallGraph(false), generateSymbols(false), noGlobals(false), assumeABI(false),
-    experimental(false), minsToStopAfter(0)
+    noProve(false), proofStepLimit(0), proofTimeLimit(0), noChangeSignatures(false), conTypeAnalysis(false), dfaTypeAnalysis(true),
+    useTransformations(false), propMaxDepth(3), generateCallGraph(false), generateSymbols(false), noGlobals(false), assumeABI(false),
+    experimental(false), minsToStopAfter(0), codeGenThreads(1), statsFile(NULL),
+    serviceSocket(NULL), serviceJobs(4), serviceTimeLimit(0), serviceMemLimit(0), scanThreads(0), batchJobs(0)
 {
     progPath = "./";
     outputPath = "./output/";
@@ -96,7 +107,11 @@ Log &Boomerang::log()
  * Sets the outputfile to be the file "log" in the default output directory.
  */
 FileLogger::FileLogger() : out((Boomerang::get()->getOutputPath() + "log").c_str())
-{}
+{
+#if HAVE_THREADS
+    mainThread = pthread_self();
+#endif
+}
 
 /**
  * Returns the HLLCode for the given proc.
@@ -112,6 +127,7 @@ HLLCode *Boomerang::getHLLCode(UserProc *p)
 void Boomerang::usage()
 {
     std::cout << "Usage: boomerang [ switches ] <program>" << std::endl;
+    std::cout << "       boomerang -b <num> [ switches ] <program or archive> ..." << std::endl;
     std::cout << "boomerang -h for switch help" << std::endl;
     exit(1);
 }
@@ -158,10 +174,13 @@ void Boomerang::help()
     std::cout << "  -E <addr>        : Decode the procedure at addr, no callees\n";
     std::cout << "                     Use -e and -E repeatedly for multiple entry points\n";
     std::cout << "  -ic              : Decode through type 0 Indirect Calls\n";
+    std::cout << "  -F <threads>     : Find procs not reached from the entry points by scanning the code\n";
+    std::cout << "                     for prologues and call targets (with threads threads)\n";
     std::cout << "  -S <min>         : Stop decompilation after specified number of minutes\n";
     std::cout << "  -t               : Trace (print address of) every instruction decoded\n";
     std::cout << "  -Tc              : Use old constraint-based type analysis\n";
     std::cout << "  -Td              : Use data-flow-based type analysis\n";
+    std::cout << "  -Tr              : Apply the rules in transformations/ when simplifying\n";
 #if USE_XML
     std::cout << "  -LD              : Load before decompile (<program> becomes xml input file)\n";
     std::cout << "  -SD              : Save before decompile\n";
@@ -179,8 +198,18 @@ void Boomerang::help()
     std::cout << "  -gc              : Generate a call graph (callgraph.out and callgraph.dot)\n";
     std::cout << "  -gs              : Generate a symbol file (symbols.h)\n";
     std::cout << "  -iw              : Write indirect call report to output/indirect.txt\n";
+    std::cout << "  -j <num>         : Generate code with num threads (experimental)\n";
+    std::cout << "  -B <file>        : Write phase times, peak memory and IR sizes to file (see benchtest.sh)\n";
     std::cout << "Misc.\n";
     std::cout << "  -k               : Command mode, for available commands see -h cmd\n";
+    std::cout << "  -K <socket>      : Service mode: take decompile jobs on a UNIX socket. A job is one\n";
+    std::cout << "                     line of switches and a program; the output is sent back.\n";
+    std::cout << "                     A job may not give -K, -k, -b or -S\n";
+    std::cout << "  -Kj <num>        : Run up to num service jobs at once (default 4)\n";
+    std::cout << "  -Kt <secs>       : Kill a service job after secs seconds\n";
+    std::cout << "  -Km <MB>         : Limit each service job to MB megabytes of memory\n";
+    std::cout << "  -b <num>         : Batch mode: decompile all the programs given, and every member\n";
+    std::cout << "                     of any archive (.a) given, num at a time\n";
     std::cout << "  -P <path>        : Path to Boomerang files, defaults to where you run\n";
     std::cout << "                     Boomerang from\n";
     std::cout << "  -X               : activate eXperimental code; errors likely\n";
@@ -212,6 +241,8 @@ void Boomerang::help()
     std::cout << "  -nR              : No removal of unused Returns\n";
     std::cout << "  -l <depth>       : Limit multi-propagations to expressions with depth <depth>\n";
     std::cout << "  -p <num>         : Only do num propagations\n";
+    std::cout << "  -ps <num>        : Give up a proof after num prover steps\n";
+    std::cout << "  -pt <msecs>      : Give up a proof after msecs milliseconds\n";
     std::cout << "  -m <num>         : Max memory depth\n";
     exit(1);
 }
@@ -766,6 +797,450 @@ int Boomerang::cmdLine()
     return 0;
 }
 
+#ifndef _WIN32
+// Say how a child process ended, given its status from waitpid()
+static std::string howEnded(int status)
+{
+    std::ostringstream ost;
+    if (WIFEXITED(status))
+        ost << "exited with status " << WEXITSTATUS(status);
+    else
+        {
+            ost << "killed by signal " << WTERMSIG(status);
+            if (WTERMSIG(status) == SIGALRM)
+                ost << " (time limit)";
+        }
+    return ost.str();
+}
+
+#define MAX_JOB_LINE	4096			// The longest job line accepted, in characters
+
+/**
+ * Checks a word of a job line. A job may not give the switches that would make it a service (-K...), read the
+ * service's input (-k), fork jobs of its own (-b), or outlast the service's time limit (-S).
+ *
+ * \param word	The word.
+ *
+ * \return True if the word can be in a job.
+ */
+static bool allowedInJob(const char *word)
+{
+    if (word[0] != '-')
+        return true;
+    switch (word[1])
+        {
+        case 'K':
+        case 'k':
+        case 'b':
+            return false;
+        case 'S':
+            return word[2] == 'D';		// -SD saves the XML; -S <min> sets a time limit
+        default:
+            return true;
+        }
+}
+
+/**
+ * Runs one job of the service, in a process of its own forked from the service. The job is one line read from the
+ * client: switches and a program, as on the command line. Anything the job prints goes back to the client. The
+ * switches given to the service apply to every job, and each job's output goes to its own directory under the
+ * service's output path unless the job gives -o. A line that is too long, or that has a switch a job may not give
+ * (see allowedInJob()), fails the job.
+ *
+ * \param fd	The connection to the client.
+ * \param job	The number of the job.
+ *
+ * \return The exit status for the job.
+ */
+int Boomerang::runJob(int fd, int job)
+{
+    if (serviceTimeLimit)
+        alarm(serviceTimeLimit);		// The default action for SIGALRM ends the job
+    std::string line;
+    char ch;
+    bool tooLong = false;
+    while (read(fd, &ch, 1) == 1 && ch != '\n')
+        {
+            if (line.size() < MAX_JOB_LINE)
+                line += ch;
+            else
+                tooLong = true;			// Read the rest anyway, so the client gets the reply
+        }
+    dup2(fd, 1);
+    dup2(fd, 2);
+    close(fd);
+    int devNull = open("/dev/null", O_RDONLY);	// Nothing in a job reads the service's input
+    if (devNull >= 0)
+        {
+            dup2(devNull, 0);
+            close(devNull);
+        }
+    setvbuf(stdout, NULL, _IOLBF, BUFSIZ);		// Send the output as it comes
+    if (tooLong)
+        {
+            std::cerr << "job line longer than " << MAX_JOB_LINE << " characters\n";
+            return 1;
+        }
+
+    if (serviceMemLimit)
+        {
+            struct rlimit rl;
+            rl.rlim_cur = rl.rlim_max = (rlim_t)serviceMemLimit << 20;
+            setrlimit(RLIMIT_AS, &rl);
+        }
+
+    std::vector<char> buf(line.begin(), line.end());
+    buf.push_back('\0');
+    std::vector<const char*> words;
+    for (const char *p = strtok(&buf[0], " \r\n"); p; p = strtok(NULL, " \r\n"))
+        {
+            if (!allowedInJob(p))
+                {
+                    std::cerr << p << " is not allowed in a job\n";
+                    return 1;
+                }
+            words.push_back(p);
+        }
+    if (words.empty())
+        {
+            std::cerr << "no program given\n";
+            return 1;
+        }
+    std::string argv0 = progPath + "boomerang";		// commandLine() gets progPath back from this
+    std::ostringstream dir;
+    dir << outputPath << "job" << job << "/";
+    std::string jobDir = dir.str();
+    std::vector<const char*> args;
+    args.push_back(argv0.c_str());
+    args.push_back("-o");
+    args.push_back(jobDir.c_str());
+    args.insert(args.end(), words.begin(), words.end());
+
+    serviceSocket = NULL;				// A job is not a service
+    logger = NULL;						// The service's log stays the service's
+    return commandLine(args.size(), &args[0]);
+}
+#endif
+
+/**
+ * Service mode. Reads the SSL files and library signatures of every platform once, then takes decompile jobs on a
+ * UNIX socket. Each connection is one job (see runJob()), run in a process forked from this one, so it starts with
+ * everything already read and has its own Prog. Up to serviceJobs jobs run at once; the rest wait to be accepted.
+ * When a job ends, a last line saying how it ended is sent to its client.
+ *
+ * Jobs are processes and not threads because much of the decompiler's state is global (the Boomerang object, named
+ * types, the proof engine, the decoders' dictionaries).
+ *
+ * \param socketPath	The path of the socket to listen on.
+ *
+ * \return Nonzero if the service could not start; otherwise it does not return.
+ */
+int Boomerang::serve(const char *socketPath)
+{
+#ifdef _WIN32
+    std::cerr << "service mode needs UNIX sockets\n";
+    return 1;
+#else
+    if (!createDirectory(outputPath))
+        {
+            std::cerr << "can't create " << outputPath << "\n";
+            return 1;
+        }
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socketPath, sizeof(addr.sun_path) - 1);
+    unlink(socketPath);
+    // Only the service's user may connect: a job can write anywhere the service can
+    mode_t oldMask = umask(0077);
+    bool bound = listener >= 0 && bind(listener, (struct sockaddr*)&addr, sizeof(addr)) == 0;
+    umask(oldMask);
+    if (!bound || listen(listener, 16) < 0)
+        {
+            std::cerr << "can't listen on " << socketPath << "\n";
+            return 1;
+        }
+    signal(SIGPIPE, SIG_IGN);			// A client that goes away must not take the service with it
+
+    std::cout << "reading SSL files and signatures...\n";
+    FrontEnd::warmCaches();
+    std::cout << "listening on " << socketPath << std::endl;
+
+    std::map<pid_t, std::pair<int, int> > jobs;		// Running jobs: pid to connection and job number
+    int numJobs = 0;
+    while (true)
+        {
+            // Tell the clients of finished jobs how they ended. Wait for one if no more can be run
+            int status;
+            pid_t pid;
+            while (!jobs.empty() && (pid = waitpid(-1, &status, (int)jobs.size() >= serviceJobs ? 0 : WNOHANG)) > 0)
+                {
+                    std::map<pid_t, std::pair<int, int> >::iterator it = jobs.find(pid);
+                    if (it == jobs.end())
+                        continue;
+                    std::ostringstream ost;
+                    ost << "job " << it->second.second << " " << howEnded(status) << "\n";
+                    std::string msg = ost.str();
+                    write(it->second.first, msg.c_str(), msg.size());		// Fails harmlessly if the client went away
+                    close(it->second.first);
+                    std::cout << msg << std::flush;
+                    jobs.erase(it);
+                }
+
+            // Wait a while for a new job; then look for finished ones again
+            fd_set fds;
+            FD_ZERO(&fds);
+            FD_SET(listener, &fds);
+            struct timeval tv;
+            tv.tv_sec = 1;
+            tv.tv_usec = 0;
+            if (select(listener + 1, &fds, NULL, NULL, &tv) <= 0)
+                continue;
+            int fd = accept(listener, NULL, NULL);
+            if (fd < 0)
+                continue;
+            numJobs++;
+            std::cout.flush();
+            fflush(stdout);
+            pid = fork();
+            if (pid == 0)
+                {
+                    close(listener);
+                    int ret = runJob(fd, numJobs);
+                    std::cout.flush();
+                    exit(ret);
+                }
+            if (pid < 0)
+                {
+                    std::cerr << "can't start job " << numJobs << "\n";
+                    close(fd);
+                    continue;
+                }
+            std::cout << "job " << numJobs << " started" << std::endl;
+            jobs[pid] = std::pair<int, int>(fd, numJobs);
+        }
+#endif
+}
+
+// One program to decompile in batch mode
+struct BatchInput
+{
+    std::string	name;				// The name to report it by
+    std::string	file;				// The program
+    std::string	outDir;				// Where its output goes
+    std::string	archive;			// The archive it is a member of, or "" if none
+    std::streamoff offset;			// Where the member is in the archive
+    unsigned long size;				// The size of the member
+};
+
+// Return name made unique by adding .2, .3 etc as needed
+static std::string uniqueName(const std::string &name, std::set<std::string> &used)
+{
+    std::string unique = name;
+    for (int n = 2; used.find(unique) != used.end(); n++)
+        {
+            std::ostringstream ost;
+            ost << name << "." << n;
+            unique = ost.str();
+        }
+    used.insert(unique);
+    return unique;
+}
+
+/**
+ * Finds the members of a Unix archive (.a), for batch mode. Each member gets its own directory under dir, which is
+ * where the member is extracted to (by the process that decompiles it) and where its output goes. The GNU and BSD
+ * forms of long names are understood; the symbol table and long name table are not members.
+ *
+ * \param path		The archive.
+ * \param dir		The output directory for the archive.
+ * \param inputs	The programs to decompile; the members are added to it.
+ *
+ * \return False if path is not an archive.
+ */
+static bool readArchive(const char *path, const std::string &dir, std::vector<BatchInput> &inputs)
+{
+    std::ifstream ifs(path, std::ios::in | std::ios::binary);
+    char magic[8];
+    if (!ifs.read(magic, 8) || memcmp(magic, "!<arch>\n", 8) != 0)
+        return false;
+    std::string longNames;
+    std::set<std::string> used;
+    char hdr[60];
+    while (ifs.read(hdr, 60))
+        {
+            std::string name(hdr, 16);
+            name = name.substr(0, name.find_last_not_of(' ') + 1);
+            unsigned long size = strtoul(std::string(hdr + 48, 10).c_str(), NULL, 10);
+            std::streamoff offset = ifs.tellg();
+            std::streamoff next = offset + size + (size & 1);		// Members are 2 byte aligned
+            if (name == "//")
+                {
+                    // GNU long name table
+                    std::vector<char> data(size + 1);
+                    ifs.read(&data[0], size);
+                    longNames.assign(data.begin(), data.begin() + size);
+                }
+            if (name == "/" || name == "//" || name == "/SYM64/" || name.compare(0, 9, "__.SYMDEF") == 0)
+                {
+                    ifs.seekg(next);
+                    continue;
+                }
+            if (name.compare(0, 3, "#1/") == 0)
+                {
+                    // BSD long name: the name is the first part of the data
+                    unsigned long len = strtoul(name.c_str() + 3, NULL, 10);
+                    if (len > size)
+                        break;
+                    std::vector<char> data(len + 1);
+                    ifs.read(&data[0], len);
+                    name = &data[0];
+                    offset += len;
+                    size -= len;
+                }
+            else if (name.size() > 1 && name[0] == '/')
+                {
+                    // GNU long name: the offset of the name in the long name table
+                    unsigned long off = strtoul(name.c_str() + 1, NULL, 10);
+                    if (off < longNames.size())
+                        name = longNames.substr(off, longNames.find('\n', off) - off);
+                }
+            if (!name.empty() && name[name.size()-1] == '/')
+                name.erase(name.size()-1);				// GNU names end with a slash
+            size_t slash = name.find_last_of("/\\");
+            if (slash != std::string::npos)
+                name = name.substr(slash + 1);
+            if (name.empty())
+                name = "member";
+            BatchInput in;
+            in.name = std::string(path) + "(" + name + ")";
+            in.outDir = dir + uniqueName(name, used) + "/";
+            in.file = in.outDir + name;
+            in.archive = path;
+            in.offset = offset;
+            in.size = size;
+            inputs.push_back(in);
+            ifs.seekg(next);
+        }
+    return true;
+}
+
+// Copy an archive member out to its file
+static bool extractMember(const BatchInput &in)
+{
+    std::ifstream ifs(in.archive.c_str(), std::ios::in | std::ios::binary);
+    std::ofstream ofs(in.file.c_str(), std::ios::out | std::ios::binary);
+    ifs.seekg(in.offset);
+    std::vector<char> buf(65536);
+    for (unsigned long left = in.size; left; )
+        {
+            unsigned long n = left < buf.size() ? left : buf.size();
+            if (!ifs.read(&buf[0], n))
+                return false;
+            ofs.write(&buf[0], n);
+            left -= n;
+        }
+    return ofs.good();
+}
+
+/**
+ * Batch mode. Decompiles each program given, and each member of each archive given, in a process of its own forked
+ * from this one, up to batchJobs at a time. The SSL files and library signatures are read once, before any of them
+ * starts (see FrontEnd::warmCaches()). Each program's output goes to its own directory under the output path (one
+ * per program, and for an archive, one per member under one for the archive), along with what it printed
+ * (boomerang.out) and, for a member, the member itself.
+ *
+ * \param numInputs	The number of programs and archives.
+ * \param inputs	The names of the programs and archives.
+ *
+ * \return Zero if every program was decompiled, nonzero otherwise.
+ */
+int Boomerang::batch(int numInputs, const char **inputs)
+{
+#ifdef _WIN32
+    std::cerr << "batch mode needs fork()\n";
+    return 1;
+#else
+    std::vector<BatchInput> progs;
+    std::set<std::string> used;
+    for (int i = 0; i < numInputs; i++)
+        {
+            std::string name(inputs[i]);
+            size_t slash = name.find_last_of("/\\");
+            if (slash != std::string::npos)
+                name = name.substr(slash + 1);
+            std::string dir = outputPath + uniqueName(name, used) + "/";
+            if (readArchive(inputs[i], dir, progs))
+                continue;
+            BatchInput in;
+            in.name = inputs[i];
+            in.file = inputs[i];
+            in.outDir = dir;
+            in.offset = 0;
+            in.size = 0;
+            progs.push_back(in);
+        }
+
+    std::cout << "reading SSL files and signatures...\n";
+    FrontEnd::warmCaches();
+    std::cout << "decompiling " << progs.size() << " programs, " << batchJobs << " at a time\n";
+
+    std::map<pid_t, unsigned> running;		// Running decompilations: pid to index in progs
+    unsigned next = 0;
+    int failed = 0;
+    while (next < progs.size() || !running.empty())
+        {
+            if (next < progs.size() && (int)running.size() < batchJobs)
+                {
+                    std::cout.flush();
+                    fflush(stdout);
+                    pid_t pid = fork();
+                    if (pid == 0)
+                        {
+                            BatchInput &in = progs[next];
+                            createDirectory(in.outDir);
+                            freopen((in.outDir + "boomerang.out").c_str(), "w", stdout);
+                            dup2(fileno(stdout), 2);
+                            logger = NULL;					// Each program gets a log of its own
+                            setOutputDirectory(in.outDir.c_str());
+                            if (!in.archive.empty() && !extractMember(in))
+                                {
+                                    std::cerr << "can't extract " << in.name << "\n";
+                                    exit(1);
+                                }
+                            int ret = decompile(in.file.c_str());
+                            std::cout.flush();
+                            exit(ret);
+                        }
+                    if (pid < 0)
+                        {
+                            std::cerr << "can't start " << progs[next].name << "\n";
+                            failed++;
+                        }
+                    else
+                        running[pid] = next;
+                    next++;
+                    continue;
+                }
+            int status;
+            pid_t pid = wait(&status);
+            if (pid < 0)
+                break;
+            std::map<pid_t, unsigned>::iterator it = running.find(pid);
+            if (it == running.end())
+                continue;
+            bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+            if (!ok)
+                failed++;
+            std::cout << progs[it->second].name << ": " << (ok ? "done" : howEnded(status)) << std::endl;
+            running.erase(it);
+        }
+    std::cout << progs.size() - failed << " of " << progs.size() << " programs decompiled\n";
+    return failed != 0;
+#endif
+}
+
 /**
  * The main function for the command line mode. Parses switches and runs decompile(filename).
  *
@@ -818,11 +1293,15 @@ int Boomerang::commandLine(int argc, const char **argv)
         }
 
     int kmd = 0;
+    int firstProg = argc;				// In batch mode, the first of the programs
 
     for (int i=1; i < argc; i++)
         {
-            if (argv[i][0] != '-' && i == argc - 1)
-                break;
+            if (argv[i][0] != '-' && (i == argc - 1 || batchJobs))
+                {
+                    firstProg = i;
+                    break;
+                }
             if (argv[i][0] != '-')
                 usage();
             switch (argv[i][1])
@@ -856,6 +1335,8 @@ int Boomerang::commandLine(int argc, const char **argv)
                         }
                     else if (argv[i][2] == 'd')
                         dfaTypeAnalysis = true;		// -Td: use data-flow-based type analysis (now default)
+                    else if (argv[i][2] == 'r')
+                        useTransformations = true;	// -Tr: apply the rules in transformations/ when simplifying
                     break;
                 case 'g':
                     if (argv[i][2]=='d')
@@ -882,6 +1363,15 @@ int Boomerang::commandLine(int argc, const char **argv)
                             propOnlyToAll = true;
                             std::cerr << " * * Warning! -pa is not implemented yet!\n";
                         }
+                    else if (argv[i][2] == 's' || argv[i][2] == 't')
+                        {
+                            if (++i == argc)
+                                {
+                                    usage();
+                                    return 1;
+                                }
+                            sscanf(argv[i], "%u", argv[i-1][2] == 's' ? &proofStepLimit : &proofTimeLimit);
+                        }
                     else
                         {
                             if (++i == argc)
@@ -1073,6 +1563,50 @@ int Boomerang::commandLine(int argc, const char **argv)
                 case 'k':
                     kmd = 1;
                     break;
+                case 'F':
+                    if (++i == argc)
+                        {
+                            usage();
+                            return 1;
+                        }
+                    sscanf(argv[i], "%i", &scanThreads);
+                    if (scanThreads < 1)
+                        scanThreads = 1;
+                    break;
+                case 'b':
+                    if (++i == argc)
+                        {
+                            usage();
+                            return 1;
+                        }
+                    sscanf(argv[i], "%i", &batchJobs);
+                    if (batchJobs < 1)
+                        batchJobs = 1;
+                    break;
+                case 'K':
+                    if (++i == argc)
+                        {
+                            usage();
+                            return 1;
+                        }
+                    switch (argv[i-1][2])
+                        {
+                        case '\0':
+                            serviceSocket = argv[i];
+                            break;
+                        case 'j':
+                            sscanf(argv[i], "%i", &serviceJobs);
+                            break;
+                        case 't':
+                            sscanf(argv[i], "%u", &serviceTimeLimit);
+                            break;
+                        case 'm':
+                            sscanf(argv[i], "%u", &serviceMemLimit);
+                            break;
+                        default:
+                            help();
+                        }
+                    break;
                 case 'P':
                     progPath = argv[++i];
                     if (progPath[progPath.length()-1] != '\\')
@@ -1089,16 +1623,42 @@ int Boomerang::commandLine(int argc, const char **argv)
                         }
                     sscanf(argv[i], "%i", &propMaxDepth);
                     break;
+                case 'j':
+                    if (++i == argc)
+                        {
+                            usage();
+                            return 1;
+                        }
+                    sscanf(argv[i], "%i", &codeGenThreads);
+                    break;
+                case 'B':
+                    if (++i == argc)
+                        {
+                            usage();
+                            return 1;
+                        }
+                    statsFile = argv[i];
+                    break;
                 default:
                     help();
                 }
         }
 
+    if (serviceSocket)
+        return serve(serviceSocket);
+
     setOutputDirectory(outputPath.c_str());
 
     if (kmd)
         return cmdLine();
 
+    if (batchJobs)
+        {
+            if (firstProg == argc)
+                usage();
+            return batch(argc - firstProg, argv + firstProg);
+        }
+
     return decompile(argv[argc-1]);
 }
 
@@ -1225,6 +1785,15 @@ Prog *Boomerang::loadAndDecode(const char *fname, const char *pname)
                 }
         }
 
+    if (scanThreads)
+        {
+            std::cout << "scanning for procs...\n";
+            int n = fe->decodeProcCandidates(prog, scanThreads);
+            std::cout << "found " << n << " more procs by scanning\n";
+            if (!noDecodeChildren && n)
+                fe->decode(prog, NO_ADDRESS);		// Their callees
+        }
+
     std::cout << "finishing decode...\n";
     prog->finishDecode();
 
@@ -1275,6 +1844,75 @@ void stopProcess(int n)
 }
 #endif
 
+// Wall clock time in seconds, for the -B statistics
+static double wallTime()
+{
+#if defined(_WIN32)
+    return GetTickCount() / 1000.0;
+#else
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+#endif
+}
+
+// Peak resident set size in KB, or 0 where it is not known
+static long peakMemory()
+{
+#if defined(_WIN32)
+    return 0;
+#else
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+#ifdef __APPLE__
+    return ru.ru_maxrss / 1024;		// Bytes on OS X
+#else
+    return ru.ru_maxrss;
+#endif
+#endif
+}
+
+/**
+ * Writes the statistics asked for with -B: the wall time of each phase, the peak memory use, and the size of the
+ * IR. There is one "name value" pair per line, as read by benchtest.sh.
+ */
+static void writeStats(const char *fname, Prog *prog, double decodeTime, double decompileTime, double codeTime)
+{
+    std::ofstream out(fname);
+    if (!out)
+        {
+            std::cerr << "cannot open " << fname << " for writing statistics\n";
+            return;
+        }
+    int procs = 0, bbs = 0, stmts = 0;
+    PROGMAP::const_iterator it;
+    for (Proc *p = prog->getFirstProc(it); p; p = prog->getNextProc(it))
+        {
+            if (p->isLib()) continue;
+            UserProc *u = (UserProc*)p;
+            procs++;
+            bbs += u->getCFG()->getNumBBs();
+            StatementList sl;
+            u->getStatements(sl);
+            stmts += sl.size();
+        }
+    out << "decode " << decodeTime << "\n";
+    out << "decompile " << decompileTime << "\n";
+    out << "codegen " << codeTime << "\n";
+    out << "total " << decodeTime + decompileTime + codeTime << "\n";
+    out << "peakKB " << peakMemory() << "\n";
+    out << "procs " << procs << "\n";
+    out << "bbs " << bbs << "\n";
+    out << "stmts " << stmts << "\n";
+    out << "exps " << Exp::numCreated << "\n";
+    out << "proofs " << UserProc::proofStats.attempted << "\n";
+    out << "proofsTrue " << UserProc::proofStats.proven << "\n";
+    out << "proofsOutOfBudget " << UserProc::proofStats.outOfBudget << "\n";
+    out << "proofCacheHits " << UserProc::proofStats.cacheHits << "\n";
+    out << "sigClonesAvoided " << Signature::stats.shared - Signature::stats.copied << "\n";
+    out << "defaultSigsReused " << Signature::stats.defaultsReused << "\n";
+}
+
 /**
  * The program will be subsequently be loaded, decoded, decompiled and written to a source file.
  * After decompilation the elapsed time is printed to std::cerr.
@@ -1289,6 +1927,7 @@ int Boomerang::decompile(const char *fname, const char *pname)
     Prog *prog;
     time_t start;
     time(&start);
+    double phaseStart = wallTime(), decodeTime, decompileTime, codeTime;
 
     if (minsToStopAfter)
         {
@@ -1302,8 +1941,11 @@ int Boomerang::decompile(const char *fname, const char *pname)
 #endif
         }
 
-//	std::cout << "setting up transformers...\n";
-//	ExpTransformer::loadAll();
+    if (useTransformations)
+        {
+            std::cout << "setting up transformers...\n";
+            ExpTransformer::loadAll();
+        }
 
 #if USE_XML
     if (loadBeforeDecompile)
@@ -1332,8 +1974,11 @@ int Boomerang::decompile(const char *fname, const char *pname)
     if (stopBeforeDecompile)
         return 0;
 
+    decodeTime = wallTime() - phaseStart;
+    phaseStart = wallTime();
     std::cout << "decompiling...\n";
     prog->decompile();
+    decompileTime = wallTime() - phaseStart;
 
     if (dotFile)
         prog->generateDotFile();
@@ -1352,7 +1997,11 @@ int Boomerang::decompile(const char *fname, const char *pname)
         }
 
     std::cout << "generating code...\n";
+    phaseStart = wallTime();
     prog->generateCode();
+    codeTime = wallTime() - phaseStart;
+    if (statsFile)
+        writeStats(statsFile, prog, decodeTime, decompileTime, codeTime);
 
     std::cout << "output written to " << outputPath << prog->getRootCluster()->getName() << "\n";
 
@@ -8,8 +8,6 @@ MACRO(BOOMERANG_ADD_LOADER loader_name)
 		ADD_LIBRARY(${loader_name} SHARED 
 					${loader_name}.cpp 
 					${loader_name}.h
-					SymTab.cpp 
-					SymTab.h
 					${ARGN})
 		# all loaders depend on BinaryFile
 		TARGET_LINK_LIBRARIES(${loader_name} BinaryFile)
@@ -49,11 +49,11 @@
 extern const char *operStrings[];
 
 /// Empty constructor, calls HLLCode()
-CHLLCode::CHLLCode() : HLLCode()
+CHLLCode::CHLLCode() : HLLCode(), progress(0)
 {}
 
 /// Empty constructor, calls HLLCode(p)
-CHLLCode::CHLLCode(UserProc *p) : HLLCode(p)
+CHLLCode::CHLLCode(UserProc *p) : HLLCode(p), progress(0)
 {}
 
 /// Empty destructor
@@ -78,7 +78,6 @@ void CHLLCode::indent(std::ostringstream& str, int indLevel)
  *
  * \todo This function is 800+ lines, and should possibly be split up.
  */
-static int progress = 0;
 void CHLLCode::appendExp(std::ostringstream& str, Exp *exp, PREC curPrec, bool uns /* = false */ )
 {
     if (exp == NULL) return;				// ?
@@ -1259,13 +1258,11 @@ void CHLLCode::AddGoto(int indLevel, int ord)
  */
 void CHLLCode::RemoveUnusedLabels(int maxOrd)
 {
-    for (std::list<char *>::iterator it = lines.begin(); it != lines.end();)
+    for (std::list<std::string>::iterator it = lines.begin(); it != lines.end();)
         {
-            if ((*it)[0] == 'L' && strchr(*it, ':'))
+            if (!it->empty() && (*it)[0] == 'L' && it->find(':') != std::string::npos)
                 {
-                    char *s = strdup(*it);
-                    *strchr(s, ':') = 0;
-                    int n = atoi(s+1);
+                    int n = atoi(it->c_str()+1);
                     if (usedLabels.find(n) == usedLabels.end())
                         {
                             it = lines.erase(it);
@@ -1307,9 +1304,9 @@ void CHLLCode::RemoveLabel(int ord)
 {
     std::ostringstream s;
     s << "L" << std::dec << ord << ":";
-    for (std::list<char*>::iterator it = lines.begin(); it != lines.end(); it++)
+    for (std::list<std::string>::iterator it = lines.begin(); it != lines.end(); it++)
         {
-            if (!strcmp(*it, s.str().c_str()))
+            if (*it == s.str())
                 {
                     lines.erase(it);
                     break;
@@ -1668,7 +1665,7 @@ void CHLLCode::AddProcDec(UserProc* proc, bool open)
             retType = firstRet->getType();
             if (retType == NULL || retType->isVoid())
                 // There is a real return; make it integer (Remove with AD HOC type analysis)
-                retType = new IntegerType();
+                retType = Type::getShared(IntegerType());
         }
     if (retType)
         {
@@ -1700,7 +1697,7 @@ void CHLLCode::AddProcDec(UserProc* proc, bool open)
                 {
                     if (VERBOSE)
                         LOG << "ERROR in CHLLCode::AddProcDec: no type for parameter " << left << "!\n";
-                    ty = new IntegerType();
+                    ty = Type::getShared(IntegerType());
                 }
             const char* name;
             if (left->isParam())
@@ -1817,13 +1814,53 @@ void CHLLCode::AddGlobal(const char *name, Type *type, Exp *init)
     appendLine(s);
 }
 
+/**
+ * Add the declaration for a global array of unsigned bytes. The initialiser is written in hex, 16 bytes to a line,
+ * without making an expression for each byte.
+ * \param bytes	The initial value of the array.
+ * \param size	The number of bytes.
+ */
+void CHLLCode::AddGlobalBytes(const char *name, const unsigned char *bytes, unsigned size)
+{
+    static const char hex[] = "0123456789abcdef";
+    std::ostringstream s;
+    IntegerType uchar(8, -1);
+    appendType(s, &uchar);
+    s << " " << name << "[" << std::dec << size << "]";
+    if (size == 0)
+        {
+            s << ";";
+            appendLine(s);
+            return;
+        }
+    s << " = {";
+    appendLine(s);
+    std::string line;
+    for (unsigned i = 0; i < size; i += 16)
+        {
+            line = "";
+            for (unsigned j = i; j < size && j < i + 16; j++)
+                {
+                    char elem[] = " 0x00,";
+                    elem[3] = hex[bytes[j] >> 4];
+                    elem[4] = hex[bytes[j] & 0xF];
+                    if (j == size - 1)
+                        elem[5] = '\0';
+                    line += elem;
+                }
+            appendLine(line);
+        }
+    appendLine("};");
+}
+
 /// Dump all generated code to \a os.
 void CHLLCode::print(std::ostream &os)
 {
-    for (std::list<char*>::iterator it = lines.begin(); it != lines.end(); it++)
-        os << *it << std::endl;
+    // Use '\n' rather than std::endl; flushing after every line makes writing large programs very slow
+    for (std::list<std::string>::iterator it = lines.begin(); it != lines.end(); it++)
+        os << *it << '\n';
     if (m_proc == NULL)
-        os << std::endl;
+        os << '\n';
 }
 
 /// Adds one line of comment to the code.
@@ -1843,6 +1880,6 @@ void CHLLCode::appendLine(const std::ostringstream& ostr)
 
 void CHLLCode::appendLine(const std::string& s)
 {
-    lines.push_back(strdup(s.c_str()));
+    lines.push_back(s);
 }
 
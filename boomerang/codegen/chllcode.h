@@ -85,8 +85,11 @@ enum PREC
 class CHLLCode : public HLLCode
 {
 private:
-    /// The generated code.
-    std::list<char *> lines;
+    /// The generated code, one line per string. A proc's code is only kept until it is printed.
+    std::list<std::string> lines;
+    /// Count of expressions emitted since the last progress indicator. Per object, so that procs can be generated
+    /// on several threads at once.
+    int progress;
 
     void indent(std::ostringstream& str, int indLevel);
     void appendExp(std::ostringstream& str, Exp *exp, PREC curPrec, bool uns = false);
@@ -177,6 +180,7 @@ public:
     virtual void	AddProcEnd();
     virtual void	AddLocal(const char *name, Type *type, bool last = false);
     virtual void	AddGlobal(const char *name, Type *type, Exp *init = NULL);
+    virtual void	AddGlobalBytes(const char *name, const unsigned char *bytes, unsigned size);
     virtual void	AddPrototype(UserProc* proc);
 private:
     void	AddProcDec(UserProc* proc, bool open);	// Implement AddProcStart and AddPrototype
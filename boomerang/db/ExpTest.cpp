@@ -17,6 +17,7 @@
 #include "ExpTest.h"
 #include "statement.h"
 #include "visitor.h"
+#include "exppattern.h"
 
 CPPUNIT_TEST_SUITE_REGISTRATION( ExpTest );
 
@@ -1435,3 +1436,165 @@ void ExpTest::testVisitors()
 #endif
 }
 
+/*==============================================================================
+ * FUNCTION:		ExpTest::testFusedVisitor
+ * OVERVIEW:		Test that a FusedExpVisitor gets the same answers as its members walking on their own
+ *============================================================================*/
+void ExpTest::testFusedVisitor()
+{
+    Assign s7(new Terminal(opNil), new Terminal(opNil));
+    s7.setNumber(7);
+    // r1 + m[r28{7} - 8]*SETFFLAGS(m[0x1000], r8)
+    Exp* e = new Binary(opPlus,
+                        Location::regOf(1),
+                        new Binary(opMult,
+                                   Location::memOf(
+                                       new Binary(opMinus,
+                                                  new RefExp(Location::regOf(28), &s7),
+                                                  new Const(8))),
+                                   new Binary(opFlagCall,
+                                              new Const("SETFFLAGS"),
+                                              new Binary(opList,
+                                                      Location::memOf(new Const(0x1000)),
+                                                      new Binary(opList,
+                                                              Location::regOf(8),
+                                                              new Terminal(opNil))))));
+
+    // The bad memof finder stops at the first m[...], but the others must still see the whole expression
+    FusedExpVisitor fev;
+    BadMemofFinder bmf(NULL);
+    ComplexityFinder cf(NULL);
+    FlagsFinder ff;
+    fev.add(&bmf);
+    fev.add(&cf);
+    fev.add(&ff);
+    e->accept(&fev);
+    CPPUNIT_ASSERT(bmf.isFound());
+    CPPUNIT_ASSERT(fev.isStopped(&bmf));
+    CPPUNIT_ASSERT(!fev.isStopped(&cf));
+    CPPUNIT_ASSERT_EQUAL(e->getComplexityDepth(NULL), cf.getDepth());
+    CPPUNIT_ASSERT(ff.isFound());
+    CPPUNIT_ASSERT(fev.isStopped(&ff));
+
+    // The members are the usual ExpVisitor of a StmtExpVisitor
+    Assign as(Location::memOf(Location::regOf(24)), e);
+    ComplexityFinder cf2(NULL);
+    FusedExpVisitor fev2;
+    fev2.add(&cf2);
+    StmtExpVisitor sev(&fev2);
+    as.accept(&sev);
+    CPPUNIT_ASSERT_EQUAL(cf.getDepth() + 1, cf2.getDepth());
+}
+
+
+/*==============================================================================
+ * FUNCTION:		ExpTest::testSimplifiedFlag
+ * OVERVIEW:		Test that simplify() marks its result, and that changing the expression lets it be simplified again
+ *============================================================================*/
+void ExpTest::testSimplifiedFlag()
+{
+    // (r24 + r25) * 1
+    Exp* e = new Binary(opMult,
+                        new Binary(opPlus,
+                                   Location::regOf(24),
+                                   Location::regOf(25)),
+                        new Const(1));
+    CPPUNIT_ASSERT(!e->isSimplified());
+    e = e->simplify();
+    std::string expected("r24 + r25");
+    std::ostringstream ost;
+    ost << e;
+    CPPUNIT_ASSERT_EQUAL(expected, std::string(ost.str()));
+    CPPUNIT_ASSERT(e->isSimplified());
+    CPPUNIT_ASSERT(e == e->simplify());
+
+    // Replacing r25 with 0 below the top level must make r24 + 0 simplify again
+    bool change;
+    Exp* r25 = Location::regOf(25);
+    Const* zero = new Const(0);
+    e = e->searchReplaceAll(r25, zero, change);
+    CPPUNIT_ASSERT(change);
+    CPPUNIT_ASSERT(!e->isSimplified());
+    e = e->simplify();
+    expected = "r24";
+    std::ostringstream ost2;
+    ost2 << e;
+    CPPUNIT_ASSERT_EQUAL(expected, std::string(ost2.str()));
+
+    // So must changing a constant in place
+    Exp* f = new Binary(opPlus, Location::regOf(24), new Const(4));
+    f = f->simplify();
+    CPPUNIT_ASSERT(f->isSimplified());
+    ((Const*)f->getSubExp2())->setInt(0);
+    CPPUNIT_ASSERT(!f->isSimplified());
+    f = f->simplify();
+    std::ostringstream ost3;
+    ost3 << f;
+    CPPUNIT_ASSERT_EQUAL(expected, std::string(ost3.str()));
+
+    // r0{def} depends on its definition, so it is never taken as simplified
+    Assign s9(Location::regOf(0), new Const(5));
+    s9.setNumber(9);
+    Exp* g = new RefExp(Location::regOf(0), &s9);
+    g = g->simplify();
+    CPPUNIT_ASSERT(!g->isSimplified());
+}
+
+/*==============================================================================
+ * FUNCTION:		ExpTest::testExpPattern
+ * OVERVIEW:		Test compiled expression patterns, given as expressions and as strings
+ *============================================================================*/
+void ExpTest::testExpPattern()
+{
+    // Switch form A: m[<expr> * 4 + T], ignoring subscripts
+    ExpPattern formA(Location::memOf(
+                         new Binary(opPlus,
+                                    new Binary(opMult,
+                                               new Terminal(opWild),
+                                               new Const(4)),
+                                    new Terminal(opWildIntConst))));
+    Assign s5(Location::regOf(24), new Const(0));
+    s5.setNumber(5);
+    Exp* e = new RefExp(Location::memOf(
+                            new Binary(opPlus,
+                                       new Binary(opMult,
+                                                  new RefExp(Location::regOf(24), &s5),
+                                                  new Const(4)),
+                                       new Const(0x8048000))), NULL);
+    std::vector<Exp*> bindings;
+    CPPUNIT_ASSERT(formA.match(e, bindings));
+    CPPUNIT_ASSERT_EQUAL(2, (int)bindings.size());
+    std::string expected("r24{5}");
+    std::ostringstream ost;
+    ost << bindings[0];
+    CPPUNIT_ASSERT_EQUAL(expected, std::string(ost.str()));
+    CPPUNIT_ASSERT(bindings[1]->isIntConst());
+    CPPUNIT_ASSERT_EQUAL(0x8048000, ((Const*)bindings[1])->getInt());
+    Exp* f = Location::memOf(
+                 new Binary(opPlus,
+                            new Binary(opMult,
+                                       Location::regOf(24),
+                                       new Const(8)),
+                            new Const(0x8048000)));
+    CPPUNIT_ASSERT(!formA.match(f));
+
+    // String patterns; every identifier is a named wildcard
+    std::map<std::string, Exp*> b;
+    Exp* g = Location::memOf(new Binary(opPlus, Location::regOf(28), new Const(4)));
+    CPPUNIT_ASSERT(g->match("m[x + 4]", b));
+    CPPUNIT_ASSERT(*b["x"] == *Location::regOf(28));
+    CPPUNIT_ASSERT(!g->match("m[x + 8]", b));
+    CPPUNIT_ASSERT(!g->match("m[x - 4]", b));
+    CPPUNIT_ASSERT(!g->match("x{-}", b));
+    b.clear();
+    Exp* h = new RefExp(g->clone(), NULL);
+    CPPUNIT_ASSERT(h->match("m[y + 4]{-}", b));
+    CPPUNIT_ASSERT(*b["y"] == *Location::regOf(28));
+    CPPUNIT_ASSERT(!h->match("m[y + 4]{5}", b));
+    // The same name must match the same expression each time
+    Exp* twice = new Binary(opPlus, Location::regOf(24), Location::regOf(24));
+    CPPUNIT_ASSERT(twice->match("a + a", b));
+    Exp* diff = new Binary(opPlus, Location::regOf(24), Location::regOf(25));
+    CPPUNIT_ASSERT(!diff->match("a + a", b));
+    CPPUNIT_ASSERT(diff->match("a + c", b));
+}
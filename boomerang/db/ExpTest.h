@@ -45,6 +45,9 @@ class ExpTest : public CPPUNIT_NS::TestFixture
     CPPUNIT_TEST( testAddUsedLocs );
     CPPUNIT_TEST( testSubscriptVars );
     CPPUNIT_TEST( testVisitors );
+    CPPUNIT_TEST( testFusedVisitor );
+    CPPUNIT_TEST( testSimplifiedFlag );
+    CPPUNIT_TEST( testExpPattern );
     CPPUNIT_TEST_SUITE_END();
 
 protected:
@@ -105,5 +108,8 @@ protected:
     void testAddUsedLocs();
     void testSubscriptVars();
     void testVisitors();
+    void testFusedVisitor();
+    void testSimplifiedFlag();
+    void testExpPattern();
 };
 
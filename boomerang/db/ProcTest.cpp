@@ -15,6 +15,10 @@
 #include "BinaryFileStub.h"
 #include "pentiumfrontend.h"
 #include "prog.h"
+#include "cfg.h"
+#include "rtl.h"
+#include "statement.h"
+#include "boomerang.h"
 
 CPPUNIT_TEST_SUITE_REGISTRATION( ProcTest );
 
@@ -78,3 +82,123 @@ void ProcTest::testName ()
     // delete pFE;		// No! Deleting the prog deletes the pFE already (which deletes the BinaryFileFactory)
 }
 
+
+/*==============================================================================
+ * FUNCTION:		ProcTest::testStatementCache
+ * OVERVIEW:		Test that getStatements sees statements inserted and removed after it was last called
+ *============================================================================*/
+void ProcTest::testStatementCache ()
+{
+    Prog* prog = new Prog();
+    std::string nm("cache test");
+    UserProc* proc = new UserProc(prog, nm, 0x1000);
+    Cfg* cfg = proc->getCFG();
+    std::list<Statement*> ls;
+    Assign* a1 = new Assign(Location::regOf(24), new Const(1));
+    ls.push_back(a1);
+    std::list<RTL*>* pRtls = new std::list<RTL*>;
+    pRtls->push_back(new RTL(0x1000, &ls));
+    cfg->newBB(pRtls, RET, 0);
+
+    StatementVec stmts;
+    proc->getStatements(stmts);
+    CPPUNIT_ASSERT_EQUAL(1, (int)stmts.size());
+    CPPUNIT_ASSERT(stmts[0] == a1);
+
+    // Insert r25 := 2 after a1; the cached statements are now stale
+    proc->insertAssignAfter(a1, Location::regOf(25), new Const(2));
+    stmts.clear();
+    proc->getStatements(stmts);
+    CPPUNIT_ASSERT_EQUAL(2, (int)stmts.size());
+    CPPUNIT_ASSERT(stmts[0] == a1);
+
+    // Remove a1, and check via the StatementList version as well
+    proc->removeStatement(a1);
+    StatementList sl;
+    proc->getStatements(sl);
+    CPPUNIT_ASSERT_EQUAL(1, (int)sl.size());
+    CPPUNIT_ASSERT(*sl.begin() != a1);
+
+    delete prog;
+}
+
+/*==============================================================================
+ * FUNCTION:		ProcTest::testProofBudget
+ * OVERVIEW:		Test that a proof gives up when it reaches the step limit, and the proof statistics
+ *============================================================================*/
+void ProcTest::testProofBudget ()
+{
+    Prog* prog = new Prog();
+    std::string nm("proof test");
+    UserProc* proc = new UserProc(prog, nm, 0x1000);
+    ProofStats before = UserProc::proofStats;
+
+    // r24{-} = r24 takes the prover a couple of steps
+    Exp* query = new Binary(opEquals, new RefExp(Location::regOf(24), NULL), Location::regOf(24));
+    CPPUNIT_ASSERT(proc->prove(query->clone(), true));
+    CPPUNIT_ASSERT_EQUAL(before.attempted + 1, UserProc::proofStats.attempted);
+    CPPUNIT_ASSERT_EQUAL(before.proven + 1, UserProc::proofStats.proven);
+    CPPUNIT_ASSERT_EQUAL(before.outOfBudget, UserProc::proofStats.outOfBudget);
+
+    // With a limit of one step, the same proof fails
+    Boomerang::get()->proofStepLimit = 1;
+    CPPUNIT_ASSERT(!proc->prove(query->clone(), true));
+    Boomerang::get()->proofStepLimit = 0;
+    CPPUNIT_ASSERT_EQUAL(before.attempted + 2, UserProc::proofStats.attempted);
+    CPPUNIT_ASSERT_EQUAL(before.proven + 1, UserProc::proofStats.proven);
+    CPPUNIT_ASSERT_EQUAL(before.outOfBudget + 1, UserProc::proofStats.outOfBudget);
+
+    // The limit is per proof, so the next one succeeds again
+    CPPUNIT_ASSERT(proc->prove(query->clone(), true));
+
+    delete prog;
+}
+
+/*==============================================================================
+ * FUNCTION:		ProcTest::testProofCache
+ * OVERVIEW:		Test that a cached proof is only used again under exactly the premises it was made under
+ *============================================================================*/
+void ProcTest::testProofCache ()
+{
+    Prog* prog = new Prog();
+    std::string nm1("proof cache test 1"), nm2("proof cache test 2");
+    UserProc* proc1 = new UserProc(prog, nm1, 0x1000);
+    UserProc* proc2 = new UserProc(prog, nm2, 0x2000);
+    ProofCache cache;
+    Exp* query = new Binary(opEquals, Location::regOf(24), Location::regOf(24));
+
+    // Premises r28{1} = r28 and r28{2} = r28 differ only in the subscript, so they hash the same
+    Assign* def1 = new Assign(Location::regOf(28), new Const(1));
+    Assign* def2 = new Assign(Location::regOf(28), new Const(2));
+    Exp* lhs1 = new RefExp(Location::regOf(28), def1);
+    Exp* lhs2 = new RefExp(Location::regOf(28), def2);
+    CPPUNIT_ASSERT_EQUAL(lhs1->hash(), lhs2->hash());
+
+    cache.setPremise(proc1, lhs1, Location::regOf(28));
+    ProofCache::Snapshot snap;
+    cache.snapshot(snap);
+    cache.add(proc1, query->clone(), true, snap, true);
+    bool result = false;
+    CPPUNIT_ASSERT(cache.find(proc1, query, true, result));
+    CPPUNIT_ASSERT(result);
+    CPPUNIT_ASSERT(!cache.find(proc2, query, true, result));
+    CPPUNIT_ASSERT(!cache.find(proc1, query, false, result));
+
+    // Under the other premise, the result is not known
+    cache.removePremise(proc1, lhs1);
+    cache.setPremise(proc1, lhs2, Location::regOf(28));
+    CPPUNIT_ASSERT(!cache.find(proc1, query, true, result));
+    cache.removePremise(proc1, lhs2);
+    CPPUNIT_ASSERT(!cache.find(proc1, query, true, result));
+
+    // Back under the original premise (a new copy of it), the result is found again
+    cache.setPremise(proc1, lhs1->clone(), Location::regOf(28));
+    result = false;
+    CPPUNIT_ASSERT(cache.find(proc1, query, true, result));
+    CPPUNIT_ASSERT(result);
+
+    cache.clear();
+    CPPUNIT_ASSERT(!cache.find(proc1, query, true, result));
+
+    delete prog;
+}
@@ -17,6 +17,9 @@ class ProcTest : public CPPUNIT_NS::TestFixture
 {
     CPPUNIT_TEST_SUITE( ProcTest );
     CPPUNIT_TEST( testName );
+    CPPUNIT_TEST( testStatementCache );
+    CPPUNIT_TEST( testProofBudget );
+    CPPUNIT_TEST( testProofCache );
     CPPUNIT_TEST_SUITE_END();
 
 protected:
@@ -28,5 +31,8 @@ public:
 
 protected:
     void testName ();
+    void testStatementCache ();
+    void testProofBudget ();
+    void testProofCache ();
 };
 
@@ -13,6 +13,9 @@
 #include "ProgTest.h"
 #include "pentiumfrontend.h"
 #include "BinaryFile.h"
+#include "dataindex.h"
+#include "switchtables.h"
+#include "statement.h"
 
 CPPUNIT_TEST_SUITE_REGISTRATION( ProgTest );
 
@@ -62,5 +65,76 @@ void ProgTest::testName ()
     delete pFE;
 }
 
+/*==============================================================================
+ * FUNCTION:		ProgTest::testDataIndex
+ * OVERVIEW:		Test finding strings and pointers in the data
+ *============================================================================*/
+void ProgTest::testDataIndex ()
+{
+    BinaryFileFactory bff;
+    BinaryFile *pBF = bff.Load(HELLO_PENTIUM);
+    Prog* prog = new Prog();
+    FrontEnd *pFE = new PentiumFrontEnd(pBF, prog, &bff);
+    prog->setFrontEnd(pFE);
+    DataIndex *index = prog->getDataIndex();
+    unsigned len;
+    // "Hello, world!\n" is in .rodata after two words of other data
+    CPPUNIT_ASSERT(index->stringAt(0x80483fc, len));
+    CPPUNIT_ASSERT_EQUAL(14u, len);
+    CPPUNIT_ASSERT(index->stringAt(0x8048403, len));
+    CPPUNIT_ASSERT_EQUAL(7u, len);
+    CPPUNIT_ASSERT(!index->stringAt(0x80483f4, len));
+    CPPUNIT_ASSERT(!index->wideStringAt(0x80483fc, len));
+    CPPUNIT_ASSERT(prog->getStringConstant(0x80483fc) != NULL);
+    CPPUNIT_ASSERT(prog->getStringConstant(0x80483f4) == NULL);
+    // The first word of the .got points to .dynamic
+    ADDRESS target;
+    CPPUNIT_ASSERT(index->pointerAt(0x80494f8, target));
+    CPPUNIT_ASSERT_EQUAL((ADDRESS)0x804941c, target);
+    CPPUNIT_ASSERT(!index->pointerAt(0x80494fc, target));
+    CPPUNIT_ASSERT_EQUAL(0, index->codePointerRun(0x80494f8, 4));
+    // The last three words of the .got are two PLT entries and a NUL
+    CPPUNIT_ASSERT_EQUAL(2, index->codePointerRun(0x8049504, 4));
+    CPPUNIT_ASSERT_EQUAL(1, index->codePointerRun(0x8049504, 1));
+    delete prog;
+}
+
+/*==============================================================================
+ * FUNCTION:		ProgTest::testSwitchTables
+ * OVERVIEW:		Test reading switch tables, using the .got as one
+ *============================================================================*/
+void ProgTest::testSwitchTables ()
+{
+    BinaryFileFactory bff;
+    BinaryFile *pBF = bff.Load(HELLO_PENTIUM);
+    Prog* prog = new Prog();
+    FrontEnd *pFE = new PentiumFrontEnd(pBF, prog, &bff);
+    prog->setFrontEnd(pFE);
+    SwitchTables *tables = prog->getSwitchTables();
+    // Two PLT entries, then a NUL
+    CPPUNIT_ASSERT_EQUAL(2, tables->numCodeEntries(0x8049504, 3));
+    CPPUNIT_ASSERT_EQUAL(0, tables->numCodeEntries(0x80494f8, 3));
+    SWITCH_INFO si;
+    si.chForm = 'A';
+    si.uTable = 0x8049504;
+    si.iOffset = 0;
+    std::vector<ADDRESS> dests;
+    tables->getDests(&si, 2, dests);
+    CPPUNIT_ASSERT_EQUAL((size_t)2, dests.size());
+    CPPUNIT_ASSERT_EQUAL((ADDRESS)0x804825e, dests[0]);
+    CPPUNIT_ASSERT_EQUAL((ADDRESS)0x804826e, dests[1]);
+    // Form O entries are offsets from the table
+    si.chForm = 'O';
+    tables->getDests(&si, 3, dests);
+    CPPUNIT_ASSERT_EQUAL((ADDRESS)(0x804825e + 0x8049504), dests[0]);
+    CPPUNIT_ASSERT_EQUAL((ADDRESS)0x8049504, dests[2]);
+    // Form H entries are pairs; a value of -1 marks an unused one
+    si.chForm = 'H';
+    si.uTable = 0x8049500;
+    tables->getDests(&si, 1, dests);
+    CPPUNIT_ASSERT_EQUAL((ADDRESS)0x804825e, dests[0]);
+    delete prog;
+}
+
 // Pathetic: the second test we had (for readLibraryParams) is now obsolete;
 // the front end does this now.
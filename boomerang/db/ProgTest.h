@@ -6,6 +6,8 @@ class ProgTest : public CPPUNIT_NS::TestFixture
 {
     CPPUNIT_TEST_SUITE( ProgTest );
     CPPUNIT_TEST( testName );
+    CPPUNIT_TEST( testDataIndex );
+    CPPUNIT_TEST( testSwitchTables );
     CPPUNIT_TEST_SUITE_END();
 
 protected:
@@ -17,5 +19,7 @@ public:
 
 protected:
     void testName ();
+    void testDataIndex ();
+    void testSwitchTables ();
 };
 
@@ -11,6 +11,7 @@
  * 06 Jul 05 - Mike: Split testAddUsedLocs into six separate tests for Assign ... Bool
  */
 
+#include <sstream>
 #include "StatementTest.h"
 #include "cfg.h"
 #include "rtl.h"
@@ -745,6 +746,143 @@ void StatementTest::testWildLocationSet ()
     CPPUNIT_ASSERT(!ls.findDifferentRef(&r22_10, x));
 }
 
+/*==============================================================================
+ * FUNCTION:		StatementTest::testStatementSet
+ * OVERVIEW:		Test the set operations of StatementSet
+ *============================================================================*/
+void StatementTest::testStatementSet ()
+{
+    Assign* a1 = new Assign(Location::regOf(24), new Const(1));
+    Assign* a2 = new Assign(Location::regOf(25), new Const(2));
+    Assign* a3 = new Assign(Location::regOf(26), new Const(3));
+    StatementSet s1, s2;
+    s1.insert(a1);
+    s1.insert(a2);
+    s1.insert(a1);
+    CPPUNIT_ASSERT_EQUAL(2, (int)s1.size());
+    CPPUNIT_ASSERT(s1.exists(a2));
+    CPPUNIT_ASSERT(!s1.exists(a3));
+    s2.insert(a2);
+    s2.insert(a3);
+    CPPUNIT_ASSERT(!s2.isSubSetOf(s1));
+    StatementSet u = s1;
+    u.makeUnion(s2);
+    CPPUNIT_ASSERT_EQUAL(3, (int)u.size());
+    CPPUNIT_ASSERT(s1.isSubSetOf(u));
+    CPPUNIT_ASSERT(s2.isSubSetOf(u));
+    StatementSet i = s1;
+    i.makeIsect(s2);
+    CPPUNIT_ASSERT_EQUAL(1, (int)i.size());
+    CPPUNIT_ASSERT(*i.begin() == a2);
+    StatementSet d = s1;
+    d.makeDiff(s2);
+    CPPUNIT_ASSERT_EQUAL(1, (int)d.size());
+    CPPUNIT_ASSERT(*d.begin() == a1);
+    CPPUNIT_ASSERT(d.definesLoc(Location::regOf(24)));
+    CPPUNIT_ASSERT(!d.definesLoc(Location::regOf(25)));
+    CPPUNIT_ASSERT(u.remove(a1));
+    CPPUNIT_ASSERT(!u.remove(a1));
+    CPPUNIT_ASSERT(u == s2);
+    int n = 0;
+    for (StatementSet::iterator it = u.begin(); it != u.end(); it++)
+        n++;
+    CPPUNIT_ASSERT_EQUAL(2, n);
+    // A statement can be deleted once it is in no set, and a new one can take its place
+    u.remove(a3);
+    s2.remove(a3);
+    delete a3;
+    Assign* a4 = new Assign(Location::regOf(27), new Const(4));
+    CPPUNIT_ASSERT(!s1.exists(a4));
+    s1.insert(a4);
+    CPPUNIT_ASSERT(s1.exists(a4));
+    CPPUNIT_ASSERT_EQUAL(3, (int)s1.size());
+    CPPUNIT_ASSERT_EQUAL(1, (int)s2.size());
+    // NULL (e.g. an implicit definition) is an element like any other
+    StatementSet withNull;
+    CPPUNIT_ASSERT(!withNull.exists(NULL));
+    withNull.insert(NULL);
+    withNull.insert(a1);
+    CPPUNIT_ASSERT(withNull.exists(NULL));
+    CPPUNIT_ASSERT_EQUAL(2, (int)withNull.size());
+    CPPUNIT_ASSERT(*withNull.begin() == NULL);
+    CPPUNIT_ASSERT(withNull.remove(NULL));
+    CPPUNIT_ASSERT(!withNull.exists(NULL));
+}
+
+/*==============================================================================
+ * FUNCTION:		StatementTest::testSparseBitSet
+ * OVERVIEW:		Test SparseBitSet, including elements in widely separated chunks
+ *============================================================================*/
+void StatementTest::testSparseBitSet ()
+{
+    SparseBitSet a, b;
+    a.insert(0);
+    a.insert(63);
+    a.insert(64);
+    a.insert(100000);
+    CPPUNIT_ASSERT(!a.insert(63));
+    CPPUNIT_ASSERT_EQUAL(4, (int)a.size());
+    b.insert(64);
+    b.insert(5000);
+    b.insert(100000);
+
+    std::ostringstream ost;
+    for (SparseBitSet::iterator it = a.begin(); it != a.end(); it++)
+        ost << *it << " ";
+    CPPUNIT_ASSERT_EQUAL(std::string("0 63 64 100000 "), ost.str());
+
+    SparseBitSet u = a;
+    u.makeUnion(b);
+    CPPUNIT_ASSERT_EQUAL(5, (int)u.size());
+    CPPUNIT_ASSERT(u.exists(5000));
+    CPPUNIT_ASSERT(a.isSubSetOf(u));
+    CPPUNIT_ASSERT(!u.isSubSetOf(a));
+
+    SparseBitSet i = a;
+    i.makeIsect(b);
+    CPPUNIT_ASSERT_EQUAL(2, (int)i.size());
+    CPPUNIT_ASSERT(i.exists(64) && i.exists(100000));
+
+    SparseBitSet d = a;
+    d.makeDiff(b);
+    CPPUNIT_ASSERT_EQUAL(2, (int)d.size());
+    CPPUNIT_ASSERT(d.exists(0) && d.exists(63) && !d.exists(64));
+
+    // Removing the only element of a chunk should leave nothing behind
+    CPPUNIT_ASSERT(d.remove(0));
+    CPPUNIT_ASSERT(d.remove(63));
+    CPPUNIT_ASSERT(!d.remove(63));
+    CPPUNIT_ASSERT(d.empty());
+    CPPUNIT_ASSERT(d.begin() == d.end());
+    CPPUNIT_ASSERT(d == SparseBitSet());
+}
+
+/*==============================================================================
+ * FUNCTION:		StatementTest::testRangeWorkList
+ * OVERVIEW:		Test that the range analysis worklist keeps BBs that have the same DFT number
+ *============================================================================*/
+void StatementTest::testRangeWorkList ()
+{
+    Cfg cfg;
+    std::list<RTL*>* pRtls = new std::list<RTL*>();
+    pRtls->push_back(new RTL(0x1000));
+    PBB bb1 = cfg.newBB(pRtls, FALL, 1);
+    pRtls = new std::list<RTL*>();
+    pRtls->push_back(new RTL(0x2000));
+    PBB bb2 = cfg.newBB(pRtls, RET, 0);
+    // Neither BB is numbered yet
+    RangeData rd;
+    rd.addToWorkList(bb1);
+    rd.addToWorkList(bb2);
+    rd.addToWorkList(bb1);
+    BasicBlock* first = rd.nextFromWorkList();
+    BasicBlock* second = rd.nextFromWorkList();
+    CPPUNIT_ASSERT(first == bb1 || first == bb2);
+    CPPUNIT_ASSERT(second == bb1 || second == bb2);
+    CPPUNIT_ASSERT(first != second);
+    CPPUNIT_ASSERT(rd.nextFromWorkList() == NULL);
+}
+
 /*==============================================================================
  * FUNCTION:		StatementTest::testRecursion
  * OVERVIEW:		Test push of argument (X86 style), then call self
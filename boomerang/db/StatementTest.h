@@ -23,6 +23,9 @@ class StatementTest : public CPPUNIT_NS::TestFixture
     CPPUNIT_TEST( testUseKill );
     CPPUNIT_TEST( testLocationSet );
     CPPUNIT_TEST( testWildLocationSet );
+    CPPUNIT_TEST( testStatementSet );
+    CPPUNIT_TEST( testSparseBitSet );
+    CPPUNIT_TEST( testRangeWorkList );
     // TODO check whether these tests are unnecessary; remove them if so.
     //CPPUNIT_TEST( testEndlessLoop );
     //CPPUNIT_TEST( testRecursion );
@@ -57,6 +60,9 @@ protected:
     void testEndlessLoop();
     void testLocationSet();
     void testWildLocationSet();
+    void testStatementSet();
+    void testSparseBitSet();
+    void testRangeWorkList();
     void testRecursion();
     void testExpand();
     void testClone();
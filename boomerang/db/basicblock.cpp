@@ -50,6 +50,8 @@
 #include "type.h"
 #include "log.h"
 #include "visitor.h"
+#include "exppattern.h"
+#include "switchtables.h"
 #include <cstring>
 
 /**********************************
@@ -877,6 +879,23 @@ void BasicBlock::getStatements(StatementList &stmts)
         }
 }
 
+// As above, but append to a StatementVec (used to build UserProc's contiguous statement cache)
+void BasicBlock::getStatements(StatementVec &stmts)
+{
+    if (m_pRtls == NULL)
+        return;
+    for (std::list<RTL*>::iterator rit = m_pRtls->begin(); rit != m_pRtls->end(); rit++)
+        {
+            RTL *rtl = *rit;
+            for (RTL::iterator it = rtl->getList().begin(); it != rtl->getList().end(); it++)
+                {
+                    if ((*it)->getBB() == NULL)
+                        (*it)->setBB(this);
+                    stmts.append(*it);
+                }
+        }
+}
+
 /*
  * Structuring and code generation.
  *
@@ -1790,7 +1809,7 @@ bool BasicBlock::inLoop(PBB header, PBB latch)
 // Used in dotty file generation
 char* BasicBlock::getStmtNumber()
 {
-    static char ret[12];
+    static THREAD_LOCAL char ret[12];		// One for each code generation thread
     rtlit rit;
     StatementList::iterator sit;
     Statement* first = getFirstStmt(rit, sit);
@@ -1808,6 +1827,7 @@ void BasicBlock::prependStmt(Statement* s, UserProc* proc)
     // Check the first RTL (if any)
     s->setBB(this);
     s->setProc(proc);
+    proc->invalidateStatements();
     if (m_pRtls->size())
         {
             RTL* rtl = m_pRtls->front();
@@ -2102,15 +2122,28 @@ static Exp* hlVfc[] =
     vfc_funcptr, vfc_both, vfc_vto, vfc_vfo, vfc_none
 };
 
-void findSwParams(char form, Exp* e, Exp*& expr, ADDRESS& T)
+// The above patterns compiled for matching. Like operator*=, the matchers ignore subscripts
+static ExpPattern* swPatterns[] =
+{
+    new ExpPattern(forma), new ExpPattern(formA), new ExpPattern(formo), new ExpPattern(formO),
+    new ExpPattern(formR), new ExpPattern(formr)
+};
+static ExpPattern* vfcPatterns[] =
+{
+    new ExpPattern(vfc_funcptr), new ExpPattern(vfc_both), new ExpPattern(vfc_vto), new ExpPattern(vfc_vfo),
+    new ExpPattern(vfc_none)
+};
+
+// Find the switch expression and table address of a switch of the given form. bindings has what the wildcards of the
+// form's pattern matched, in order
+void findSwParams(char form, std::vector<Exp*>& bindings, Exp*& expr, ADDRESS& T)
 {
     switch (form)
         {
         case 'a':
         {
             // Pattern: <base>{}[<index>]{}
-            e = ((RefExp*)e)->getSubExp1();
-            Exp* base = ((Binary*)e)->getSubExp1();
+            Exp* base = bindings[0];
             if (base->isSubscript())
                 base = ((RefExp*)base)->getSubExp1();
             Exp* con = ((Location*)base)->getSubExp1();
@@ -2118,73 +2151,26 @@ void findSwParams(char form, Exp* e, Exp*& expr, ADDRESS& T)
             UserProc* p = ((Location*)base)->getProc();
             Prog* prog = p->getProg();
             T = (ADDRESS)prog->getGlobalAddr(gloName);
-            expr = ((Binary*)e)->getSubExp2();
+            expr = bindings[1];
             break;
         }
         case 'A':
-        {
             // Pattern: m[<expr> * 4 + T ]
-            if (e->isSubscript()) e = e->getSubExp1();
-            // b will be (<expr> * 4) + T
-            Binary* b = (Binary*)((Location*)e)->getSubExp1();
-            Const* TT = (Const*)b->getSubExp2();
-            T = (ADDRESS)TT->getInt();
-            b = (Binary*)b->getSubExp1();	// b is now <expr> * 4
-            expr = b->getSubExp1();
+            expr = bindings[0];
+            T = (ADDRESS)((Const*)bindings[1])->getInt();
             break;
-        }
         case 'O':
-        {
-            // Form O
             // Pattern: m[<expr> * 4 + T ] + T
-            T = ((Const*)((Binary*)e)->getSubExp2())->getInt();
-            // l = m[<expr> * 4 + T ]:
-            Exp* l = ((Binary*)e)->getSubExp1();
-            if (l->isSubscript()) l = l->getSubExp1();
-            // b = <expr> * 4 + T:
-            Binary* b = (Binary*)((Location*)l)->getSubExp1();
-            // b = <expr> * 4:
-            b = (Binary*)b->getSubExp1();
-            // expr = <expr>:
-            expr = b->getSubExp1();
+            expr = bindings[0];
+            T = (ADDRESS)((Const*)bindings[2])->getInt();
             break;
-        }
         case 'R':
-        {
             // Pattern: %pc + m[%pc	 + (<expr> * 4) + k]
-            T = 0;		// ?
-            // l = m[%pc  + (<expr> * 4) + k]:
-            Exp* l = ((Binary*)e)->getSubExp2();
-            if (l->isSubscript()) l = l->getSubExp1();
-            // b = %pc	+ (<expr> * 4) + k:
-            Binary* b = (Binary*)((Location*)l)->getSubExp1();
-            // b = (<expr> * 4) + k:
-            b = (Binary*)b->getSubExp2();
-            // b = <expr> * 4:
-            b = (Binary*)b->getSubExp1();
-            // expr = <expr>:
-            expr = b->getSubExp1();
-            break;
-        }
         case 'r':
-        {
             // Pattern: %pc + m[%pc + ((<expr> * 4) - k)] - k
             T = 0;		// ?
-            // b = %pc + m[%pc + ((<expr> * 4) - k)]:
-            Binary* b = (Binary*)((Binary*)e)->getSubExp1();
-            // l = m[%pc + ((<expr> * 4) - k)]:
-            Exp* l = b->getSubExp2();
-            if (l->isSubscript()) l = l->getSubExp1();
-            // b = %pc + ((<expr> * 4) - k)
-            b = (Binary*)((Location*)l)->getSubExp1();
-            // b = ((<expr> * 4) - k):
-            b = (Binary*)b->getSubExp2();
-            // b = <expr> * 4:
-            b = (Binary*)b->getSubExp1();
-            // expr = <expr>
-            expr = b->getSubExp1();
+            expr = bindings[0];
             break;
-        }
         default:
             expr = NULL;
             T = NO_ADDRESS;
@@ -2304,13 +2290,14 @@ bool BasicBlock::decodeIndirectJmp(UserProc* proc)
             bool convert;
             lastStmt->propagateTo(convert, NULL, NULL, true /* force */);
             Exp* e = lastStmt->getDest();
-            int n = sizeof(hlForms) / sizeof(Exp*);
+            int n = sizeof(swPatterns) / sizeof(ExpPattern*);
             char form = 0;
+            std::vector<Exp*> bindings;
             for (int i=0; i < n; i++)
                 {
-                    if (*e *= *hlForms[i])
+                    if (swPatterns[i]->match(e, bindings))
                         {
-                            // *= compare ignores subscripts
+                            // The match ignores subscripts
                             form = chForms[i];
                             if (DEBUG_SWITCH)
                                 LOG << "indirect jump matches form " << form << "\n";
@@ -2323,7 +2310,7 @@ bool BasicBlock::decodeIndirectJmp(UserProc* proc)
                     swi->chForm = form;
                     ADDRESS T;
                     Exp* expr;
-                    findSwParams(form, e, expr, T);
+                    findSwParams(form, bindings, expr, T);
                     if (expr)
                         {
                             swi->uTable = T;
@@ -2333,19 +2320,14 @@ bool BasicBlock::decodeIndirectJmp(UserProc* proc)
                             if (form == 'A')
                                 {
                                     Prog* prog = proc->getProg();
-                                    for (int iPtr = 0; iPtr < swi->iNumTable; ++iPtr)
+                                    int iPtr = prog->getSwitchTables()->numCodeEntries(swi->uTable, swi->iNumTable);
+                                    if (iPtr < swi->iNumTable)
                                         {
-                                            ADDRESS uSwitch = prog->readNative4(swi->uTable + iPtr*4);
-                                            if (uSwitch >= prog->getLimitTextHigh() ||
-                                                    uSwitch <  prog->getLimitTextLow())
-                                                {
-                                                    if (DEBUG_SWITCH)
-                                                        LOG << "Truncating type A indirect jump array to " << iPtr << " entries "
-                                                            "due to finding an array entry pointing outside valid code " << uSwitch << " isn't in " << prog->getLimitTextLow() << " .. " << prog->getLimitTextHigh() << "\n";
-                                                    // Found an array that isn't a pointer-to-code. Assume array has ended.
-                                                    swi->iNumTable = iPtr;
-                                                    break;
-                                                }
+                                            if (DEBUG_SWITCH)
+                                                LOG << "Truncating type A indirect jump array to " << iPtr << " entries "
+                                                    "due to finding an array entry pointing outside valid code " << prog->readNative4(swi->uTable + iPtr*4) << " isn't in " << prog->getLimitTextLow() << " .. " << prog->getLimitTextHigh() << "\n";
+                                            // Found an array that isn't a pointer-to-code. Assume array has ended.
+                                            swi->iNumTable = iPtr;
                                         }
                                 }
                             assert(swi->iNumTable > 0);
@@ -2426,14 +2408,14 @@ bool BasicBlock::decodeIndirectJmp(UserProc* proc)
             if (DEBUG_SWITCH)
                 LOG << "decodeIndirect: propagated and const global converted call expression is " << e << "\n";
 
-            int n = sizeof(hlVfc) / sizeof(Exp*);
+            int n = sizeof(vfcPatterns) / sizeof(ExpPattern*);
             bool recognised = false;
             int i;
             for (i=0; i < n; i++)
                 {
-                    if (*e *= *hlVfc[i])
+                    if (vfcPatterns[i]->match(e))
                         {
-                            // *= compare ignores subscripts
+                            // The match ignores subscripts
                             recognised = true;
                             if (DEBUG_SWITCH)
                                 LOG << "indirect call matches form " << i << "\n";
@@ -2618,23 +2600,18 @@ void BasicBlock::processSwitch(UserProc* proc)
     // for the ith zero-based case. It may be that the code for case 5 above will be a goto to the code for case 3,
     // but a smarter back end could group them
     std::list<ADDRESS> dests;
+    // Get the destination addresses from the switch table. The table is only read the first time
+    std::vector<ADDRESS> table;
+    if (si->chForm != 'F')
+        prog->getSwitchTables()->getDests(si, iNum, table);
     for (int i=0; i < iNum; i++)
         {
-            // Get the destination address from the switch table.
-            if (si->chForm == 'H')
-                {
-                    int iValue = prog->readNative4(si->uTable + i*2);
-                    if (iValue == -1) continue;
-                    uSwitch =prog->readNative4(si->uTable + i*8 + 4);
-                }
-            else if (si->chForm == 'F')
+            if (si->chForm == 'F')
                 uSwitch = ((int*)si->uTable)[i];
             else
-                uSwitch = prog->readNative4(si->uTable + i*4);
-            if ((si->chForm == 'O') || (si->chForm == 'R') || (si->chForm == 'r'))
-                // Offset: add table address to make a real pointer to code.  For type R, the table is relative to the
-                // branch, so take iOffset. For others, iOffset is 0, so no harm
-                uSwitch += si->uTable - si->iOffset;
+                uSwitch = table[i];
+            if (uSwitch == NO_ADDRESS)
+                continue;			// Unused hash table entry
             if (uSwitch < prog->getLimitTextHigh())
                 {
                     //tq.visit(cfg, uSwitch, this);
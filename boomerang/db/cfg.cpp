@@ -96,6 +96,12 @@ void Cfg::setProc(UserProc* proc)
     myProc = proc;
 }
 
+void Cfg::invalidateStatements()
+{
+    if (myProc)
+        myProc->invalidateStatements();
+}
+
 /*==============================================================================
  * FUNCTION:		Cfg::clear
  * OVERVIEW:		Clear the CFG of all basic blocks, ready for decode
@@ -104,6 +110,7 @@ void Cfg::setProc(UserProc* proc)
  *============================================================================*/
 void Cfg::clear()
 {
+    invalidateStatements();
     // Don't delete the BBs; this will delete any CaseStatements we want to save for the re-decode. Just let the garbage
     // collection take care of it.
     // for (std::list<PBB>::iterator it = m_listBB.begin(); it != m_listBB.end(); it++)
@@ -189,6 +196,7 @@ bool Cfg::checkEntryBB()
  *============================================================================*/
 PBB Cfg::newBB(std::list<RTL*>* pRtls, BBTYPE bbType, int iNumOutEdges) throw(BBAlreadyExistsError)
 {
+    invalidateStatements();
     MAPBB::iterator mi;
     PBB pBB;
 
@@ -313,6 +321,7 @@ PBB Cfg::newBB(std::list<RTL*>* pRtls, BBTYPE bbType, int iNumOutEdges) throw(BB
  *============================================================================*/
 PBB Cfg::newIncompleteBB(ADDRESS addr)
 {
+    invalidateStatements();
     // Create a new (basically empty) BB
     PBB pBB = new BasicBlock();
     // Add it to the list
@@ -403,6 +412,7 @@ bool Cfg::existsBB (ADDRESS uNativeAddr)
  *============================================================================*/
 PBB Cfg::splitBB (PBB pBB, ADDRESS uNativeAddr, PBB pNewBB /* = 0 */, bool bDelRtls /* = false */)
 {
+    invalidateStatements();
     std::list<RTL*>::iterator ri;
 
     // First find which RTL has the split address; note that this could fail (e.g. label in the middle of an
@@ -651,6 +661,7 @@ bool Cfg::isIncomplete(ADDRESS uAddr)
 
 void Cfg::sortByAddress()
 {
+    invalidateStatements();
     m_listBB.sort(BasicBlock::lessAddress);
 }
 
@@ -662,6 +673,7 @@ void Cfg::sortByAddress()
  *============================================================================*/
 void Cfg::sortByFirstDFT()
 {
+    invalidateStatements();
 #ifndef _WIN32
     m_listBB.sort(BasicBlock::lessFirstDFT);
 #else
@@ -682,6 +694,7 @@ void Cfg::sortByFirstDFT()
  *============================================================================*/
 void Cfg::sortByLastDFT()
 {
+    invalidateStatements();
 #ifndef _WIN32
     m_listBB.sort(BasicBlock::lessLastDFT);
 #else
@@ -825,6 +838,7 @@ bool Cfg::mergeBBs( PBB pb1, PBB pb2)
  *============================================================================*/
 void Cfg::completeMerge(PBB pb1, PBB pb2, bool bDelete = false)
 {
+    invalidateStatements();
     // First we replace all of pb1's predecessors' out edges that used to point to pb1 (usually only one of these) with
     // pb2
     for (int i=0; i < pb1->m_iNumInEdges; i++)
@@ -866,6 +880,7 @@ void Cfg::completeMerge(PBB pb1, PBB pb2, bool bDelete = false)
  *============================================================================*/
 bool Cfg::joinBB(PBB pb1, PBB pb2)
 {
+    invalidateStatements();
     // Ensure that the fallthrough case for pb1 is pb2
     std::vector<PBB>& v = pb1->getOutEdges();
     if (v.size() != 2 || v[1] != pb2)
@@ -887,6 +902,7 @@ bool Cfg::joinBB(PBB pb1, PBB pb2)
 
 void Cfg::removeBB( PBB bb)
 {
+    invalidateStatements();
     BB_IT bbit = std::find(m_listBB.begin(), m_listBB.end(), bb);
     m_listBB.erase(bbit);
 }
@@ -900,6 +916,7 @@ void Cfg::removeBB( PBB bb)
  *============================================================================*/
 bool Cfg::compressCfg()
 {
+    invalidateStatements();
     // must be well formed
     if (!m_bWellFormed) return false;
 
@@ -1763,6 +1780,7 @@ void Cfg::structure()
 
 void Cfg::addJunctionStatements()
 {
+    invalidateStatements();
     std::list<PBB>::iterator it;
     for (it = m_listBB.begin(); it != m_listBB.end(); it++)
         {
@@ -1779,6 +1797,7 @@ void Cfg::addJunctionStatements()
 
 void Cfg::removeJunctionStatements()
 {
+    invalidateStatements();
     std::list<PBB>::iterator it;
     for (it = m_listBB.begin(); it != m_listBB.end(); it++)
         {
@@ -1933,7 +1952,7 @@ void updateWorkListRev(PBB currBB, std::list<PBB>&workList, std::set<PBB>& workS
         }
 }
 
-static int progress = 0;
+static THREAD_LOCAL int progress = 0;
 void Cfg::findInterferences(ConnectionGraph& cg)
 {
     if (m_listBB.size() == 0) return;
@@ -2032,6 +2051,7 @@ void dumpBB(PBB bb)
 
 PBB Cfg::splitForBranch(PBB pBB, RTL* rtl, BranchStatement* br1, BranchStatement* br2, BB_IT& it)
 {
+    invalidateStatements();
 
 #if 0
     std::cerr << "splitForBranch before:\n";
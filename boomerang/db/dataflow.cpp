@@ -388,7 +388,7 @@ static Exp* defineAll = new Terminal(opDefineAll);		// An expression representin
 #define STACKS_EMPTY(q) (Stacks.find(q) == Stacks.end() || Stacks[q].empty())
 
 // Subscript dataflow variables
-static int progress = 0;
+static THREAD_LOCAL int progress = 0;
 bool DataFlow::renameBlockVars(UserProc* proc, int n, bool clearStacks /* = false */ )
 {
     if (++progress > 200)
@@ -0,0 +1,233 @@
+/*
+ * See the file "LICENSE.TERMS" for information on usage and
+ * redistribution of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+/*==============================================================================
+ * FILE:	   dataindex.cpp
+ * OVERVIEW:   Implementation of DataIndex, an index of the strings and pointers in the sections of a BinaryFile.
+ *============================================================================*/
+/*
+ * $Revision$
+ */
+
+#include <cstring>
+#include <algorithm>
+#include "dataindex.h"
+#include "BinaryFile.h"
+
+#define MIN_WIDE_STRING 4				// Fewer UTF-16 characters than this are too likely to be something else
+
+// Characters that can be in a string: printable ASCII and the usual escapes
+static bool isText[256];
+
+static void initText()
+{
+    if (isText['a'])
+        return;
+    for (int c = ' '; c < 0x7F; c++)
+        isText[c] = true;
+    const char *escapes = "\t\n\r\f\v\b\a\x1b";
+    for (; *escapes; escapes++)
+        isText[(unsigned char)*escapes] = true;
+}
+
+/*==============================================================================
+ * FUNCTION:		DataIndex::DataIndex
+ * OVERVIEW:		Scan every loaded section of the binary file that has contents for strings and pointers
+ * PARAMETERS:		pBF: the binary file; it must outlive the index
+ * RETURNS:			<nothing>
+ *============================================================================*/
+DataIndex::DataIndex(BinaryFile *pBF) : pBF(pBF)
+{
+    initText();
+    codeLo = pBF->getLimitTextLow();
+    codeHi = pBF->getLimitTextHigh();
+    int n = pBF->GetNumSections();
+    for (int i = 0; i < n; i++)
+        {
+            SectionInfo *si = pBF->GetSectionInfo(i);
+            if (si->uNativeAddr == 0 || si->uHostAddr == NULL || si->uSectionSize == 0 ||
+                    si->isAddressBss(si->uNativeAddr))
+                continue;
+            Run sect = {si->uNativeAddr, si->uNativeAddr + si->uSectionSize};
+            sections.push_back(sect);
+        }
+    std::sort(sections.begin(), sections.end(), runLess);
+    bigEndian = findByteOrder();
+    for (int i = 0; i < n; i++)
+        {
+            SectionInfo *si = pBF->GetSectionInfo(i);
+            if (si->uNativeAddr == 0 || si->uHostAddr == NULL || si->uSectionSize == 0 ||
+                    si->isAddressBss(si->uNativeAddr))
+                continue;
+            scanStrings(si->uHostAddr, si->uNativeAddr, si->uSectionSize);
+            scanWideStrings(si->uHostAddr, si->uNativeAddr, si->uSectionSize);
+            scanPointers(si->uHostAddr, si->uNativeAddr, si->uSectionSize);
+        }
+    std::sort(strings.begin(), strings.end(), runLess);
+    std::sort(wideStrings.begin(), wideStrings.end(), runLess);
+    std::sort(pointers.begin(), pointers.end());
+}
+
+bool DataIndex::runLess(const Run &x, const Run &y)
+{
+    return x.start < y.start;
+}
+
+// Find the run that contains a; false if none
+bool DataIndex::findRun(std::vector<Run> &runs, ADDRESS a, Run &run)
+{
+    Run key = {a + 1, a + 1};
+    std::vector<Run>::iterator it = std::upper_bound(runs.begin(), runs.end(), key, runLess);
+    if (it == runs.begin())
+        return false;
+    --it;
+    if (a >= it->end)
+        return false;
+    run = *it;
+    return true;
+}
+
+bool DataIndex::inSection(ADDRESS a)
+{
+    Run run;
+    return findRun(sections, a, run);
+}
+
+// The loaders know their own byte order; ask readNative4 about the first word that reads differently each way
+bool DataIndex::findByteOrder()
+{
+    for (unsigned i = 0; i < sections.size(); i++)
+        {
+            SectionInfo *si = pBF->GetSectionInfoByAddr(sections[i].start);
+            const unsigned char *p = si->uHostAddr;
+            for (unsigned j = 0; j + 4 <= si->uSectionSize; j += 4)
+                {
+                    unsigned le = p[j] | (p[j+1] << 8) | (p[j+2] << 16) | ((unsigned)p[j+3] << 24);
+                    unsigned be = ((unsigned)p[j] << 24) | (p[j+1] << 16) | (p[j+2] << 8) | p[j+3];
+                    if (le != be)
+                        return (unsigned)pBF->readNative4(si->uNativeAddr + j) == be;
+                }
+        }
+    return false;
+}
+
+/*==============================================================================
+ * FUNCTION:		DataIndex::scanStrings
+ * OVERVIEW:		Find the runs of two or more characters of text ending in a NUL. The NULs are found with memchr,
+ *					which looks at a word or more at a time; only the text before each one is looked at byte by byte
+ * PARAMETERS:		p: host address of the section
+ *					lo: native address of the section
+ *					size: size of the section
+ * RETURNS:			<nothing>
+ *============================================================================*/
+void DataIndex::scanStrings(const unsigned char *p, ADDRESS lo, unsigned size)
+{
+    const unsigned char *q = p, *end = p + size, *nul;
+    while ((nul = (const unsigned char*)memchr(q, 0, end - q)) != NULL)
+        {
+            const unsigned char *s = nul;
+            while (s > q && isText[s[-1]])
+                s--;
+            if (nul - s >= 2)
+                {
+                    Run run = {lo + (s - p), lo + (nul - p)};
+                    strings.push_back(run);
+                }
+            q = nul + 1;
+        }
+}
+
+// Find the runs of UTF-16 text (only the ASCII part of it) ending in a 16 bit NUL
+void DataIndex::scanWideStrings(const unsigned char *p, ADDRESS lo, unsigned size)
+{
+    int hi = bigEndian ? 0 : 1;			// Offset of the high byte of each character
+    unsigned start = 0;
+    for (unsigned i = 0; i + 2 <= size; i += 2)
+        {
+            if (p[i+hi] == 0 && isText[p[i+1-hi]])
+                continue;
+            if (p[i] == 0 && p[i+1] == 0 && (i - start) / 2 >= MIN_WIDE_STRING)
+                {
+                    Run run = {lo + start, lo + i};
+                    wideStrings.push_back(run);
+                }
+            start = i + 2;
+        }
+}
+
+// Find the aligned words whose value is an address in one of the sections
+void DataIndex::scanPointers(const unsigned char *p, ADDRESS lo, unsigned size)
+{
+    unsigned i = (4 - (lo & 3)) & 3;
+    for (; i + 4 <= size; i += 4)
+        {
+            const unsigned char *w = p + i;
+            ADDRESS val;
+            if (bigEndian)
+                val = ((unsigned)w[0] << 24) | (w[1] << 16) | (w[2] << 8) | w[3];
+            else
+                val = w[0] | (w[1] << 8) | (w[2] << 16) | ((unsigned)w[3] << 24);
+            if (val >= sections.front().start && val < sections.back().end && inSection(val))
+                pointers.push_back(std::pair<ADDRESS, ADDRESS>(lo + i, val));
+        }
+}
+
+bool DataIndex::stringAt(ADDRESS a, unsigned &len)
+{
+    Run run;
+    if (!findRun(strings, a, run))
+        return false;
+    len = run.end - a;
+    return true;
+}
+
+bool DataIndex::wideStringAt(ADDRESS a, unsigned &len)
+{
+    Run run;
+    if (!findRun(wideStrings, a, run) || ((a - run.start) & 1))
+        return false;
+    len = (run.end - a) / 2;
+    return true;
+}
+
+bool DataIndex::pointerAt(ADDRESS a, ADDRESS &target)
+{
+    std::vector<std::pair<ADDRESS, ADDRESS> >::iterator it =
+        std::lower_bound(pointers.begin(), pointers.end(), std::pair<ADDRESS, ADDRESS>(a, 0));
+    if (it == pointers.end() || it->first != a)
+        return false;
+    target = it->second;
+    return true;
+}
+
+/*==============================================================================
+ * FUNCTION:		DataIndex::codePointerRun
+ * OVERVIEW:		Count the words from a on that point into the code, stopping at the first that doesn't. A table
+ *					that is not aligned, or not in a section that was scanned, is read a word at a time instead
+ * PARAMETERS:		a: native address of the first word
+ *					max: the most words to count
+ * RETURNS:			The number of words
+ *============================================================================*/
+int DataIndex::codePointerRun(ADDRESS a, int max)
+{
+    int n = 0;
+    if ((a & 3) || !inSection(a))
+        {
+            for (; n < max; n++)
+                {
+                    ADDRESS val = (unsigned)pBF->readNative4(a + n * 4);
+                    if (val < codeLo || val >= codeHi)
+                        break;
+                }
+            return n;
+        }
+    std::vector<std::pair<ADDRESS, ADDRESS> >::iterator it =
+        std::lower_bound(pointers.begin(), pointers.end(), std::pair<ADDRESS, ADDRESS>(a, 0));
+    for (; n < max && it != pointers.end(); n++, ++it)
+        if (it->first != a + n * 4 || it->second < codeLo || it->second >= codeHi)
+            break;
+    return n;
+}
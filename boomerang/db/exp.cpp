@@ -34,14 +34,18 @@
 #include "operstrings.h"// Defines a large array of strings for the createDotFile etc. functions. Needs -I. to find it
 #include "util.h"
 #include "boomerang.h"
-//#include "transformer.h"
+#include "transformer.h"
+#include "exppattern.h"
 #include "visitor.h"
 #include "log.h"
+#include "lock.h"
 #include <iomanip>			// For std::setw etc
 #include <cstring>
 
 extern char debug_buffer[];		 ///< For prints functions
 
+unsigned long Exp::numCreated = 0;
+
 /*==============================================================================
  * FUNCTION:		Const::Const etc
  * OVERVIEW:		Constructors
@@ -268,6 +272,8 @@ void Unary::setSubExp1(Exp* e)
 {
     if (subExp1 != 0)
         ;//delete subExp1;
+    if (subExp1 != e)
+        simplified = false;
     subExp1 = e;
     assert(subExp1);
 }
@@ -275,6 +281,8 @@ void Binary::setSubExp2(Exp* e)
 {
     if (subExp2 != 0)
         ;//delete subExp2;
+    if (subExp2 != e)
+        simplified = false;
     subExp2 = e;
     assert(subExp1 && subExp2);
 }
@@ -282,6 +290,8 @@ void Ternary::setSubExp3(Exp* e)
 {
     if (subExp3 != 0)
         ;//delete subExp3;
+    if (subExp3 != e)
+        simplified = false;
     subExp3 = e;
     assert(subExp1 && subExp2 && subExp3);
 }
@@ -299,6 +309,7 @@ Exp* Unary::getSubExp1()
 Exp*& Unary::refSubExp1()
 {
     assert(subExp1);
+    simplified = false;			// The caller may change the subexpression through the reference
     return subExp1;
 }
 Exp* Binary::getSubExp2()
@@ -309,6 +320,7 @@ Exp* Binary::getSubExp2()
 Exp*& Binary::refSubExp2()
 {
     assert(subExp1 && subExp2);
+    simplified = false;			// The caller may change the subexpression through the reference
     return subExp2;
 }
 Exp* Ternary::getSubExp3()
@@ -319,6 +331,7 @@ Exp* Ternary::getSubExp3()
 Exp*& Ternary::refSubExp3()
 {
     assert(subExp1 && subExp2 && subExp3);
+    simplified = false;			// The caller may change the subexpression through the reference
     return subExp3;
 }
 
@@ -350,6 +363,7 @@ void Binary::commute()
     Exp* t = subExp1;
     subExp1 = subExp2;
     subExp2 = t;
+    simplified = false;
     assert(subExp1 && subExp2);
 }
 
@@ -1763,210 +1777,28 @@ Exp* TypeVal::match(Exp *pattern)
 }
 #endif
 
-#define ISVARIABLE(x) (strspn((x), "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789") == strlen((x)))
-//#define DEBUG_MATCH
-
-const char *tlstrchr(const char *str, char ch)
-{
-    while (str && *str)
-        {
-            if (*str == ch)
-                return str;
-            if (*str == '[' || *str == '{' || *str == '(')
-                {
-                    char close = ']';
-                    if (*str == '{')
-                        close = '}';
-                    if (*str == '(')
-                        close = ')';
-                    while (*str && *str != close)
-                        str++;
-                }
-            if (*str)
-                str++;
-        }
-    return NULL;
-}
-
 /*==============================================================================
  * FUNCTION:		Exp::match
  * OVERVIEW:		Matches this expression to the given patten
+ * NOTE:			Each pattern string is parsed into an ExpPattern once, and kept for later matches
  * PARAMETERS:		pattern to match, map of bindings
  * RETURNS:			true if match, false otherwise
  *============================================================================*/
-bool Exp::match(const char *pattern, std::map<std::string, Exp*> &bindings)
-{
-    // most obvious
-    std::ostringstream ostr;
-    this->print(ostr);
-    if (ostr.str() == pattern)
-        return true;
-
-    // alright, is pattern an acceptable variable?
-    if (ISVARIABLE(pattern))
-        {
-            bindings[pattern] = this;
-            return true;
-        }
+static std::map<std::string, ExpPattern*> compiledPatterns;
+static Mutex compiledPatternsMutex;		// Patterns are matched on the code generation threads too
 
-    // no, fail
-    return false;
-}
-bool Unary::match(const char *pattern, std::map<std::string, Exp*> &bindings)
-{
-    if (Exp::match(pattern, bindings))
-        return true;
-#ifdef DEBUG_MATCH
-    LOG << "unary::match " << this << " to " << pattern << ".\n";
-#endif
-    if (op == opAddrOf && pattern[0] == 'a' && pattern[1] == '[' &&
-            pattern[strlen(pattern)-1] == ']')
-        {
-            char *sub1 = strdup(pattern+2);
-            sub1[strlen(sub1)-1] = 0;
-            return subExp1->match(sub1, bindings);
-        }
-    return false;
-}
-bool Binary::match(const char *pattern, std::map<std::string, Exp*> &bindings)
-{
-    if (Exp::match(pattern, bindings))
-        return true;
-#ifdef DEBUG_MATCH
-    LOG << "binary::match " << this << " to " << pattern << ".\n";
-#endif
-    if (op == opMemberAccess && tlstrchr(pattern, '.'))
-        {
-            char *sub1 = strdup(pattern);
-            char *sub2 = (char*)tlstrchr(sub1, '.');
-            *sub2++ = 0;
-            if (subExp1->match(sub1, bindings))
-                {
-                    assert(subExp2->isStrConst());
-                    if (!strcmp(sub2, ((Const*)subExp2)->getStr()))
-                        return true;
-                    if (ISVARIABLE(sub2))
-                        {
-                            bindings[sub2] = subExp2;
-                            return true;
-                        }
-                }
-        }
-    if (op == opArrayIndex)
-        {
-            if (pattern[strlen(pattern)-1] != ']')
-                return false;
-            char *sub1 = strdup(pattern);
-            char *sub2 = strrchr(sub1, '[');
-            *sub2++ = 0;
-            sub2[strlen(sub2)-1] = 0;
-            if (subExp1->match(sub1, bindings) && subExp2->match(sub2, bindings))
-                return true;
-        }
-    if (op == opPlus && tlstrchr(pattern, '+'))
-        {
-            char *sub1 = strdup(pattern);
-            char *sub2 = (char*)tlstrchr(sub1, '+');
-            *sub2++ = 0;
-            while (*sub2 == ' ')
-                sub2++;
-            while (sub1[strlen(sub1)-1] == ' ')
-                sub1[strlen(sub1)-1] = 0;
-            if (subExp1->match(sub1, bindings) && subExp2->match(sub2, bindings))
-                return true;
-        }
-    if (op == opMinus && tlstrchr(pattern, '-'))
-        {
-            char *sub1 = strdup(pattern);
-            char *sub2 = (char*)tlstrchr(sub1, '-');
-            *sub2++ = 0;
-            while (*sub2 == ' ')
-                sub2++;
-            while (sub1[strlen(sub1)-1] == ' ')
-                sub1[strlen(sub1)-1] = 0;
-            if (subExp1->match(sub1, bindings) && subExp2->match(sub2, bindings))
-                return true;
-        }
-    return false;
-}
-bool Ternary::match(const char *pattern, std::map<std::string, Exp*> &bindings)
-{
-    if (Exp::match(pattern, bindings))
-        return true;
-#ifdef DEBUG_MATCH
-    LOG << "ternary::match " << this << " to " << pattern << ".\n";
-#endif
-    return false;
-}
-bool RefExp::match(const char *pattern, std::map<std::string, Exp*> &bindings)
-{
-    if (Exp::match(pattern, bindings))
-        return true;
-#ifdef DEBUG_MATCH
-    LOG << "refexp::match " << this << " to " << pattern << ".\n";
-#endif
-    const char *end = pattern + strlen(pattern) - 1;
-    if (end > pattern && *end == '}')
-        {
-            end--;
-            if (*end == '-' && def == NULL)
-                {
-                    char *sub = strdup(pattern);
-                    *(sub + (end - 1 - pattern)) = 0;
-                    return subExp1->match(sub, bindings);
-                }
-            end = strrchr(end, '{');
-            if (end)
-                {
-                    if (atoi(end + 1) == def->getNumber())
-                        {
-                            char *sub = strdup(pattern);
-                            *(sub + (end - pattern)) = 0;
-                            return subExp1->match(sub, bindings);
-                        }
-                }
-        }
-    return false;
-}
-bool Const::match(const char *pattern, std::map<std::string, Exp*> &bindings)
-{
-    if (Exp::match(pattern, bindings))
-        return true;
-#ifdef DEBUG_MATCH
-    LOG << "const::match " << this << " to " << pattern << ".\n";
-#endif
-    return false;
-}
-bool Terminal::match(const char *pattern, std::map<std::string, Exp*> &bindings)
-{
-    if (Exp::match(pattern, bindings))
-        return true;
-#ifdef DEBUG_MATCH
-    LOG << "terminal::match " << this << " to " << pattern << ".\n";
-#endif
-    return false;
-}
-bool Location::match(const char *pattern, std::map<std::string, Exp*> &bindings)
+bool Exp::match(const char *pattern, std::map<std::string, Exp*> &bindings)
 {
-    if (Exp::match(pattern, bindings))
-        return true;
-#ifdef DEBUG_MATCH
-    LOG << "location::match " << this << " to " << pattern << ".\n";
-#endif
-    if (op == opMemOf || op == opRegOf)
-        {
-            char ch = 'm';
-            if (op == opRegOf)
-                ch = 'r';
-            if (pattern[0] != ch || pattern[1] != '[')
-                return false;
-            if (pattern[strlen(pattern)-1] != ']')
-                return false;
-            char *sub = strdup(pattern + 2);
-            *(sub + strlen(sub) - 1) = 0;
-            return subExp1->match(sub, bindings);
-        }
-    return false;
+    ExpPattern *compiled;
+    {
+        Lock lock(compiledPatternsMutex);
+        std::map<std::string, ExpPattern*>::iterator it = compiledPatterns.find(pattern);
+        if (it == compiledPatterns.end())
+            it = compiledPatterns.insert(std::pair<std::string, ExpPattern*>(pattern, new ExpPattern(pattern))).first;
+        compiled = it->second;
+    }
+    // A compiled pattern is never changed, so it can be matched without the lock
+    return compiled->match(this, bindings);
 }
 
 /*==============================================================================
@@ -2207,24 +2039,24 @@ Exp* Unary::simplifyArith()
     if (op == opMemOf || op == opRegOf || op == opAddrOf || op == opSubscript)
         {
             // assume we want to simplify the subexpression
-            subExp1 = subExp1->simplifyArith();
+            setSubExp1(subExp1->simplifyArith());
         }
     return this;			// Else, do nothing
 }
 
 Exp* Ternary::simplifyArith()
 {
-    subExp1 = subExp1->simplifyArith();
-    subExp2 = subExp2->simplifyArith();
-    subExp3 = subExp3->simplifyArith();
+    setSubExp1(subExp1->simplifyArith());
+    setSubExp2(subExp2->simplifyArith());
+    setSubExp3(subExp3->simplifyArith());
     return this;
 }
 
 Exp* Binary::simplifyArith()
 {
     assert(subExp1 && subExp2);
-    subExp1 = subExp1->simplifyArith();		// FIXME: does this make sense?
-    subExp2 = subExp2->simplifyArith();		// FIXME: ditto
+    setSubExp1(subExp1->simplifyArith());		// FIXME: does this make sense?
+    setSubExp2(subExp2->simplifyArith());		// FIXME: ditto
     if ((op != opPlus) && (op != opMinus))
         return this;
 
@@ -2361,10 +2193,11 @@ Exp* Exp::simplify()
 #if DEBUG_SIMP
     Exp* save = clone();
 #endif
+    if (isSimplified())
+        return this;					// Nothing has changed since the last simplify
     bool bMod = false;					// True if simplified at this or lower level
     Exp* res = this;
-    //res = ExpTransformer::applyAllTo(res, bMod);
-    //return res;
+    bool transform = Boomerang::get()->useTransformations;
     do
         {
             bMod = false;
@@ -2377,6 +2210,18 @@ Exp* Exp::simplify()
             } */
         }
     while (bMod);				// If modified at this (or a lower) level, redo
+    if (transform)
+        {
+            // With -Tr, then apply the rules in transformations/*.t once, and tidy up after them. Only once, since a
+            // rule reports a change whenever it applies, even if it changes nothing (e.g. x + y to x + y)
+            res = ExpTransformer::applyAllTo(res, bMod);
+            while (bMod)
+                {
+                    bMod = false;
+                    res = res->polySimplify(bMod);
+                }
+        }
+    res->setSimplified();
     // The below is still important. E.g. want to canonicalise sums, so we know that a + K + b is the same as a + b + K
     // No! This slows everything down, and it's slow enough as it is. Call only where needed:
     // res = res->simplifyArith();
@@ -2387,6 +2232,88 @@ Exp* Exp::simplify()
     return res;
 }
 
+/*==============================================================================
+ * FUNCTION:		Exp::isSimplified
+ * OVERVIEW:		Check whether this expression is known to be in the form that simplify() leaves it in, i.e. whether
+ *					every node still has the flag that simplify() set on it
+ * PARAMETERS:		<none>
+ * RETURNS:			True if simplify() would return this expression unchanged
+ *============================================================================*/
+bool Exp::isSimplified()
+{
+    if (!simplified)
+        return false;
+    switch (getArity())
+        {
+        case 3:
+            if (!((Ternary*)this)->getSubExp3()->isSimplified())
+                return false;
+            // Fall through
+        case 2:
+            if (!((Binary*)this)->getSubExp2()->isSimplified())
+                return false;
+            // Fall through
+        case 1:
+            return ((Unary*)this)->getSubExp1()->isSimplified();
+        default:
+            return true;
+        }
+}
+
+/*==============================================================================
+ * FUNCTION:		Exp::setSimplified
+ * OVERVIEW:		Mark every node of this (just simplified) expression as simplified. Nodes whose simplification
+ *					depends on more than the expression itself are left unmarked, so they are always simplified again:
+ *					r0{def} (depends on the definition), x{def} + K (depends on the type of x) and
+ *					fsize(a, b, m[K]) (depends on the proc of the location)
+ * PARAMETERS:		<none>
+ * RETURNS:			<nothing>
+ *============================================================================*/
+void Exp::setSimplified()
+{
+    int arity = getArity();
+    if (arity >= 1)
+        ((Unary*)this)->getSubExp1()->setSimplified();
+    if (arity >= 2)
+        ((Binary*)this)->getSubExp2()->setSimplified();
+    if (arity >= 3)
+        ((Ternary*)this)->getSubExp3()->setSimplified();
+    if (op == opSubscript && ((RefExp*)this)->getSubExp1()->isRegN(0) && ((RefExp*)this)->getDef())
+        return;
+    if (op == opPlus && ((Binary*)this)->getSubExp1()->isSubscript() && ((Binary*)this)->getSubExp2()->isIntConst())
+        return;
+    if (op == opFsize && ((Ternary*)this)->getSubExp3()->isMemOf())
+        return;
+    simplified = true;
+}
+
+/*==============================================================================
+ * FUNCTION:		Exp::hash
+ * OVERVIEW:		Hash the operators and constants of this expression, e.g. to index a cache of expressions. Types,
+ *					definitions and conscripts are not hashed, since operator== does not always compare them
+ * PARAMETERS:		<none>
+ * RETURNS:			The hash
+ *============================================================================*/
+unsigned Exp::hash()
+{
+    unsigned h = op;
+    if (op == opIntConst)
+        h = h * 31 + ((Const*)this)->getInt();
+    else if (op == opStrConst)
+        {
+            for (const char *p = ((Const*)this)->getStr(); *p; p++)
+                h = h * 31 + *p;
+        }
+    int arity = getArity();
+    if (arity >= 1)
+        h = h * 31 + ((Unary*)this)->getSubExp1()->hash();
+    if (arity >= 2)
+        h = h * 31 + ((Binary*)this)->getSubExp2()->hash();
+    if (arity >= 3)
+        h = h * 31 + ((Ternary*)this)->getSubExp3()->hash();
+    return h;
+}
+
 /*==============================================================================
  * FUNCTION:		Unary::polySimplify etc
  * OVERVIEW:		Do the work of simplification
@@ -2518,7 +2445,7 @@ Exp* Unary::polySimplify(bool& bMod)
             // The below IS bad now. It undoes the simplification of
             // m[r29 + -4] to m[r29 - 4]
             // If really needed, do another polySimplify, or swap the order
-            //subExp1 = subExp1->simplifyArith();		// probably bad
+            //setSubExp1(subExp1->simplifyArith());		// probably bad
         }
         break;
         default:
@@ -3599,7 +3526,7 @@ Exp* Unary::simplifyAddr()
     if (op != opAddrOf)
         {
             // Not a[ anything ]. Recurse
-            subExp1 = subExp1->simplifyAddr();
+            setSubExp1(subExp1->simplifyAddr());
             return this;
         }
     if (subExp1->getOper() == opMemOf)
@@ -3622,7 +3549,7 @@ Exp* Unary::simplifyAddr()
         }
 
     // a[ something else ]. Still recurse, just in case
-    subExp1 = subExp1->simplifyAddr();
+    setSubExp1(subExp1->simplifyAddr());
     return this;
 }
 
@@ -3630,16 +3557,16 @@ Exp* Binary::simplifyAddr()
 {
     assert(subExp1 && subExp2);
 
-    subExp1 = subExp1->simplifyAddr();
-    subExp2 = subExp2->simplifyAddr();
+    setSubExp1(subExp1->simplifyAddr());
+    setSubExp2(subExp2->simplifyAddr());
     return this;
 }
 
 Exp* Ternary::simplifyAddr()
 {
-    subExp1 = subExp1->simplifyAddr();
-    subExp2 = subExp2->simplifyAddr();
-    subExp3 = subExp3->simplifyAddr();
+    setSubExp1(subExp1->simplifyAddr());
+    setSubExp2(subExp2->simplifyAddr());
+    setSubExp3(subExp3->simplifyAddr());
     return this;
 }
 
@@ -3768,8 +3695,10 @@ Exp* Exp::killFill()
     std::list<Exp**>::iterator it;
     for (it = result.begin(); it != result.end(); it++)
         {
-            // Kill the sign extend bits
+            // Kill the sign extend bits. The parent of **it is not known, so clear the flag on the operand instead;
+            // that is enough to stop the whole expression being taken as already simplified
             **it = ((Ternary*)(**it))->getSubExp3();
+            (**it)->clearSimplified();
         }
     return res;
 }
@@ -4262,7 +4191,7 @@ const char* Const::getFuncName()
 
 Exp* Unary::simplifyConstraint()
 {
-    subExp1 = subExp1->simplifyConstraint();
+    setSubExp1(subExp1->simplifyConstraint());
     return this;
 }
 
@@ -4270,8 +4199,8 @@ Exp* Binary::simplifyConstraint()
 {
     assert(subExp1 && subExp2);
 
-    subExp1 = subExp1->simplifyConstraint();
-    subExp2 = subExp2->simplifyConstraint();
+    setSubExp1(subExp1->simplifyConstraint());
+    setSubExp2(subExp2->simplifyConstraint());
     switch (op)
         {
         case opEquals:
@@ -4425,7 +4354,7 @@ Exp* Unary::accept(ExpModifier* v)
     // postVisit doesn't care about the type of ret. So let's call it a Unary, and the type system is happy
     bool recur;
     Unary* ret = (Unary*)v->preVisit(this, recur);
-    if (recur) subExp1 = subExp1->accept(v);
+    if (recur) setSubExp1(subExp1->accept(v));
     return v->postVisit(ret);
 }
 Exp* Binary::accept(ExpModifier* v)
@@ -4434,17 +4363,17 @@ Exp* Binary::accept(ExpModifier* v)
 
     bool recur;
     Binary* ret = (Binary*)v->preVisit(this, recur);
-    if (recur) subExp1 = subExp1->accept(v);
-    if (recur) subExp2 = subExp2->accept(v);
+    if (recur) setSubExp1(subExp1->accept(v));
+    if (recur) setSubExp2(subExp2->accept(v));
     return v->postVisit(ret);
 }
 Exp* Ternary::accept(ExpModifier* v)
 {
     bool recur;
     Ternary* ret = (Ternary*)v->preVisit(this, recur);
-    if (recur) subExp1 = subExp1->accept(v);
-    if (recur) subExp2 = subExp2->accept(v);
-    if (recur) subExp3 = subExp3->accept(v);
+    if (recur) setSubExp1(subExp1->accept(v));
+    if (recur) setSubExp2(subExp2->accept(v));
+    if (recur) setSubExp3(subExp3->accept(v));
     return v->postVisit(ret);
 }
 
@@ -4454,7 +4383,7 @@ Exp* Location::accept(ExpModifier* v)
     // important here!  (it makes a call to a different visitor member function).
     bool recur;
     Location* ret = (Location*)v->preVisit(this, recur);
-    if (recur) subExp1 = subExp1->accept(v);
+    if (recur) setSubExp1(subExp1->accept(v));
     return v->postVisit(ret);
 }
 
@@ -4462,7 +4391,7 @@ Exp* RefExp::accept(ExpModifier* v)
 {
     bool recur;
     RefExp* ret = (RefExp*)v->preVisit(this, recur);
-    if (recur) subExp1 = subExp1->accept(v);
+    if (recur) setSubExp1(subExp1->accept(v));
     return v->postVisit(ret);
 }
 
@@ -4470,7 +4399,7 @@ Exp* FlagDef::accept(ExpModifier* v)
 {
     bool recur;
     FlagDef* ret = (FlagDef*)v->preVisit(this, recur);
-    if (recur) subExp1 = subExp1->accept(v);
+    if (recur) setSubExp1(subExp1->accept(v));
     return v->postVisit(ret);
 }
 
@@ -4478,7 +4407,7 @@ Exp* TypedExp::accept(ExpModifier* v)
 {
     bool recur;
     TypedExp* ret = (TypedExp*)v->preVisit(this, recur);
-    if (recur) subExp1 = subExp1->accept(v);
+    if (recur) setSubExp1(subExp1->accept(v));
     return v->postVisit(ret);
 }
 
@@ -0,0 +1,381 @@
+/*
+ * See the file "LICENSE.TERMS" for information on usage and
+ * redistribution of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+/*==============================================================================
+ * FILE:	   exppattern.cpp
+ * OVERVIEW:   Implementation of ExpPattern, an expression pattern that is compiled once and then matched by walking
+ *				the expression tree directly.
+ *============================================================================*/
+/*
+ * $Revision$
+ */
+
+#include <cassert>
+#include <cstring>
+#include <cstdlib>
+#include <sstream>
+#include "exppattern.h"
+#include "exp.h"
+#include "type.h"
+#include "statement.h"
+
+ExpPattern::ExpPattern(Exp *pattern, bool ignoreSubscripts) : ignoreSubscripts(ignoreSubscripts)
+{
+    compile(pattern);
+}
+
+ExpPattern::ExpPattern(const char *pattern) : ignoreSubscripts(false)
+{
+    parse(pattern);
+}
+
+// Return the index of the binding for a wildcard. Named wildcards share one binding per name
+int ExpPattern::addBinding(const std::string &name)
+{
+    if (name != "")
+        {
+            for (unsigned i = 0; i < names.size(); i++)
+                if (names[i] == name)
+                    return i;
+        }
+    names.push_back(name);
+    return names.size() - 1;
+}
+
+/*==============================================================================
+ * FUNCTION:		ExpPattern::compile
+ * OVERVIEW:		Append the preorder code for the pattern expression
+ * PARAMETERS:		pattern: the pattern, or part of it
+ * RETURNS:			<nothing>
+ *============================================================================*/
+void ExpPattern::compile(Exp *pattern)
+{
+    Node n;
+    n.kind = PAT_OPER;
+    n.op = pattern->getOper();
+    n.arity = 0;
+    n.i = 0;
+    n.d = 0.0;
+    n.type = NULL;
+    n.var = -1;
+    switch (n.op)
+        {
+        case opWild:
+            n.kind = PAT_WILD;
+            n.var = addBinding("");
+            break;
+        case opVar:
+            n.kind = PAT_WILD;
+            n.var = addBinding(((Const*)pattern->getSubExp1())->getStr());
+            break;
+        case opWildIntConst:
+        case opWildStrConst:
+        case opWildMemOf:
+        case opWildRegOf:
+        case opWildAddrOf:
+            n.kind = PAT_WILDOPER;
+            n.op = n.op == opWildIntConst ? opIntConst : n.op == opWildStrConst ? opStrConst :
+                   n.op == opWildMemOf ? opMemOf : n.op == opWildRegOf ? opRegOf : opAddrOf;
+            n.var = addBinding("");
+            break;
+        case opIntConst:
+            n.kind = PAT_INTCONST;
+            n.i = ((Const*)pattern)->getInt();
+            break;
+        case opFltConst:
+            n.kind = PAT_FLTCONST;
+            n.d = ((Const*)pattern)->getFlt();
+            break;
+        case opStrConst:
+            n.kind = PAT_STRCONST;
+            n.s = ((Const*)pattern)->getStr();
+            break;
+        case opTypedExp:
+            n.kind = PAT_TYPEDEXP;
+            n.type = ((TypedExp*)pattern)->getType();
+            code.push_back(n);
+            compile(pattern->getSubExp1());
+            return;
+        case opSubscript:
+        {
+            if (ignoreSubscripts)
+                {
+                    compile(pattern->getSubExp1());
+                    return;
+                }
+            n.kind = PAT_REF;
+            Statement *def = ((RefExp*)pattern)->getDef();
+            n.i = def == NULL ? -1 : def == (Statement*)-1 ? -2 : def->getNumber();
+            code.push_back(n);
+            compile(pattern->getSubExp1());
+            return;
+        }
+        default:
+            n.arity = pattern->getArity();
+            break;
+        }
+    code.push_back(n);
+    if (n.kind != PAT_OPER)
+        return;
+    if (n.arity >= 1)
+        compile(pattern->getSubExp1());
+    if (n.arity >= 2)
+        compile(pattern->getSubExp2());
+    if (n.arity >= 3)
+        compile(pattern->getSubExp3());
+}
+
+// An identifier, i.e. a named wildcard in a pattern string
+static bool isVariable(const std::string &s)
+{
+    if (s.empty() || isdigit(s[0]))
+        return false;
+    return strspn(s.c_str(), "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789") == s.size();
+}
+
+// Find the first ch in s that is not inside brackets, braces or parentheses, or npos
+static size_t topLevelFind(const std::string &s, char ch)
+{
+    int depth = 0;
+    for (size_t i = 0; i < s.size(); i++)
+        {
+            if (s[i] == ch && depth == 0)
+                return i;
+            if (s[i] == '[' || s[i] == '{' || s[i] == '(')
+                depth++;
+            else if ((s[i] == ']' || s[i] == '}' || s[i] == ')') && depth > 0)
+                depth--;
+        }
+    return std::string::npos;
+}
+
+// Find the bracket that opens the one that closes s, or npos
+static size_t openingBracket(const std::string &s)
+{
+    int depth = 0;
+    for (size_t i = s.size(); i-- > 0; )
+        {
+            if (s[i] == ']')
+                depth++;
+            else if (s[i] == '[' && --depth == 0)
+                return i;
+        }
+    return std::string::npos;
+}
+
+/*==============================================================================
+ * FUNCTION:		ExpPattern::parse
+ * OVERVIEW:		Append the preorder code for a pattern string. The forms understood are those that the old string
+ *					matcher understood: identifiers (named wildcards), integers, x + y, x - y, m[x], r[x], a[x], x[y],
+ *					x.member and x{n} or x{-}. Anything else is matched against the printed form of the expression
+ * PARAMETERS:		pattern: the pattern string, or part of it
+ * RETURNS:			<nothing>
+ *============================================================================*/
+void ExpPattern::parse(const char *pattern)
+{
+    std::string s(pattern);
+    size_t first = s.find_first_not_of(' ');
+    if (first == std::string::npos)
+        s = "";
+    else
+        s = s.substr(first, s.find_last_not_of(' ') - first + 1);
+
+    Node n;
+    n.kind = PAT_OPER;
+    n.op = opNil;
+    n.arity = 0;
+    n.i = 0;
+    n.d = 0.0;
+    n.type = NULL;
+    n.var = -1;
+
+    if (isVariable(s))
+        {
+            n.kind = PAT_WILD;
+            n.var = addBinding(s);
+            code.push_back(n);
+            return;
+        }
+    char *end;
+    long val = strtol(s.c_str(), &end, 0);
+    if (!s.empty() && *end == '\0')
+        {
+            n.kind = PAT_INTCONST;
+            n.i = (int)val;
+            code.push_back(n);
+            return;
+        }
+    size_t at = topLevelFind(s, '+');
+    if (at == std::string::npos || at == 0)
+        {
+            at = topLevelFind(s, '-');
+            if (at != std::string::npos && at != 0)
+                n.op = opMinus;
+        }
+    else
+        n.op = opPlus;
+    if (n.op != opNil)
+        {
+            n.arity = 2;
+            code.push_back(n);
+            parse(s.substr(0, at).c_str());
+            parse(s.substr(at + 1).c_str());
+            return;
+        }
+    if (s.size() > 2 && s[s.size()-1] == '}' && s.rfind('{') != std::string::npos)
+        {
+            // x{n} or x{-}
+            size_t open = s.rfind('{');
+            std::string ref = s.substr(open + 1, s.size() - open - 2);
+            n.kind = PAT_REF;
+            n.i = ref == "-" ? -1 : atoi(ref.c_str());
+            code.push_back(n);
+            parse(s.substr(0, open).c_str());
+            return;
+        }
+    size_t open = s.size() > 2 && s[s.size()-1] == ']' ? openingBracket(s) : std::string::npos;
+    if (open == 1 && (s[0] == 'm' || s[0] == 'r' || s[0] == 'a'))
+        {
+            n.op = s[0] == 'm' ? opMemOf : s[0] == 'r' ? opRegOf : opAddrOf;
+            n.arity = 1;
+            code.push_back(n);
+            parse(s.substr(2, s.size() - 3).c_str());
+            return;
+        }
+    if (open != std::string::npos && open != 0)
+        {
+            n.op = opArrayIndex;
+            n.arity = 2;
+            code.push_back(n);
+            parse(s.substr(0, open).c_str());
+            parse(s.substr(open + 1, s.size() - open - 2).c_str());
+            return;
+        }
+    at = topLevelFind(s, '.');
+    if (at != std::string::npos && at != 0)
+        {
+            n.op = opMemberAccess;
+            n.arity = 2;
+            code.push_back(n);
+            parse(s.substr(0, at).c_str());
+            std::string member = s.substr(at + 1);
+            Node m = n;
+            m.arity = 0;
+            if (isVariable(member))
+                {
+                    m.kind = PAT_WILD;
+                    m.var = addBinding(member);
+                }
+            else
+                {
+                    m.kind = PAT_STRCONST;
+                    m.s = member;
+                }
+            code.push_back(m);
+            return;
+        }
+    n.kind = PAT_TEXT;
+    n.s = s;
+    code.push_back(n);
+}
+
+/*==============================================================================
+ * FUNCTION:		ExpPattern::matchAt
+ * OVERVIEW:		Match e against the pattern code at pc, advancing pc past it
+ * PARAMETERS:		pc: index of the code for this part of the pattern
+ *					e: the expression to match
+ *					bindings: the subexpression matched so far by each wildcard (NULL if none yet)
+ * RETURNS:			True if e matches
+ *============================================================================*/
+bool ExpPattern::matchAt(unsigned &pc, Exp *e, std::vector<Exp*> &bindings)
+{
+    const Node &n = code[pc++];
+    Exp *orig = e;
+    if (ignoreSubscripts)
+        while (e->isSubscript())
+            e = ((RefExp*)e)->getSubExp1();
+    switch (n.kind)
+        {
+        case PAT_WILDOPER:
+            if (e->getOper() != n.op)
+                return false;
+            // Fall through
+        case PAT_WILD:
+            if (n.var < 0)
+                return true;
+            if (bindings[n.var] == NULL)
+                {
+                    bindings[n.var] = orig;
+                    return true;
+                }
+            // The same name again; it must match the same thing
+            if (ignoreSubscripts)
+                return *bindings[n.var] *= *orig;
+            return *bindings[n.var] == *orig;
+        case PAT_INTCONST:
+            return e->getOper() == opIntConst && ((Const*)e)->getConscript() == 0 && ((Const*)e)->getInt() == n.i;
+        case PAT_FLTCONST:
+            return e->getOper() == opFltConst && ((Const*)e)->getConscript() == 0 && ((Const*)e)->getFlt() == n.d;
+        case PAT_STRCONST:
+            return e->getOper() == opStrConst && ((Const*)e)->getConscript() == 0 && n.s == ((Const*)e)->getStr();
+        case PAT_TYPEDEXP:
+            if (e->getOper() != opTypedExp || !(*((TypedExp*)e)->getType() == *n.type))
+                return false;
+            return matchAt(pc, e->getSubExp1(), bindings);
+        case PAT_REF:
+        {
+            if (!e->isSubscript())
+                return false;
+            Statement *def = ((RefExp*)e)->getDef();
+            if (n.i == -1 && def != NULL)
+                return false;
+            if (n.i >= 0 && (def == NULL || def->getNumber() != n.i))
+                return false;
+            return matchAt(pc, e->getSubExp1(), bindings);
+        }
+        case PAT_TEXT:
+        {
+            std::ostringstream ost;
+            orig->print(ost);
+            return ost.str() == n.s;
+        }
+        case PAT_OPER:
+            if (e->getOper() != n.op || e->getArity() != n.arity)
+                return false;
+            if (n.arity >= 1 && !matchAt(pc, e->getSubExp1(), bindings))
+                return false;
+            if (n.arity >= 2 && !matchAt(pc, e->getSubExp2(), bindings))
+                return false;
+            if (n.arity >= 3 && !matchAt(pc, e->getSubExp3(), bindings))
+                return false;
+            return true;
+        }
+    return false;
+}
+
+bool ExpPattern::match(Exp *e)
+{
+    std::vector<Exp*> bindings;
+    return match(e, bindings);
+}
+
+bool ExpPattern::match(Exp *e, std::vector<Exp*> &bindings)
+{
+    bindings.assign(names.size(), (Exp*)NULL);
+    unsigned pc = 0;
+    return matchAt(pc, e, bindings);
+}
+
+bool ExpPattern::match(Exp *e, std::map<std::string, Exp*> &bindings)
+{
+    std::vector<Exp*> found;
+    if (!match(e, found))
+        return false;
+    for (unsigned i = 0; i < names.size(); i++)
+        if (names[i] != "")
+            bindings[names[i]] = found[i];
+    return true;
+}
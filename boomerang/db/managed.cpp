@@ -20,6 +20,7 @@
  */
 
 #include <sstream>
+#include <iomanip>			// For std::setw
 #include <cstring>
 
 #include "types.h"
@@ -29,6 +30,8 @@
 #include "log.h"
 #include "boomerang.h"
 #include "proc.h"
+#include "basicblock.h"
+#include "lock.h"
 
 extern char debug_buffer[];		// For prints functions
 
@@ -52,10 +55,343 @@ std::ostream& operator<<(std::ostream& os, LocationSet* ls)
 }
 
 
+//
+// SparseBitSet methods
+//
+
+// Number of bits set in w
+static inline unsigned countBits(SparseBitSet::word w)
+{
+    unsigned n = 0;
+    for (; w; n++)
+        w &= w - 1;
+    return n;
+}
+
+void SparseBitSet::iterator::advance()
+{
+    for (; ci < chunks->size(); ci++, bit = 0)
+        {
+            const Chunk& c = (*chunks)[ci];
+            for (; bit < CHUNK_BITS; bit++)
+                {
+                    word w = c.bits[bit / WORD_BITS] >> (bit % WORD_BITS);
+                    if (w == 0)
+                        {
+                            // Nothing more in this word; skip to the start of the next
+                            bit |= WORD_BITS - 1;
+                            continue;
+                        }
+                    while ((w & 1) == 0)
+                        {
+                            w >>= 1;
+                            bit++;
+                        }
+                    return;
+                }
+        }
+    bit = 0;
+}
+
+unsigned SparseBitSet::findChunk(unsigned base) const
+{
+    unsigned lo = 0, hi = chunks.size();
+    while (lo < hi)
+        {
+            unsigned mid = (lo + hi) / 2;
+            if (chunks[mid].base < base)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+    return lo;
+}
+
+// Make this set the union of itself and other
+void SparseBitSet::makeUnion(const SparseBitSet& other)
+{
+    if (other.chunks.empty()) return;
+    std::vector<Chunk> result;
+    result.reserve(chunks.size() + other.chunks.size());
+    unsigned i = 0, j = 0;
+    while (i < chunks.size() || j < other.chunks.size())
+        {
+            if (j == other.chunks.size() || (i < chunks.size() && chunks[i].base < other.chunks[j].base))
+                result.push_back(chunks[i++]);
+            else if (i == chunks.size() || other.chunks[j].base < chunks[i].base)
+                result.push_back(other.chunks[j++]);
+            else
+                {
+                    Chunk c = chunks[i++];
+                    const Chunk& o = other.chunks[j++];
+                    for (unsigned k = 0; k < CHUNK_WORDS; k++)
+                        c.bits[k] |= o.bits[k];
+                    result.push_back(c);
+                }
+        }
+    chunks.swap(result);
+}
+
+// Make this set the difference of itself and other
+void SparseBitSet::makeDiff(const SparseBitSet& other)
+{
+    unsigned i, j = 0, n = 0;
+    for (i = 0; i < chunks.size(); i++)
+        {
+            Chunk& c = chunks[i];
+            while (j < other.chunks.size() && other.chunks[j].base < c.base)
+                j++;
+            if (j < other.chunks.size() && other.chunks[j].base == c.base)
+                {
+                    const Chunk& o = other.chunks[j];
+                    word any = 0;
+                    for (unsigned k = 0; k < CHUNK_WORDS; k++)
+                        {
+                            c.bits[k] &= ~o.bits[k];
+                            any |= c.bits[k];
+                        }
+                    if (any == 0) continue;				// Chunk is now empty; drop it
+                }
+            chunks[n++] = c;
+        }
+    chunks.resize(n);
+}
+
+// Make this set the intersection of itself and other
+void SparseBitSet::makeIsect(const SparseBitSet& other)
+{
+    unsigned i, j = 0, n = 0;
+    for (i = 0; i < chunks.size(); i++)
+        {
+            Chunk& c = chunks[i];
+            while (j < other.chunks.size() && other.chunks[j].base < c.base)
+                j++;
+            if (j == other.chunks.size())
+                break;
+            if (other.chunks[j].base != c.base)
+                continue;
+            const Chunk& o = other.chunks[j];
+            word any = 0;
+            for (unsigned k = 0; k < CHUNK_WORDS; k++)
+                {
+                    c.bits[k] &= o.bits[k];
+                    any |= c.bits[k];
+                }
+            if (any)
+                chunks[n++] = c;
+        }
+    chunks.resize(n);
+}
+
+// Check for the subset relation, i.e. are all my elements also in the set other
+bool SparseBitSet::isSubSetOf(const SparseBitSet& other) const
+{
+    if (chunks.size() > other.chunks.size()) return false;
+    unsigned j = 0;
+    for (unsigned i = 0; i < chunks.size(); i++)
+        {
+            const Chunk& c = chunks[i];
+            while (j < other.chunks.size() && other.chunks[j].base < c.base)
+                j++;
+            if (j == other.chunks.size() || other.chunks[j].base != c.base)
+                return false;
+            const Chunk& o = other.chunks[j];
+            word extra = 0;
+            for (unsigned k = 0; k < CHUNK_WORDS; k++)
+                extra |= c.bits[k] & ~o.bits[k];
+            if (extra)
+                return false;
+        }
+    return true;
+}
+
+bool SparseBitSet::insert(unsigned n)
+{
+    unsigned base = n / CHUNK_BITS;
+    unsigned i = findChunk(base);
+    if (i == chunks.size() || chunks[i].base != base)
+        {
+            Chunk c;
+            c.base = base;
+            for (unsigned k = 0; k < CHUNK_WORDS; k++)
+                c.bits[k] = 0;
+            chunks.insert(chunks.begin() + i, c);
+        }
+    word& w = chunks[i].bits[(n % CHUNK_BITS) / WORD_BITS];
+    word mask = (word)1 << (n % WORD_BITS);
+    if (w & mask)
+        return false;
+    w |= mask;
+    return true;
+}
+
+bool SparseBitSet::remove(unsigned n)
+{
+    unsigned base = n / CHUNK_BITS;
+    unsigned i = findChunk(base);
+    if (i == chunks.size() || chunks[i].base != base)
+        return false;
+    Chunk& c = chunks[i];
+    word& w = c.bits[(n % CHUNK_BITS) / WORD_BITS];
+    word mask = (word)1 << (n % WORD_BITS);
+    if ((w & mask) == 0)
+        return false;
+    w &= ~mask;
+    word any = 0;
+    for (unsigned k = 0; k < CHUNK_WORDS; k++)
+        any |= c.bits[k];
+    if (any == 0)
+        chunks.erase(chunks.begin() + i);
+    return true;
+}
+
+bool SparseBitSet::exists(unsigned n) const
+{
+    unsigned base = n / CHUNK_BITS;
+    unsigned i = findChunk(base);
+    if (i == chunks.size() || chunks[i].base != base)
+        return false;
+    return (chunks[i].bits[(n % CHUNK_BITS) / WORD_BITS] >> (n % WORD_BITS)) & 1;
+}
+
+unsigned SparseBitSet::size() const
+{
+    unsigned n = 0;
+    for (unsigned i = 0; i < chunks.size(); i++)
+        for (unsigned k = 0; k < CHUNK_WORDS; k++)
+            n += countBits(chunks[i].bits[k]);
+    return n;
+}
+
+bool SparseBitSet::operator==(const SparseBitSet& o) const
+{
+    if (chunks.size() != o.chunks.size()) return false;
+    for (unsigned i = 0; i < chunks.size(); i++)
+        {
+            if (chunks[i].base != o.chunks[i].base) return false;
+            for (unsigned k = 0; k < CHUNK_WORDS; k++)
+                if (chunks[i].bits[k] != o.chunks[i].bits[k]) return false;
+        }
+    return true;
+}
+
+bool SparseBitSet::operator<(const SparseBitSet& o) const
+{
+    if (chunks.size() < o.chunks.size()) return true;
+    if (chunks.size() > o.chunks.size()) return false;
+    for (unsigned i = 0; i < chunks.size(); i++)
+        {
+            if (chunks[i].base < o.chunks[i].base) return true;
+            if (chunks[i].base > o.chunks[i].base) return false;
+            for (unsigned k = 0; k < CHUNK_WORDS; k++)
+                {
+                    if (chunks[i].bits[k] < o.chunks[i].bits[k]) return true;
+                    if (chunks[i].bits[k] > o.chunks[i].bits[k]) return false;
+                }
+        }
+    return false;
+}
+
 //
 // StatementSet methods
 //
 
+#if USE_BITSET_STATEMENTSET
+
+std::deque<Statement*> StatementSet::statements(1, (Statement*)NULL);
+std::vector<unsigned> StatementSet::freeIndexes;
+static Mutex indexMutex;					// For the sets used by the code generation threads
+
+// Statements are numbered in the order that they are first inserted into any set, reusing the numbers of deleted
+// statements. Since most sets are built while working on one proc, the statements of a proc end up with nearby indexes,
+// and the sets stay dense. The index is kept in the statement, so finding it is just a load
+unsigned StatementSet::indexOf(Statement* s)
+{
+    if (s == NULL)
+        return 0;
+    if (s->setIndex != NO_INDEX)
+        return s->setIndex;
+    Lock lock(indexMutex);
+    unsigned n;
+    if (freeIndexes.empty())
+        {
+            n = statements.size();
+            statements.push_back(s);
+        }
+    else
+        {
+            n = freeIndexes.back();
+            freeIndexes.pop_back();
+            statements[n] = s;
+        }
+    s->setIndex = n;
+    return n;
+}
+
+bool StatementSet::findIndex(Statement* s, unsigned& n)
+{
+    n = s ? s->setIndex : 0;
+    return n != NO_INDEX;
+}
+
+Statement* StatementSet::statementAt(unsigned n)
+{
+    Lock lock(indexMutex);
+    return statements[n];
+}
+
+void StatementSet::releaseIndex(unsigned n)
+{
+    if (n == NO_INDEX)
+        return;
+    Lock lock(indexMutex);
+    statements[n] = NULL;
+    freeIndexes.push_back(n);
+}
+
+void StatementSet::makeUnion(StatementSet& other)
+{
+    sset.makeUnion(other.sset);
+}
+
+void StatementSet::makeDiff(StatementSet& other)
+{
+    sset.makeDiff(other.sset);
+}
+
+void StatementSet::makeIsect(StatementSet& other)
+{
+    sset.makeIsect(other.sset);
+}
+
+bool StatementSet::isSubSetOf(StatementSet& other)
+{
+    return sset.isSubSetOf(other.sset);
+}
+
+bool StatementSet::remove(Statement* s)
+{
+    unsigned n;
+    if (!findIndex(s, n))
+        return false;
+    return sset.remove(n);
+}
+
+bool StatementSet::exists(Statement* s)
+{
+    unsigned n;
+    if (!findIndex(s, n))
+        return false;
+    return sset.exists(n);
+}
+
+bool StatementSet::operator<(const StatementSet& o) const
+{
+    return sset < o.sset;
+}
+
+#else
+
 // Make this set the union of itself and other
 void StatementSet::makeUnion(StatementSet& other)
 {
@@ -81,12 +417,14 @@ void StatementSet::makeDiff(StatementSet& other)
 void StatementSet::makeIsect(StatementSet& other)
 {
     std::set<Statement*>::iterator it, ff;
-    for (it = sset.begin(); it != sset.end(); it++)
+    for (it = sset.begin(); it != sset.end(); )
         {
             ff = other.sset.find(*it);
             if (ff == other.sset.end())
                 // Not in both sets
-                sset.erase(it);
+                sset.erase(it++);
+            else
+                it++;
         }
 }
 
@@ -123,10 +461,26 @@ bool StatementSet::exists(Statement* s)
     return (it != sset.end());
 }
 
+bool StatementSet::operator<(const StatementSet& o) const
+{
+    if (sset.size() < o.sset.size()) return true;
+    if (sset.size() > o.sset.size()) return false;
+    std::set<Statement*>::const_iterator it1, it2;
+    for (it1 = sset.begin(), it2 = o.sset.begin(); it1 != sset.end();
+            it1++, it2++)
+        {
+            if (*it1 < *it2) return true;
+            if (*it1 > *it2) return false;
+        }
+    return false;
+}
+
+#endif
+
 // Find a definition for loc in this Statement set. Return true if found
 bool StatementSet::definesLoc(Exp* loc)
 {
-    for (iterator it = sset.begin(); it != sset.end(); it++)
+    for (iterator it = begin(); it != end(); it++)
         {
             if ((*it)->definesLoc(loc))
                 return true;
@@ -138,13 +492,7 @@ bool StatementSet::definesLoc(Exp* loc)
 char* StatementSet::prints()
 {
     std::ostringstream ost;
-    std::set<Statement*>::iterator it;
-    for (it = sset.begin(); it != sset.end(); it++)
-        {
-            if (it != sset.begin()) ost << ",\t";
-            ost << *it;
-        }
-    ost << "\n";
+    print(ost);
     strncpy(debug_buffer, ost.str().c_str(), DEBUG_BUFSIZE-1);
     debug_buffer[DEBUG_BUFSIZE-1] = '\0';
     return debug_buffer;
@@ -157,10 +505,10 @@ void StatementSet::dump()
 
 void StatementSet::print(std::ostream& os)
 {
-    std::set<Statement*>::iterator it;
-    for (it = sset.begin(); it != sset.end(); it++)
+    iterator it;
+    for (it = begin(); it != end(); it++)
         {
-            if (it != sset.begin()) os << ",\t";
+            if (it != begin()) os << ",\t";
             os << *it;
         }
     os << "\n";
@@ -170,31 +518,17 @@ void StatementSet::print(std::ostream& os)
 void StatementSet::printNums(std::ostream& os)
 {
     os << std::dec;
-    for (iterator it = sset.begin(); it != sset.end(); )
+    for (iterator it = begin(); it != end(); )
         {
             if (*it)
                 (*it)->printNum(os);
             else
                 os << "-";				// Special case for NULL definition
-            if (++it != sset.end())
+            if (++it != end())
                 os << " ";
         }
 }
 
-bool StatementSet::operator<(const StatementSet& o) const
-{
-    if (sset.size() < o.sset.size()) return true;
-    if (sset.size() > o.sset.size()) return false;
-    std::set<Statement*>::const_iterator it1, it2;
-    for (it1 = sset.begin(), it2 = o.sset.begin(); it1 != sset.end();
-            it1++, it2++)
-        {
-            if (*it1 < *it2) return true;
-            if (*it1 > *it2) return false;
-        }
-    return false;
-}
-
 //
 // AssignSet methods
 //
@@ -629,6 +963,11 @@ void StatementList::append(StatementSet& ss)
         }
 }
 
+void StatementList::append(StatementVec& sv)
+{
+    slist.insert(slist.end(), sv.begin(), sv.end());
+}
+
 char* StatementList::prints()
 {
     std::ostringstream ost;
@@ -1068,6 +1407,50 @@ bool RangeMap::isSubset(RangeMap &other)
 }
 
 
+//	class RangeData
+
+RangeData::RangeData() : workList(lessWorkOrder), bbVisits(0)
+{}
+
+// Depth first order, then pointer order for BBs with the same DFT number (e.g. not numbered yet), so that neither of
+// them is lost from the worklist
+bool RangeData::lessWorkOrder(BasicBlock* bb1, BasicBlock* bb2)
+{
+    if (BasicBlock::lessFirstDFT(bb1, bb2)) return true;
+    if (BasicBlock::lessFirstDFT(bb2, bb1)) return false;
+    return bb1 < bb2;
+}
+
+BasicBlock* RangeData::nextFromWorkList()
+{
+    if (workList.empty())
+        return NULL;
+    BasicBlock* bb = *workList.begin();
+    workList.erase(workList.begin());
+    bbVisits++;
+    return bb;
+}
+
+void RangeData::print(std::ostream &os, StatementVec &stmts)
+{
+    for (StatementVec::iterator it = stmts.begin(); it != stmts.end(); it++)
+        {
+            std::map<Statement*, RangeMap>::iterator rr = ranges.find(*it);
+            if (rr == ranges.end() || rr->second.empty())
+                continue;
+            os << std::setw(4) << std::dec << (*it)->getNumber() << " ranges: ";
+            rr->second.print(os);
+            rr = branchRanges.find(*it);
+            if (rr != branchRanges.end() && !rr->second.empty())
+                {
+                    os << "\n     not taken: ";
+                    rr->second.print(os);
+                }
+            os << "\n";
+        }
+}
+
+
 //	class ConnectionGraph
 
 void ConnectionGraph::add(Exp* a, Exp* b)
@@ -54,6 +54,7 @@
 #include <iomanip>			// For std::setw etc
 #include <sstream>
 #include <cstring>
+#include <ctime>
 
 #ifdef _WIN32
 #undef NO_ADDRESS
@@ -339,9 +340,9 @@ void UserProc::printUseGraph()
 {
     std::ofstream out((Boomerang::get()->getOutputPath() + getName() + "-usegraph.dot").c_str());
     out << "digraph " << getName() << " {\n";
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
-    StatementList::iterator it;
+    StatementVec::iterator it;
     for (it = stmts.begin(); it != stmts.end(); it++)
         {
             Statement* s = *it;
@@ -443,7 +444,7 @@ bool LibProc::isPreserved(Exp* e)
 UserProc::UserProc() : Proc(), cfg(NULL), status(PROC_UNDECODED),
     // decoded(false), analysed(false),
     nextLocal(0), nextParam(0),	// decompileSeen(false), decompiled(false), isRecursive(false)
-    cycleGrp(NULL), theReturnStatement(NULL)
+    stmtCacheValid(false), cycleGrp(NULL), theReturnStatement(NULL)
 {
     localTable.setProc(this);
 }
@@ -453,7 +454,7 @@ UserProc::UserProc(Prog *prog, std::string& name, ADDRESS uNative) :
     Proc(prog, uNative, new Signature(name.c_str())),
     cfg(new Cfg()), status(PROC_UNDECODED),
     nextLocal(0),  nextParam(0),// decompileSeen(false), decompiled(false), isRecursive(false),
-    cycleGrp(NULL), theReturnStatement(NULL), DFGcount(0)
+    stmtCacheValid(false), cycleGrp(NULL), theReturnStatement(NULL), DFGcount(0)
 {
     cfg->setProc(this);				 // Initialise cfg.myProc
     localTable.setProc(this);
@@ -476,6 +477,7 @@ void UserProc::deleteCFG()
 {
     delete cfg;
     cfg = NULL;
+    invalidateStatements();
 }
 
 class lessEvaluate : public std::binary_function<SyntaxNode*, SyntaxNode*, bool>
@@ -584,6 +586,7 @@ void UserProc::printAST(SyntaxNode *a)
 void UserProc::setDecoded()
 {
     setStatus(PROC_DECODED);
+    invalidateStatements();
     printDecodedXML();
 }
 
@@ -664,11 +667,12 @@ void UserProc::generateCode(HLLCode *hll)
     // Local variables; print everything in the locals map
     std::map<std::string, Type*>::iterator last = locals.end();
     if (locals.size()) last--;
+    IntegerType intType;				// AddLocal only prints the type
     for (std::map<std::string, Type*>::iterator it = locals.begin(); it != locals.end(); it++)
         {
             Type* locType = it->second;
             if (locType == NULL || locType->isVoid())
-                locType = new IntegerType();
+                locType = &intType;
             hll->AddLocal(it->first.c_str(), locType, it == last);
         }
 
@@ -777,9 +781,9 @@ void UserProc::printDFG()
         LOG << "outputing DFG to " << fname << "\n";
     std::ofstream out(fname);
     out << "digraph " << getName() << " {\n";
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
-    StatementList::iterator it;
+    StatementVec::iterator it;
     for (it = stmts.begin(); it != stmts.end(); it++)
         {
             Statement *s = *it;
@@ -859,17 +863,34 @@ void UserProc::numberStatements()
 }
 
 
-// get all statements
-// Get to a statement list, so they come out in a reasonable and consistent order
-void UserProc::getStatements(StatementList &stmts)
+void UserProc::updateStatementCache()
 {
+    stmtCache.clear();
     BB_IT it;
     for (PBB bb = cfg->getFirstBB(it); bb; bb = cfg->getNextBB(it))
-        bb->getStatements(stmts);
+        bb->getStatements(stmtCache);
 
-    for (StatementList::iterator it = stmts.begin(); it != stmts.end(); it++)
+    for (StatementVec::iterator it = stmtCache.begin(); it != stmtCache.end(); it++)
         if ((*it)->getProc() == NULL)
             (*it)->setProc(this);
+    stmtCacheValid = true;
+}
+
+// get all statements
+// Get to a statement list, so they come out in a reasonable and consistent order
+void UserProc::getStatements(StatementList &stmts)
+{
+    if (!stmtCacheValid)
+        updateStatementCache();
+    stmts.append(stmtCache);
+}
+
+// As above, but to a vector; preferred for passes that only iterate over the statements
+void UserProc::getStatements(StatementVec &stmts)
+{
+    if (!stmtCacheValid)
+        updateStatementCache();
+    stmts.append(stmtCache);
 }
 
 // Remove a statement. This is somewhat inefficient - we have to search the whole BB for the statement.
@@ -906,6 +927,7 @@ void UserProc::removeStatement(Statement *stmt)
         }
 
     // remove from BB/RTL
+    invalidateStatements();
     PBB bb = stmt->getBB();			// Get our enclosing BB
     std::list<RTL*> *rtls = bb->getRTLs();
     for (std::list<RTL*>::iterator rit = rtls->begin(); rit != rtls->end(); rit++)
@@ -948,6 +970,7 @@ void UserProc::insertAssignAfter(Statement* s, Exp* left, Exp* right)
     Assign* as = new Assign(left, right);
     as->setProc(this);
     stmts->insert(it, as);
+    invalidateStatements();
     return;
 }
 
@@ -972,6 +995,7 @@ void UserProc::insertStatementAfter(Statement* s, Statement* a)
                                 {
                                     ss++;		// This is the point to insert before
                                     stmts.insert(ss, a);
+                                    invalidateStatements();
                                     return;
                                 }
                         }
@@ -1592,6 +1616,8 @@ ProcSet* UserProc::middleDecompile(ProcList* path, int indent)
             // It is important to keep the result of this call for the recursion analysis
             return ret;
         }
+    // The indirect jumps and calls are analysed as far as they will be, so this proc is not decoded again
+    prog->doneDecoding(this);
 
     findPreserveds();
 
@@ -1926,9 +1952,9 @@ void UserProc::branchAnalysis()
 {
     Boomerang::get()->alert_decompile_debug_point(this, "before branch analysis.");
 
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
-    for (StatementList::iterator it = stmts.begin(); it != stmts.end(); it++)
+    for (StatementVec::iterator it = stmts.begin(); it != stmts.end(); it++)
         {
             Statement *stmt = *it;
             if (stmt->isBranch())
@@ -1998,9 +2024,9 @@ void UserProc::fixUglyBranches()
     if (VERBOSE)
         LOG << "### fixUglyBranches for " << getName() << " ###\n";
 
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
-    for (StatementList::iterator it = stmts.begin(); it != stmts.end(); it++)
+    for (StatementVec::iterator it = stmts.begin(); it != stmts.end(); it++)
         {
             Statement *stmt = *it;
             if (stmt->isBranch())
@@ -2157,9 +2183,9 @@ void UserProc::removeSpAssignsIfPossible()
     Exp *sp = Location::regOf(signature->getStackRegister(prog));
     bool foundone = false;
 
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
-    for (StatementList::iterator it = stmts.begin(); it != stmts.end(); it++)
+    for (StatementVec::iterator it = stmts.begin(); it != stmts.end(); it++)
         {
             Statement *stmt = *it;
             if (stmt->isAssign() && *((Assign*)stmt)->getLeft() == *sp)
@@ -2181,7 +2207,7 @@ void UserProc::removeSpAssignsIfPossible()
 
     Boomerang::get()->alert_decompile_debug_point(this, "before removing stack pointer assigns.");
 
-    for (StatementList::iterator it = stmts.begin(); it != stmts.end(); it++)
+    for (StatementVec::iterator it = stmts.begin(); it != stmts.end(); it++)
         if ((*it)->isAssign())
             {
                 Assign *a = (Assign*)*it;
@@ -2202,9 +2228,9 @@ void UserProc::removeMatchingAssignsIfPossible(Exp *e)
 
     bool foundone = false;
 
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
-    for (StatementList::iterator it = stmts.begin(); it != stmts.end(); it++)
+    for (StatementVec::iterator it = stmts.begin(); it != stmts.end(); it++)
         {
             Statement *stmt = *it;
             if (stmt->isAssign() && *((Assign*)stmt)->getLeft() == *e)
@@ -2236,7 +2262,7 @@ void UserProc::removeMatchingAssignsIfPossible(Exp *e)
     if (VERBOSE)
         LOG << str.str().c_str() << "\n";
 
-    for (StatementList::iterator it = stmts.begin(); it != stmts.end(); it++)
+    for (StatementVec::iterator it = stmts.begin(); it != stmts.end(); it++)
         if ((*it)->isAssign())
             {
                 Assign *a = (Assign*)*it;
@@ -2382,10 +2408,10 @@ void UserProc::findFinalParameters()
 
 //	int sp = signature->getStackRegister();
     signature->setNumParams(0);			// Clear any old ideas
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
 
-    StatementList::iterator it;
+    StatementVec::iterator it;
     for (it = stmts.begin(); it != stmts.end(); ++it)
         {
             Statement* s = *it;
@@ -2488,7 +2514,7 @@ void UserProc::trimParameters(int depth)
     if (VERBOSE)
         LOG << "trimming parameters for " << getName() << "\n";
 
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
 
     // find parameters that are referenced (ignore calls to this)
@@ -2506,7 +2532,7 @@ void UserProc::trimParameters(int depth)
         }
 
     std::set<Statement*> excluded;
-    StatementList::iterator it;
+    StatementVec::iterator it;
 
     for (it = stmts.begin(); it != stmts.end(); it++)
         {
@@ -2607,7 +2633,7 @@ void UserProc::addParameter(Exp *e, Type* ty)
 
 void UserProc::processFloatConstants()
 {
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
 
     Exp *match = new Ternary(opFsize,
@@ -2615,7 +2641,7 @@ void UserProc::processFloatConstants()
                              new Terminal(opWild),
                              Location::memOf(new Terminal(opWild)));
 
-    StatementList::iterator it;
+    StatementVec::iterator it;
     for (it = stmts.begin(); it != stmts.end(); it++)
         {
             Statement *s = *it;
@@ -2676,9 +2702,10 @@ Exp *UserProc::getSymbolExp(Exp *le, Type *ty, bool lastPass)
                     if ((*it).second->isLocal())
                         {
                             const char *nam = ((Const*)(*it).second->getSubExp1())->getStr();
-                            if (locals.find(nam) != locals.end())
+                            std::map<std::string, Type*>::iterator ll = locals.find(nam);
+                            if (ll != locals.end())
                                 {
-                                    Type *lty = locals[nam];
+                                    Type *lty = ll->second;
                                     Exp *loc = (*it).first;
                                     if (	loc->isMemOf() &&
                                             loc->getSubExp1()->getOper() == opMinus &&
@@ -2765,7 +2792,7 @@ Exp *UserProc::getSymbolExp(Exp *le, Type *ty, bool lastPass)
 // Not used with DFA Type Analysis; the equivalent thing happens in mapLocalsAndParams() now
 void UserProc::mapExpressionsToLocals(bool lastPass)
 {
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
 
     Boomerang::get()->alert_decompile_debug_point(this, "before mapping expressions to locals");
@@ -2787,7 +2814,7 @@ void UserProc::mapExpressionsToLocals(bool lastPass)
         }
 
     // start with calls because that's where we have the most types
-    StatementList::iterator it;
+    StatementVec::iterator it;
     for (it = stmts.begin(); it != stmts.end(); it++)
         {
             if ((*it)->isCall())
@@ -2907,7 +2934,7 @@ void UserProc::mapExpressionsToLocals(bool lastPass)
     Boomerang::get()->alert_decompile_debug_point(this, "after mapping expressions to locals");
 }
 
-void UserProc::searchRegularLocals(OPER minusOrPlus, bool lastPass, int sp, StatementList& stmts)
+void UserProc::searchRegularLocals(OPER minusOrPlus, bool lastPass, int sp, StatementVec& stmts)
 {
     // replace expressions in regular statements with locals
     Location* l;
@@ -2921,7 +2948,7 @@ void UserProc::searchRegularLocals(OPER minusOrPlus, bool lastPass, int sp, Stat
                 new Binary(minusOrPlus,
                            new RefExp(Location::regOf(sp), NULL),
                            new Terminal(opWildIntConst)));
-    StatementList::iterator it;
+    StatementVec::iterator it;
     for (it = stmts.begin(); it != stmts.end(); it++)
         {
             Statement* s = *it;
@@ -2947,10 +2974,10 @@ void UserProc::searchRegularLocals(OPER minusOrPlus, bool lastPass, int sp, Stat
 bool UserProc::removeNullStatements()
 {
     bool change = false;
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
     // remove null code
-    StatementList::iterator it;
+    StatementVec::iterator it;
     for (it = stmts.begin(); it != stmts.end(); it++)
         {
             Statement* s = *it;
@@ -2975,10 +3002,10 @@ bool UserProc::propagateStatements(bool& convert, int pass)
 {
     if (VERBOSE)
         LOG << "--- begin propagating statements pass " << pass << " ---\n";
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
     // propagate any statements that can be
-    StatementList::iterator it;
+    StatementVec::iterator it;
     // Find the locations that are used by a live, dominating phi-function
     LocationSet usedByDomPhi;
     findLiveAtDomPhi(usedByDomPhi);
@@ -3004,13 +3031,16 @@ bool UserProc::propagateStatements(bool& convert, int pass)
             if (s->isPhi()) continue;
             change |= s->propagateFlagsTo();
         }
-    // Finally the actual propagation
+    // Finally the actual propagation. Facts about the definitions propagated from are kept for the whole pass; a
+    // statement's facts are forgotten once it has been propagated into (and simplified)
     convert = false;
+    PropagationCache cache;
     for (it = stmts.begin(); it != stmts.end(); it++)
         {
             Statement* s = *it;
             if (s->isPhi()) continue;
-            change |= s->propagateTo(convert, &destCounts, &usedByDomPhi);
+            change |= s->propagateTo(convert, &destCounts, &usedByDomPhi, false, &cache);
+            cache.erase(s);
         }
     simplify();
     propagateToCollector();
@@ -3021,12 +3051,12 @@ bool UserProc::propagateStatements(bool& convert, int pass)
 
 Statement *UserProc::getStmtAtLex(unsigned int begin, unsigned int end)
 {
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
 
     unsigned int lowest = begin;
     Statement *loweststmt = NULL;
-    for (StatementList::iterator it = stmts.begin(); it != stmts.end(); it++)
+    for (StatementVec::iterator it = stmts.begin(); it != stmts.end(); it++)
         if (begin >= (*it)->getLexBegin() && begin <= lowest && begin <= (*it)->getLexEnd() &&
                 (end == (unsigned)-1 || end < (*it)->getLexEnd()))
             {
@@ -3091,10 +3121,10 @@ void UserProc::addLocal(Type *ty, const char *nam, Exp *e)
 
 Type *UserProc::getLocalType(const char *nam)
 {
-    if (locals.find(nam) == locals.end())
+    std::map<std::string, Type*>::iterator ff = locals.find(nam);
+    if (ff == locals.end())
         return NULL;
-    Type *ty = locals[nam];
-    return ty;
+    return ff->second;
 }
 
 void UserProc::setLocalType(const char *nam, Type *ty)
@@ -3107,11 +3137,22 @@ void UserProc::setLocalType(const char *nam, Type *ty)
 Type *UserProc::getParamType(const char *nam)
 {
     for (unsigned int i = 0; i < signature->getNumParams(); i++)
-        if (std::string(nam) == signature->getParamName(i))
+        if (strcmp(nam, signature->getParamName(i)) == 0)
             return signature->getParamType(i);
     return NULL;
 }
 
+// Used when looking up symbols for every candidate mapping, so only one string is made for the locals lookup.
+// Symbols have no integer ids: a local or parameter is an opLocal or opParam holding its name, so they are found by
+// name, in the locals map and then by a linear search of the parameters
+Type *UserProc::getSymbolType(const char *nam)
+{
+    std::map<std::string, Type*>::iterator ff = locals.find(nam);
+    if (ff != locals.end() && ff->second)
+        return ff->second;
+    return getParamType(nam);
+}
+
 void UserProc::setExpSymbol(const char *nam, Exp *e, Type* ty)
 {
     TypedExp *te = new TypedExp(ty, Location::local(strdup(nam), this));
@@ -3148,8 +3189,7 @@ Exp* UserProc::getSymbolFor(Exp* from, Type* ty)
             Exp* currTo = ff->second;
             assert(currTo->isLocal() || currTo->isParam());
             const char* name = ((Const*)((Location*)currTo)->getSubExp1())->getStr();
-            Type* currTy = getLocalType(name);
-            if (currTy == NULL) currTy = getParamType(name);
+            Type* currTy = getSymbolType(name);
             if (currTy && currTy->isCompatibleWith(ty))
                 return currTo;
             ++ff;
@@ -3208,9 +3248,9 @@ const char * UserProc::getSymbolName( Exp* e )
 // definition
 void UserProc::countRefs(RefCounter& refCounts)
 {
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
-    StatementList::iterator it;
+    StatementVec::iterator it;
     for (it = stmts.begin(); it != stmts.end(); it++)
         {
             Statement* s = *it;
@@ -3258,10 +3298,10 @@ void UserProc::removeUnusedLocals()
         LOG << "removing unused locals (final) for " << getName() << "\n";
 
     std::set<std::string> usedLocals;
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
     // First count any uses of the locals
-    StatementList::iterator ss;
+    StatementVec::iterator ss;
     bool all = false;
     for (ss = stmts.begin(); ss != stmts.end(); ss++)
         {
@@ -3380,9 +3420,9 @@ void UserProc::fromSSAform()
         // little procs that don't get messages. Also, looks better with progress dots
         std::cout << " transforming out of SSA form " << getName() << " with " << cfg->getNumBBs() << " BBs";
 
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
-    StatementList::iterator it;
+    StatementVec::iterator it;
 
     for (it = stmts.begin(); it != stmts.end(); it++)
         {
@@ -3761,8 +3801,213 @@ static Binary allEqAll(opEquals,
                        new Terminal(opDefineAll),
                        new Terminal(opDefineAll));
 
-// this function was non-reentrant, but now reentrancy is frequently used
+ProofStats UserProc::proofStats;
+ProofCache UserProc::proofCache;
+
+// State of the current proof session, i.e. one top level call to prove() and all the proofs it makes along the way
+static int proofDepth = 0;					// Nesting depth of prove(); 0 when no proof is in progress
+static unsigned proofSteps = 0;				// Prover steps so far in this session
+static clock_t proofStart;					// Processor time at the start of this session
+static bool proofOutOfBudget = false;		// Set when this session has used up its step or time budget
+
+// The nested proofs of a session are often repeated (e.g. the same preservation is needed to bypass every call to a
+// procedure), so their results are kept in UserProc::proofCache for the rest of the session. It is cleared at the end
+// of each session, and whenever a proc's provenTrue changes
+static void clearProofCache()
+{
+    UserProc::proofCache.clear();
+}
+
+// Count a prover step, and return true if the step or time limit (-ps, -pt) of this session has been reached
+static bool proofBudgetExceeded()
+{
+    if (proofOutOfBudget)
+        return true;
+    unsigned stepLimit = Boomerang::get()->proofStepLimit;
+    unsigned timeLimit = Boomerang::get()->proofTimeLimit;
+    if (stepLimit && ++proofSteps > stepLimit)
+        proofOutOfBudget = true;
+    else if (timeLimit && (unsigned)((clock() - proofStart) * 1000.0 / CLOCKS_PER_SEC) > timeLimit)
+        proofOutOfBudget = true;
+    return proofOutOfBudget;
+}
+
+void UserProc::setPremise(Exp* e)
+{
+    e = e->clone();
+    addPremise(e, e);
+}
+
+void UserProc::killPremise(Exp* e)
+{
+    removePremise(e);
+}
+
+void UserProc::addPremise(Exp* lhs, Exp* rhs)
+{
+    std::map<Exp*, Exp*, lessExpStar>::iterator it = recurPremises.find(lhs);
+    if (it != recurPremises.end())
+        it->second = rhs;
+    else
+        recurPremises[lhs] = rhs;
+    proofCache.setPremise(this, lhs, rhs);
+}
+
+void UserProc::removePremise(Exp* lhs)
+{
+    std::map<Exp*, Exp*, lessExpStar>::iterator it = recurPremises.find(lhs);
+    if (it == recurPremises.end())
+        return;
+    recurPremises.erase(it);
+    proofCache.removePremise(this, lhs);
+}
+
+void ProofCache::setPremise(UserProc *proc, Exp *lhs, Exp *rhs)
+{
+    generation++;
+    for (unsigned i = 0; i < premises.size(); i++)
+        if (premises[i].proc == proc && *premises[i].lhs == *lhs)
+            {
+                premises[i].rhs = rhs;
+                return;
+            }
+    Premise p = {proc, lhs, rhs};
+    premises.push_back(p);
+}
+
+void ProofCache::removePremise(UserProc *proc, Exp *lhs)
+{
+    for (unsigned i = 0; i < premises.size(); i++)
+        if (premises[i].proc == proc && *premises[i].lhs == *lhs)
+            {
+                premises.erase(premises.begin() + i);
+                generation++;
+                return;
+            }
+}
+
+void ProofCache::snapshot(Snapshot &snap)
+{
+    snap.generation = generation;
+    snap.premises = premises;
+}
+
+// True if other has the same premises, in the same order, as are assumed now
+bool ProofCache::samePremises(const std::vector<Premise> &other)
+{
+    if (other.size() != premises.size())
+        return false;
+    for (unsigned i = 0; i < other.size(); i++)
+        if (other[i].proc != premises[i].proc || !(*other[i].lhs == *premises[i].lhs) ||
+                !(*other[i].rhs == *premises[i].rhs))
+            return false;
+    return true;
+}
+
+bool ProofCache::find(UserProc *proc, Exp *query, bool conditional, bool &result)
+{
+    unsigned h = query->hash();
+    std::multimap<unsigned, Entry>::iterator it;
+    for (it = entries.lower_bound(h); it != entries.end() && it->first == h; ++it)
+        {
+            Entry &ce = it->second;
+            // If the generation is the same, nothing has been assumed or dropped since the proof was made
+            if (ce.proc == proc && ce.conditional == conditional && *ce.query == *query &&
+                    (ce.generation == generation || samePremises(ce.premises)))
+                {
+                    result = ce.result;
+                    return true;
+                }
+        }
+    return false;
+}
+
+void ProofCache::add(UserProc *proc, Exp *query, bool conditional, Snapshot &snap, bool result)
+{
+    Entry ce;
+    ce.proc = proc;
+    ce.query = query;
+    ce.conditional = conditional;
+    ce.generation = snap.generation;
+    ce.premises = snap.premises;
+    // The snapshot only points at the procs' premises, which are not copies; the entry needs its own
+    for (unsigned i = 0; i < ce.premises.size(); i++)
+        {
+            ce.premises[i].lhs = ce.premises[i].lhs->clone();
+            ce.premises[i].rhs = ce.premises[i].rhs->clone();
+        }
+    ce.result = result;
+    entries.insert(std::pair<unsigned, Entry>(query->hash(), ce));
+}
+
+void ProofCache::clear()
+{
+    entries.clear();
+}
+
+/*==============================================================================
+ * FUNCTION:		UserProc::prove
+ * OVERVIEW:		Try to prove the equation query in this proc. The first call starts a proof session, which ends
+ *					when it returns; the nested proofs made in the session are cached, and the whole session is
+ *					bounded by the -ps and -pt limits. A proof that runs out of budget fails
+ * PARAMETERS:		query: the equation to prove. Note: may be modified
+ *					conditional: true if the result depends on premises, so it must not be saved in provenTrue
+ * RETURNS:			True if proven
+ *============================================================================*/
 bool UserProc::prove(Exp *query, bool conditional /* = false */)
+{
+    bool topLevel = proofDepth == 0;
+    if (topLevel)
+        {
+            proofSteps = 0;
+            proofStart = clock();
+            proofOutOfBudget = false;
+            proofStats.attempted++;
+        }
+    else
+        {
+            bool cached;
+            if (proofCache.find(this, query, conditional, cached))
+                {
+                    if (DEBUG_PROOF)
+                        LOG << "found " << (cached ? "true" : "false") << " in the proof cache " << query << " in "
+                            << getName() << "\n";
+                    proofStats.cacheHits++;
+                    return cached;
+                }
+        }
+
+    Exp *key = topLevel ? NULL : query->clone();		// query gets modified
+    ProofCache::Snapshot premises;
+    if (!topLevel)
+        proofCache.snapshot(premises);
+    proofDepth++;
+    bool result = proveQuery(query, conditional);
+    proofDepth--;
+
+    if (topLevel)
+        {
+            if (result)
+                proofStats.proven++;
+            if (proofOutOfBudget)
+                {
+                    proofStats.outOfBudget++;
+                    if (VERBOSE || DEBUG_PROOF)
+                        LOG << "proof of " << query << " in " << getName() << " gave up after " << proofSteps
+                            << " steps\n";
+                }
+            clearProofCache();
+        }
+    else if (!proofOutOfBudget)
+        {
+            // A proof that ran out of budget might succeed another time, so it is not remembered
+            proofCache.add(this, key, conditional, premises, result);
+        }
+    return result;
+}
+
+// this function was non-reentrant, but now reentrancy is frequently used
+bool UserProc::proveQuery(Exp *query, bool conditional)
 {
 
     assert(query->isEquality());
@@ -3824,6 +4069,7 @@ bool UserProc::prove(Exp *query, bool conditional /* = false */)
                             if (DEBUG_PROOF)
                                 LOG << "Using all=all for " << query->getSubExp1() << "\n" << "prove returns true\n";
                             provenTrue[origLeft->clone()] = right;
+                            clearProofCache();
                             return true;
                         }
                     if (DEBUG_PROOF)
@@ -3834,20 +4080,23 @@ bool UserProc::prove(Exp *query, bool conditional /* = false */)
 
     if (cycleGrp)			// If in involved in a recursion cycle
         //	then save the original query as a premise for bypassing calls
-        recurPremises[origLeft->clone()] = origRight;
+        addPremise(origLeft->clone(), origRight);
 
     std::set<PhiAssign*> lastPhis;
     std::map<PhiAssign*, Exp*> cache;
     bool result = prover(query, lastPhis, cache, original);
     if (cycleGrp)
-        recurPremises.erase(origLeft);			// Remove the premise, regardless of result
+        removePremise(origLeft);				// Remove the premise, regardless of result
     if (DEBUG_PROOF) LOG << "prove returns " << (result ? "true" : "false") << " for " << query << " in " << getName()
                              << "\n";
 
     if (!conditional)
         {
             if (result)
-                provenTrue[origLeft] = origRight;	// Save the now proven equation
+                {
+                    provenTrue[origLeft] = origRight;	// Save the now proven equation
+                    clearProofCache();
+                }
 #if PROVEN_FALSE
             else
                 provenFalse[origLeft] = origRight;	// Save the now proven-to-be-false equation
@@ -3861,6 +4110,8 @@ bool UserProc::prover(Exp *query, std::set<PhiAssign*>& lastPhis, std::map<PhiAs
 {
     // A map that seems to be used to detect loops in the call graph:
     std::map<CallStatement*, Exp*> called;
+    if (proofBudgetExceeded())
+        return false;
     Exp *phiInd = query->getSubExp2()->clone();
 
     if (lastPhi && cache.find(lastPhi) != cache.end() && *cache[lastPhi] == *phiInd)
@@ -3882,6 +4133,8 @@ bool UserProc::prover(Exp *query, std::set<PhiAssign*>& lastPhis, std::map<PhiAs
                     LOG << query << "\n";
                 }
 
+            if (proofBudgetExceeded())
+                return false;
             change = false;
             if (query->getOper() == opEquals)
                 {
@@ -4190,9 +4443,9 @@ void UserProc::conTypeAnalysis()
         LOG << "type analysis for procedure " << getName() << "\n";
     Constraints consObj;
     LocationSet cons;
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
-    StatementList::iterator ss;
+    StatementVec::iterator ss;
     // For each statement this proc
     int conscript = 0;
     for (ss = stmts.begin(); ss != stmts.end(); ss++)
@@ -4307,9 +4560,9 @@ void UserProc::conTypeAnalysis()
 bool UserProc::searchAndReplace(Exp *search, Exp *replace)
 {
     bool ch = false;
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
-    StatementList::iterator it;
+    StatementVec::iterator it;
     for (it = stmts.begin(); it != stmts.end(); it++)
         {
             Statement* s = *it;
@@ -4318,9 +4571,9 @@ bool UserProc::searchAndReplace(Exp *search, Exp *replace)
     return ch;
 }
 
-unsigned fudge(StatementList::iterator x)
+unsigned fudge(StatementVec::iterator x)
 {
-    StatementList::iterator y = x;
+    StatementVec::iterator y = x;
     return *(unsigned*)&y;
 }
 
@@ -4351,9 +4604,9 @@ bool UserProc::isPreserved(Exp* e)
 
 void UserProc::castConst(int num, Type* ty)
 {
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
-    StatementList::iterator it;
+    StatementVec::iterator it;
     for (it = stmts.begin(); it != stmts.end(); it++)
         {
             if ((*it)->castConst(num, ty))
@@ -4390,9 +4643,9 @@ void UserProc::addImplicitAssigns()
 {
     Boomerang::get()->alert_decompile_debug_point(this, "before adding implicit assigns");
 
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
-    StatementList::iterator it;
+    StatementVec::iterator it;
     ImplicitConverter ic(cfg);
     StmtImplicitConverter sm(&ic, cfg);
     for (it = stmts.begin(); it != stmts.end(); it++)
@@ -4454,8 +4707,7 @@ const char* UserProc::lookupSym( Exp* e, Type* ty )
             Exp* sym = it->second;
             assert(sym->isLocal() || sym->isParam());
             const char* name = ((Const*)((Location*)sym)->getSubExp1())->getStr();
-            Type* type = getLocalType(name);
-            if (type == NULL) type = getParamType(name);	// Ick currently linear search
+            Type* type = getSymbolType(name);
             if (type && type->isCompatibleWith(ty))
                 return name;
             ++it;
@@ -4595,9 +4847,9 @@ void UserProc::updateCallDefines()
 {
     if (VERBOSE)
         LOG << "### update call defines for " << getName() << " ###\n";
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
-    StatementList::iterator it;
+    StatementVec::iterator it;
     for (it = stmts.begin(); it != stmts.end(); it++)
         {
             CallStatement* call = dynamic_cast<CallStatement*>(*it);
@@ -4610,9 +4862,9 @@ void UserProc::replaceSimpleGlobalConstants()
 {
     if (VERBOSE)
         LOG << "### replace simple global constants for " << getName() << " ###\n";
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
-    StatementList::iterator it;
+    StatementVec::iterator it;
     for (it = stmts.begin(); it != stmts.end(); it++)
         {
             Assign* assgn = dynamic_cast<Assign*>(*it);
@@ -4648,9 +4900,9 @@ void UserProc::reverseStrengthReduction()
 {
     Boomerang::get()->alert_decompile_debug_point(this, "before reversing strength reduction");
 
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
-    StatementList::iterator it;
+    StatementVec::iterator it;
     for (it = stmts.begin(); it != stmts.end(); it++)
         if ((*it)->isAssign())
             {
@@ -4684,9 +4936,9 @@ void UserProc::reverseStrengthReduction()
                                             {
                                                 // ok, fun, now we need to find every reference to p and
                                                 // replace with x{p} * c
-                                                StatementList stmts2;
+                                                StatementVec stmts2;
                                                 getStatements(stmts2);
-                                                StatementList::iterator it2;
+                                                StatementVec::iterator it2;
                                                 for (it2 = stmts2.begin(); it2 != stmts2.end(); it2++)
                                                     if (*it2 != as)
                                                         (*it2)->searchAndReplace(r, new Binary(opMult, r->clone(), new Const(c)));
@@ -4888,9 +5140,9 @@ void UserProc::fixCallAndPhiRefs()
     Boomerang::get()->alert_decompile_debug_point(this, "before fixing call and phi refs");
 
     std::map<Exp*, int, lessExpStar> destCounts;
-    StatementList::iterator it;
+    StatementVec::iterator it;
     Statement* s;
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
 
     // a[m[]] hack, aint nothing better.
@@ -5263,9 +5515,9 @@ bool UserProc::isRetNonFakeUsed(CallStatement* c, Exp* retLoc, UserProc* p, Proc
 {
     // Ick! This algorithm has to search every statement for uses of the return location retLoc defined at call c that
     // are not arguments of calls to p. If we had def-use information, it would be much more efficient
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
-    StatementList::iterator it;
+    StatementVec::iterator it;
     for (it = stmts.begin(); it != stmts.end(); it++)
         {
             Statement* s = *it;
@@ -5318,10 +5570,10 @@ bool UserProc::isRetNonFakeUsed(CallStatement* c, Exp* retLoc, UserProc* p, Proc
 bool UserProc::checkForGainfulUse(Exp* bparam, ProcSet& visited)
 {
     visited.insert(this);					// Prevent infinite recursion
-    StatementList::iterator pp;
-    StatementList stmts;
+    StatementVec::iterator pp;
+    StatementVec stmts;
     getStatements(stmts);
-    StatementList::iterator it;
+    StatementVec::iterator it;
     for (it = stmts.begin(); it != stmts.end(); it++)
         {
             Statement* s = *it;
@@ -5730,15 +5982,6 @@ void UserProc::typeAnalysis()
     printXML();
 }
 
-void UserProc::clearRanges()
-{
-    StatementList stmts;
-    getStatements(stmts);
-    StatementList::iterator it;
-    for (it = stmts.begin(); it != stmts.end(); it++)
-        (*it)->clearRanges();
-}
-
 void UserProc::rangeAnalysis()
 {
     std::cout << "performing range analysis on " << getName() << "\n";
@@ -5749,8 +5992,6 @@ void UserProc::rangeAnalysis()
     cfg->addJunctionStatements();
     cfg->establishDFTOrder();
 
-    clearRanges();
-
     if (VERBOSE)
         {
             LOG << "=== Before performing range analysis for " << getName() << " ===\n";
@@ -5758,78 +5999,57 @@ void UserProc::rangeAnalysis()
             LOG << "=== end before performing range analysis for " << getName() << " ===\n\n";
         }
 
-    std::list<Statement*> execution_paths;
-    std::list<Statement*> junctions;
+    // The results only live as long as this analysis
+    RangeData rd;
 
     assert(cfg->getEntryBB());
     assert(cfg->getEntryBB()->getFirstStmt());
-    execution_paths.push_back(cfg->getEntryBB()->getFirstStmt());
-
-    int watchdog = 0;
+    rd.addToWorkList(cfg->getEntryBB());
 
-    while (execution_paths.size())
+    // Standard worklist algorithm: the BBs are taken in depth first order, and a BB is added back whenever the ranges
+    // at the end of one of its predecessors change. Widening at loop junctions ensures that this terminates; the limit
+    // is just a safety net
+    int maxVisits = 50 * cfg->getNumBBs();
+    PBB bb;
+    while ((bb = rd.nextFromWorkList()) != NULL)
         {
-            while (execution_paths.size())
-                {
-                    Statement *stmt = execution_paths.front();
-                    execution_paths.pop_front();
-                    if (stmt == NULL)
-                        continue;  // ??
-                    if (stmt->isJunction())
-                        junctions.push_back(stmt);
-                    else
-                        stmt->rangeAnalysis(execution_paths);
-                }
-            if (watchdog > 45)
-                LOG << "processing execution paths resulted in " << (int)junctions.size() << " junctions to process\n";
-            while (junctions.size())
+            if (rd.getNumVisits() > maxVisits)
                 {
-                    Statement *junction = junctions.front();
-                    junctions.pop_front();
-                    if (watchdog > 45)
-                        LOG << "processing junction " << junction << "\n";
-                    assert(junction->isJunction());
-                    junction->rangeAnalysis(execution_paths);
-                }
-
-            watchdog++;
-            if (watchdog > 10)
-                {
-                    LOG << "  watchdog " << watchdog << "\n";
-                    if (watchdog > 45)
-                        {
-                            LOG << (int)execution_paths.size() << " execution paths remaining.\n";
-                            LOG << "=== After range analysis watchdog " << watchdog << " for " << getName() << " ===\n";
-                            printToLog();
-                            LOG << "=== end after range analysis watchdog " << watchdog << " for " << getName() << " ===\n\n";
-                        }
-                }
-            if (watchdog > 50)
-                {
-                    LOG << "  watchdog expired\n";
+                    LOG << "range analysis for " << getName() << " did not converge after " << maxVisits <<
+                        " BBs were processed\n";
                     break;
                 }
+            BasicBlock::rtlit rit;
+            StatementList::iterator sit;
+            for (Statement* s = bb->getFirstStmt(rit, sit); s; s = bb->getNextStmt(rit, sit))
+                s->rangeAnalysis(rd);
         }
 
+    StatementVec stmts;
+    getStatements(stmts);
     LOG << "=== After range analysis for " << getName() << " ===\n";
-    printToLog();
+    std::ostringstream ost;
+    rd.print(ost, stmts);
+    LOG << ost.str().c_str();
     LOG << "=== end after range analysis for " << getName() << " ===\n\n";
 
+    logSuspectMemoryDefs(rd);
+
     cfg->removeJunctionStatements();
 }
 
-void UserProc::logSuspectMemoryDefs()
+void UserProc::logSuspectMemoryDefs(RangeData &rd)
 {
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
-    StatementList::iterator it;
+    StatementVec::iterator it;
     for (it = stmts.begin(); it != stmts.end(); it++)
         if ((*it)->isAssign())
             {
                 Assign *a = (Assign*)*it;
                 if (a->getLeft()->isMemOf())
                     {
-                        RangeMap &rm = a->getRanges();
+                        RangeMap &rm = rd.getRanges(a);
                         Exp *p = rm.substInto(a->getLeft()->getSubExp1()->clone());
                         if (rm.hasRange(p))
                             {
@@ -5943,6 +6163,7 @@ void UserProc::setImplicitRef(Statement* s, Exp* a, Type* ty)
                                 {
                                     ImpRefStatement* irs = new ImpRefStatement(ty, a);
                                     rtlForS->insertStmt(irs, itForS);
+                                    invalidateStatements();
                                 }
                             return;
                         }
@@ -5985,9 +6206,9 @@ void UserProc::removeCallLiveness()
 
 void UserProc::mapTempsToLocals()
 {
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
-    StatementList::iterator it;
+    StatementVec::iterator it;
     TempToLocalMapper ttlm(this);
     StmtExpVisitor sv(&ttlm);
     for (it = stmts.begin(); it != stmts.end(); it++)
@@ -6027,9 +6248,9 @@ void UserProc::mapLocalsAndParams()
     Boomerang::get()->alert_decompile_debug_point(this, "before mapping locals from dfa type analysis");
     if (DEBUG_TA)
         LOG << " ### mapping expressions to local variables for " << getName() << " ###\n";
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
-    StatementList::iterator it;
+    StatementVec::iterator it;
     for (it = stmts.begin(); it != stmts.end(); it++)
         {
             Statement* s = *it;
@@ -6097,9 +6318,9 @@ void UserProc::setDominanceNumbers()
 
 void UserProc::findPhiUnites(ConnectionGraph& pu)
 {
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
-    StatementList::iterator it;
+    StatementVec::iterator it;
     for (it = stmts.begin(); it != stmts.end(); it++)
         {
             PhiAssign* pa = (PhiAssign*)*it;
@@ -6131,8 +6352,9 @@ Type* UserProc::getTypeForLocation(Exp* e)
     if (e->isLocal())
         {
             name = ((Const*)((Unary*)e)->getSubExp1())->getStr();
-            if (locals.find(name) != locals.end())
-                return locals[name];
+            std::map<std::string, Type*>::iterator ff = locals.find(name);
+            if (ff != locals.end())
+                return ff->second;
         }
     // Sometimes parameters use opLocal, so fall through
     name = ((Const*)((Unary*)e)->getSubExp1())->getStr();
@@ -6145,9 +6367,9 @@ Type* UserProc::getTypeForLocation(Exp* e)
 // parameter only when it is acually used as a parameter
 void UserProc::nameParameterPhis()
 {
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
-    StatementList::iterator it;
+    StatementVec::iterator it;
     for (it = stmts.begin(); it != stmts.end(); it++)
         {
             PhiAssign* pi = (PhiAssign*)*it;
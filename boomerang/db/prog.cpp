@@ -67,6 +67,9 @@
 #include "ansi-c-parser.h"
 #include "managed.h"
 #include "log.h"
+#include "dataindex.h"
+#include "switchtables.h"
+#include "lock.h"					// Code generation threads, if HAVE_THREADS
 
 #ifdef _WIN32
 #undef NO_ADDRESS
@@ -87,6 +90,8 @@ namespace dbghelp
 Prog::Prog() :
     pBF(NULL),
     pFE(NULL),
+    dataIndex(NULL),
+    switchTables(NULL),
     m_iNumberedProc(1),
     m_rootCluster(new Cluster("prog"))
 {
@@ -107,6 +112,8 @@ void Prog::setFrontEnd(FrontEnd *pFE)
 Prog::Prog(const char* name) :
     pBF(NULL),
     pFE(NULL),
+    dataIndex(NULL),
+    switchTables(NULL),
     m_name(name),
     m_iNumberedProc(1),
     m_rootCluster(new Cluster(getNameNoPathNoExt().c_str()))
@@ -119,6 +126,8 @@ Prog::~Prog()
 {
     if (pBF) delete pBF;
     if (pFE) delete pFE;
+    delete dataIndex;
+    delete switchTables;
     for (std::list<Proc*>::iterator it = m_procs.begin(); it != m_procs.end(); it++)
         {
             if (*it)
@@ -194,6 +203,67 @@ void Prog::generateDotFile()
 
 }
 
+// A proc to generate code for, and the code generated for it
+struct CodeGenJob
+{
+    UserProc*	proc;
+    HLLCode*	code;
+    bool		done;				// The code has been generated
+};
+
+// The procs of a program, in order, for generating code; each is written to its cluster's stream
+struct CodeGenPool
+{
+    std::vector<CodeGenJob>* jobs;
+    unsigned	next;				// Index of the next job not yet taken by a thread
+    unsigned	written;			// Number of jobs written (all of them before next)
+    unsigned	window;				// How far the threads may get ahead of the writing
+    Mutex		mutex;				// For the above and CodeGenJob::done
+    Condition	jobDone;			// Signalled when a job's code has been generated
+    Condition	jobWritten;			// Signalled when a job has been written
+};
+
+static void generateJob(CodeGenJob& job)
+{
+    job.proc->getCFG()->compressCfg();
+    job.proc->generateCode(job.code);
+}
+
+#if HAVE_THREADS
+/*==============================================================================
+ * FUNCTION:		codeGenThread
+ * OVERVIEW:		Generate the code for the jobs of the pool, taking them in order, until there are none left. The
+ *					state that UserProc::generateCode shares between procs is safe to use from several threads: the
+ *					shared types are read-only, the count of Exps is atomic, the progress counters and the buffer of
+ *					BasicBlock::getStmtNumber are per thread, and the compiled patterns, the transformer cache, the
+ *					log and the watchers each have a lock
+ * PARAMETERS:		arg: the CodeGenPool
+ * RETURNS:			NULL
+ *============================================================================*/
+static void* codeGenThread(void* arg)
+{
+    CodeGenPool* pool = (CodeGenPool*)arg;
+    for (;;)
+        {
+            unsigned n;
+            {
+                Lock lock(pool->mutex);
+                // Don't hold the code of too many procs that can't be written yet
+                while (pool->next < pool->jobs->size() && pool->next >= pool->written + pool->window)
+                    pool->jobWritten.wait(pool->mutex);
+                n = pool->next++;
+            }
+            if (n >= pool->jobs->size())
+                break;
+            generateJob((*pool->jobs)[n]);
+            Lock lock(pool->mutex);
+            (*pool->jobs)[n].done = true;
+            pool->jobDone.broadcast();
+        }
+    return NULL;
+}
+#endif
+
 void Prog::generateCode(Cluster *cluster, UserProc *proc, bool intermixRTL)
 {
     std::string basedir = m_rootCluster->makeDirs();
@@ -223,21 +293,27 @@ void Prog::generateCode(Cluster *cluster, UserProc *proc, bool intermixRTL)
                                     PSectionInfo info = pBF->GetSectionInfoByName(str.c_str());
                                     str = "start_";
                                     str	+= sections[j];
-                                    code->AddGlobal(str.c_str(), new IntegerType(32, -1), new Const(info ? info->uNativeAddr : (unsigned int)-1));
+                                    code->AddGlobal(str.c_str(), Type::getShared(IntegerType(32, -1)), new Const(info ? info->uNativeAddr : (unsigned int)-1));
                                     str = sections[j];
                                     str += "_size";
-                                    code->AddGlobal(str.c_str(), new IntegerType(32, -1), new Const(info ? info->uSectionSize : (unsigned int)-1));
-                                    Exp *l = new Terminal(opNil);
-                                    for (unsigned int i = 0; info && i < info->uSectionSize; i++)
+                                    code->AddGlobal(str.c_str(), Type::getShared(IntegerType(32, -1)), new Const(info ? info->uSectionSize : (unsigned int)-1));
+                                    // The bytes go straight to the code; an expression for each byte is far too big for
+                                    // large sections
+                                    if (info && info->uHostAddr)
+                                        code->AddGlobalBytes(sections[j], info->uHostAddr, info->uSectionSize);
+                                    else if (info)
                                         {
-                                            int n = pBF->readNative1(info->uNativeAddr + info->uSectionSize - 1 - i);
-                                            if (n < 0)
-                                                n = 256 + n;
-                                            l = new Binary(opList, new Const(n), l);
+                                            // No host copy of the section; read it through the loader, as before
+                                            std::vector<unsigned char> bytes(info->uSectionSize);
+                                            for (unsigned int i = 0; i < info->uSectionSize; i++)
+                                                bytes[i] = (unsigned char)pBF->readNative1(info->uNativeAddr + i);
+                                            code->AddGlobalBytes(sections[j], bytes.empty() ? NULL : &bytes[0],
+                                                                 info->uSectionSize);
                                         }
-                                    code->AddGlobal(sections[j], new ArrayType(new IntegerType(8, -1), info ? info->uSectionSize : 0), l);
+                                    else
+                                        code->AddGlobalBytes(sections[j], NULL, 0);
                                 }
-                            code->AddGlobal("source_endianness", new IntegerType(), new Const(getFrontEndId() != PLAT_PENTIUM));
+                            code->AddGlobal("source_endianness", Type::getShared(IntegerType()), new Const(getFrontEndId() != PLAT_PENTIUM));
                             os << "#include \"boomerang.h\"\n\n";
                             global = true;
                         }
@@ -252,6 +328,7 @@ void Prog::generateCode(Cluster *cluster, UserProc *proc, bool intermixRTL)
 //				}
                         }
                     if (global) code->print(os);		// Avoid blank line if no globals
+                    delete code;
                 }
         }
 
@@ -267,15 +344,21 @@ void Prog::generateCode(Cluster *cluster, UserProc *proc, bool intermixRTL)
                     continue;
                 }
             proto = true;
+            if (cluster != NULL && cluster != m_rootCluster)
+                continue;							// Prototypes only go to the root cluster's file
             UserProc* up = (UserProc*)*it;
             HLLCode *code = Boomerang::get()->getHLLCode(up);
             code->AddPrototype(up);					// May be the wrong signature if up has ellipsis
-            if (cluster == NULL || cluster == m_rootCluster)
-                code->print(os);
+            code->print(os);
+            delete code;
         }
     if ((proto && cluster == NULL) || cluster == m_rootCluster)
         os << "\n";				// Separate prototype(s) from first proc
 
+    // With several threads, the procs are generated in any order, but each is written to its cluster's stream in the
+    // original proc order as soon as it and the procs before it are done, so the output doesn't depend on the number of
+    // threads. The threads stay no more than a window of procs ahead of the writing, to limit the code held in memory
+    std::vector<CodeGenJob> jobs;
     for (it = m_procs.begin(); it != m_procs.end(); it++)
         {
             Proc *pProc = *it;
@@ -284,9 +367,43 @@ void Prog::generateCode(Cluster *cluster, UserProc *proc, bool intermixRTL)
             if (!up->isDecoded()) continue;
             if (proc != NULL && up != proc)
                 continue;
-            up->getCFG()->compressCfg();
-            HLLCode *code = Boomerang::get()->getHLLCode(up);
-            up->generateCode(code);
+            CodeGenJob job;
+            job.proc = up;
+            job.code = Boomerang::get()->getHLLCode(up);
+            job.done = false;
+            jobs.push_back(job);
+        }
+    int numThreads = Boomerang::get()->codeGenThreads;
+    if (numThreads < 1)
+        numThreads = 1;
+    if ((unsigned)numThreads > jobs.size())
+        numThreads = jobs.size();
+    CodeGenPool pool;
+    pool.jobs = &jobs;
+    pool.next = 0;
+    pool.written = 0;
+    pool.window = numThreads * 16;
+#if HAVE_THREADS
+    std::vector<pthread_t> threads(numThreads > 1 ? numThreads : 0);
+    int started = 0;
+    for (; started < (int)threads.size(); started++)
+        if (pthread_create(&threads[started], NULL, codeGenThread, &pool) != 0)
+            break;
+#else
+    int started = 0;
+#endif
+    for (unsigned i = 0; i < jobs.size(); i++)
+        {
+            if (started == 0)
+                generateJob(jobs[i]);		// No threads; do it here
+            else
+                {
+                    Lock lock(pool.mutex);
+                    while (!jobs[i].done)
+                        pool.jobDone.wait(pool.mutex);
+                }
+            UserProc *up = jobs[i].proc;
+            HLLCode *code = jobs[i].code;
             if (up->getCluster() == m_rootCluster)
                 {
                     if (cluster == NULL || cluster == m_rootCluster)
@@ -300,7 +417,15 @@ void Prog::generateCode(Cluster *cluster, UserProc *proc, bool intermixRTL)
                             code->print(up->getCluster()->getStream());
                         }
                 }
+            delete code;
+            Lock lock(pool.mutex);
+            pool.written = i + 1;
+            pool.jobWritten.broadcast();
         }
+#if HAVE_THREADS
+    for (int i = 0; i < started; i++)
+        pthread_join(threads[i], NULL);
+#endif
     os.close();
     m_rootCluster->closeStreams();
 }
@@ -1091,6 +1216,12 @@ Type *Prog::guessGlobalType(const char *nam, ADDRESS u)
             if (str)
                 // return char* and hope it is dealt with properly
                 return new PointerType(new CharType());
+            unsigned len;
+            if (getDataIndex()->wideStringAt(u, len))
+                return new ArrayType(new IntegerType(16), len + 1);
+            ADDRESS target;
+            if (getDataIndex()->pointerAt(u, target))
+                return new PointerType(new VoidType());
         }
     Type *ty;
     switch (sz)
@@ -1152,7 +1283,8 @@ char *Prog::getStringConstant(ADDRESS uaddr, bool knownString /* = false */)
     if (si && !si->isAddressBss(uaddr))
         {
             // At this stage, only support ascii, null terminated, non unicode strings.
-            // At least 4 of the first 6 chars should be printable ascii
+            // At least 4 of the first 6 chars should be printable ascii. This reads no more than 6 bytes, so it is
+            // cheaper than asking the DataIndex (which is stricter: all text up to the NUL)
             char* p = (char*)(uaddr + si->uHostAddr - si->uNativeAddr);
             if (knownString)
                 // No need to guess... this is hopefully a known string
@@ -1175,6 +1307,28 @@ char *Prog::getStringConstant(ADDRESS uaddr, bool knownString /* = false */)
     return NULL;
 }
 
+DataIndex *Prog::getDataIndex()
+{
+    if (dataIndex == NULL)
+        dataIndex = new DataIndex(pBF);
+    return dataIndex;
+}
+
+SwitchTables *Prog::getSwitchTables()
+{
+    if (switchTables == NULL)
+        switchTables = new SwitchTables(this);
+    return switchTables;
+}
+
+const unsigned char *Prog::getSpan(ADDRESS a, unsigned size)
+{
+    const SectionInfo* si = pBF->GetSectionInfoByAddr(a);
+    if (si == NULL || si->uHostAddr == NULL || si->isAddressBss(a) || a + size > si->uNativeAddr + si->uSectionSize)
+        return NULL;
+    return si->uHostAddr + (a - si->uNativeAddr);
+}
+
 double Prog::getFloatConstant(ADDRESS uaddr, bool &ok, int bits)
 {
     ok = true;
@@ -1652,8 +1806,7 @@ void Prog::rangeAnalysis()
             UserProc* proc = (UserProc*)(*pp);
             if (proc->isLib()) continue;
             if (!proc->isDecoded()) continue;
-            proc->rangeAnalysis();
-            proc->logSuspectMemoryDefs();
+            proc->rangeAnalysis();			// Also logs suspect memory definitions
         }
 }
 
@@ -2019,6 +2172,13 @@ void Prog::reDecode(UserProc* proc)
 {
     std::ofstream os;
     pFE->processProc(proc->getNativeAddress(), proc, os);
+    proc->invalidateStatements();
+}
+
+void Prog::doneDecoding(UserProc* proc)
+{
+    if (pFE)
+        pFE->dropDecodeCache(proc);
 }
 
 
@@ -2269,7 +2429,10 @@ void Memoisable::restoreMemo(bool dec)
 void Prog::decodeFragment(UserProc* proc, ADDRESS a)
 {
     if (a >= pBF->getLimitTextLow() && a < pBF->getLimitTextHigh())
-        pFE->decodeFragment(proc, a);
+        {
+            pFE->decodeFragment(proc, a);
+            proc->invalidateStatements();
+        }
     else
         {
             std::cerr << "attempt to decode fragment outside text area, addr=" << a << "\n";
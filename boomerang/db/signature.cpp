@@ -1333,6 +1333,8 @@ Exp *CallingConvention::StdC::SparcLibSignature::getProven(Exp* left)
 
 
 
+SignatureStats Signature::stats;
+
 Signature::Signature(const char *nam) : rettype(new VoidType()), ellipsis(false), unknown(true), forced(false),
     preferedReturn(NULL)
 {
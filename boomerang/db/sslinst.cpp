@@ -169,6 +169,11 @@ int RTLInstDict::appendToDict(std::string &n, std::list<std::string>& p, RTL& r)
     return 0;
 }
 
+// The SSL files parsed so far, when RTLInstDict::keepParsed is set
+static std::map<std::string, RTLInstDict*> parsedSSL;
+
+bool RTLInstDict::keepParsed = false;
+
 RTLInstDict::RTLInstDict()
 {}
 
@@ -189,6 +194,13 @@ bool RTLInstDict::readSSLFile(const std::string& SSLFileName)
     // Clear all state
     reset();
 
+    std::map<std::string, RTLInstDict*>::iterator kept = parsedSSL.find(SSLFileName);
+    if (keepParsed && kept != parsedSSL.end())
+        {
+            *this = *kept->second;
+            return true;
+        }
+
     // Attempt to Parse the SSL file
     SSLParser theParser(SSLFileName,
 #ifdef DEBUG_SSLPARSER
@@ -206,6 +218,9 @@ bool RTLInstDict::readSSLFile(const std::string& SSLFileName)
 
     fixupParams();
 
+    if (keepParsed)
+        parsedSSL[SSLFileName] = new RTLInstDict(*this);
+
     if (Boomerang::get()->debugDecoder)
         {
             std::cout << "\n=======Expanded RTL template dictionary=======\n";
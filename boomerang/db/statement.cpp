@@ -135,13 +135,10 @@ bool Statement::calcMayAlias(Exp *e1, Exp *e2, int size)
     return true;
 }
 
-RangeMap Statement::getInputRanges()
+RangeMap Statement::getInputRanges(RangeData &rd)
 {
     if (!isFirstStatementInBB())
-        {
-            savedInputRanges = getPreviousStatementInBB()->getRanges();
-            return savedInputRanges;
-        }
+        return rd.getRanges(getPreviousStatementInBB());
 
     assert(pbb && pbb->getNumInEdges() <= 1);
     RangeMap input;
@@ -174,58 +171,54 @@ RangeMap Statement::getInputRanges()
             assert(last);
             if (pred->getNumOutEdges() != 2)
                 {
-                    input = last->getRanges();
+                    input = rd.getRanges(last);
                 }
             else
                 {
                     assert(pred->getNumOutEdges() == 2);
                     assert(last->isBranch());
-                    input = ((BranchStatement*)last)->getRangesForOutEdgeTo(pbb);
+                    input = ((BranchStatement*)last)->getRangesForOutEdgeTo(rd, pbb);
                 }
         }
 
-    savedInputRanges = input;
-
     return input;
 }
 
-void Statement::updateRanges(RangeMap &output, std::list<Statement*> &execution_paths, bool notTaken)
+// Record output as the ranges after this statement (or after the not taken edge of this branch, if notTaken). If they
+// changed and this is the last statement of its BB, the successor along that edge needs to be (re)processed.
+// Subsequent statements of the same BB are processed by UserProc::rangeAnalysis() anyway
+void Statement::updateRanges(RangeData &rd, RangeMap &output, bool notTaken)
 {
-    if (!output.isSubset(notTaken ? ((BranchStatement*)this)->getRanges2Ref() : ranges))
+    if (!output.isSubset(notTaken ? rd.getBranchRanges(this) : rd.getRanges(this)))
         {
             if (notTaken)
-                ((BranchStatement*)this)->setRanges2(output);
+                rd.setBranchRanges(this, output);
             else
-                ranges = output;
-            if (isLastStatementInBB())
+                rd.setRanges(this, output);
+            if (isLastStatementInBB() && pbb->getNumOutEdges())
                 {
-                    if (pbb->getNumOutEdges())
+                    int arc = 0;
+                    if (isBranch())
                         {
-                            int arc = 0;
-                            if (isBranch())
-                                {
-                                    if (pbb->getOutEdge(0)->getLowAddr() != ((BranchStatement*)this)->getFixedDest())
-                                        arc = 1;
-                                    if (notTaken)
-                                        arc ^= 1;
-                                }
-                            execution_paths.push_back(pbb->getOutEdge(arc)->getFirstStmt());
+                            if (pbb->getOutEdge(0)->getLowAddr() != ((BranchStatement*)this)->getFixedDest())
+                                arc = 1;
+                            if (notTaken)
+                                arc ^= 1;
                         }
+                    rd.addToWorkList(pbb->getOutEdge(arc));
                 }
-            else
-                execution_paths.push_back(getNextStatementInBB());
         }
 }
 
-void Statement::rangeAnalysis(std::list<Statement*> &execution_paths)
+void Statement::rangeAnalysis(RangeData &rd)
 {
-    RangeMap output = getInputRanges();
-    updateRanges(output, execution_paths);
+    RangeMap output = getInputRanges(rd);
+    updateRanges(rd, output);
 }
 
-void Assign::rangeAnalysis(std::list<Statement*> &execution_paths)
+void Assign::rangeAnalysis(RangeData &rd)
 {
-    RangeMap output = getInputRanges();
+    RangeMap output = getInputRanges(rd);
     Exp *a_lhs = lhs->clone();
     if (a_lhs->isFlags())
         {
@@ -337,7 +330,7 @@ void Assign::rangeAnalysis(std::list<Statement*> &execution_paths)
         }
     if (VERBOSE && DEBUG_RANGE_ANALYSIS)
         LOG << "added " << a_lhs << " -> " << output.getRange(a_lhs) << "\n";
-    updateRanges(output, execution_paths);
+    updateRanges(rd, output);
     if (VERBOSE && DEBUG_RANGE_ANALYSIS)
         LOG << this << "\n";
 }
@@ -405,9 +398,9 @@ void BranchStatement::limitOutputWithCondition(RangeMap &output, Exp *e)
         }
 }
 
-void BranchStatement::rangeAnalysis(std::list<Statement*> &execution_paths)
+void BranchStatement::rangeAnalysis(RangeData &rd)
 {
-    RangeMap output = getInputRanges();
+    RangeMap output = getInputRanges(rd);
 
     Exp *e = NULL;
     // try to hack up a useful expression for this branch
@@ -432,17 +425,17 @@ void BranchStatement::rangeAnalysis(std::list<Statement*> &execution_paths)
 
     if (e)
         limitOutputWithCondition(output, e);
-    updateRanges(output, execution_paths);
-    output = getInputRanges();
+    updateRanges(rd, output);
+    output = getInputRanges(rd);
     if (e)
         limitOutputWithCondition(output, (new Unary(opNot, e))->simplify());
-    updateRanges(output, execution_paths, true);
+    updateRanges(rd, output, true);
 
     if (VERBOSE && DEBUG_RANGE_ANALYSIS)
         LOG << this << "\n";
 }
 
-void JunctionStatement::rangeAnalysis(std::list<Statement*> &execution_paths)
+void JunctionStatement::rangeAnalysis(RangeData &rd)
 {
     RangeMap input;
     if (VERBOSE && DEBUG_RANGE_ANALYSIS)
@@ -454,7 +447,7 @@ void JunctionStatement::rangeAnalysis(std::list<Statement*> &execution_paths)
                 LOG << "  in BB: " << pbb->getInEdges()[i]->getLowAddr() << " " << last << "\n";
             if (last->isBranch())
                 {
-                    input.unionwith(((BranchStatement*)last)->getRangesForOutEdgeTo(pbb));
+                    input.unionwith(((BranchStatement*)last)->getRangesForOutEdgeTo(rd, pbb));
                 }
             else
                 {
@@ -467,16 +460,16 @@ void JunctionStatement::rangeAnalysis(std::list<Statement*> &execution_paths)
                                         LOG << "ignoring ranges from call to proc with no ret node\n";
                                 }
                             else
-                                input.unionwith(last->getRanges());
+                                input.unionwith(rd.getRanges(last));
                         }
                     else
-                        input.unionwith(last->getRanges());
+                        input.unionwith(rd.getRanges(last));
                 }
         }
     if (VERBOSE && DEBUG_RANGE_ANALYSIS)
         LOG << "}\n";
 
-    if (!input.isSubset(ranges))
+    if (!input.isSubset(rd.getRanges(this)))
         {
             RangeMap output = input;
 
@@ -494,20 +487,20 @@ void JunctionStatement::rangeAnalysis(std::list<Statement*> &execution_paths)
 
             if (isLoopJunction())
                 {
-                    output = ranges;
+                    output = rd.getRanges(this);
                     output.widenwith(input);
                 }
 
-            updateRanges(output, execution_paths);
+            updateRanges(rd, output);
         }
 
     if (VERBOSE && DEBUG_RANGE_ANALYSIS)
         LOG << this << "\n";
 }
 
-void CallStatement::rangeAnalysis(std::list<Statement*> &execution_paths)
+void CallStatement::rangeAnalysis(RangeData &rd)
 {
-    RangeMap output = getInputRanges();
+    RangeMap output = getInputRanges(rd);
 
     if (this->procDest == NULL)
         {
@@ -538,6 +531,7 @@ void CallStatement::rangeAnalysis(std::list<Statement*> &execution_paths)
                                     arguments.append(as);
                                 }
                             signature = procDest->getSignature()->clone();
+                            sigShared = false;
                             m_isComputed = false;
                             proc->undoComputedBB(this);
                             proc->addCallee(procDest);
@@ -643,7 +637,7 @@ void CallStatement::rangeAnalysis(std::list<Statement*> &execution_paths)
                      r.getUpperBound() == Range::MAX ? Range::MAX : r.getUpperBound() + c, r.getBase());
             output.addRange(Location::regOf(28), ra);
         }
-    updateRanges(output, execution_paths);
+    updateRanges(rd, output);
 }
 
 bool JunctionStatement::isLoopJunction()
@@ -654,12 +648,12 @@ bool JunctionStatement::isLoopJunction()
     return false;
 }
 
-RangeMap &BranchStatement::getRangesForOutEdgeTo(PBB out)
+RangeMap &BranchStatement::getRangesForOutEdgeTo(RangeData &rd, PBB out)
 {
     assert(this->getFixedDest() != NO_ADDRESS);
     if (out->getLowAddr() == this->getFixedDest())
-        return ranges;
-    return ranges2;
+        return rd.getRanges(this);
+    return rd.getBranchRanges(this);
 }
 
 bool Statement::isFirstStatementInBB()
@@ -820,12 +814,37 @@ bool Statement::canPropagateToExp(Exp*e)
     return true;
 }
 
+// Find whichever of the facts about the RHS of a definition are not yet known. The complexity and flags facts are only
+// needed when the definition would be propagated to more than one place. These are separate walks, not one
+// FusedExpVisitor walk: the visitors are so cheap that the fused walk's extra dispatch costs more than it saves
+static void findPropagationFacts(Exp* rhs, UserProc* proc, PropagationFacts& facts, bool multiDest)
+{
+    if (facts.badMemof == -1)
+        {
+            BadMemofFinder bmf(proc);
+            rhs->accept(&bmf);
+            facts.badMemof = bmf.isFound();
+        }
+    if (multiDest && facts.complexity == -1)
+        {
+            ComplexityFinder cf(proc);
+            rhs->accept(&cf);
+            facts.complexity = cf.getDepth();
+        }
+    if (multiDest && facts.flags == -1)
+        {
+            FlagsFinder ff;
+            rhs->accept(&ff);
+            facts.flags = ff.isFound();
+        }
+}
+
 // Return true if any change; set convert if an indirect call statement is converted to direct (else unchanged)
 // destCounts is a set of maps from location to number of times it is used this proc
 // usedByDomPhi is a set of subscripted locations used in phi statements
-static int progress = 0;
+static THREAD_LOCAL int progress = 0;
 bool Statement::propagateTo(bool& convert, std::map<Exp*, int, lessExpStar>* destCounts /* = NULL */,
-                            LocationSet* usedByDomPhi /* = NULL */, bool force /* = false */)
+                            LocationSet* usedByDomPhi /* = NULL */, bool force /* = false */, PropagationCache* cache /* = NULL */)
 {
     if (++progress > 1000)
         {
@@ -854,12 +873,25 @@ bool Statement::propagateTo(bool& convert, std::map<Exp*, int, lessExpStar>* des
                         continue;
                     Assign* def = (Assign*)((RefExp*)e)->getDef();
                     Exp* rhs = def->getRight();
+                    // This statement changes as it is propagated into, so never cache facts about itself
+                    PropagationFacts uncached;
+                    PropagationFacts& facts = (cache && def != this) ? (*cache)[def] : uncached;
+                    Exp* lhs = def->getLeft();
+                    // The -l flag (propMaxDepth) only limits propagations of definitions used more than once
+                    std::map<Exp*, int, lessExpStar>::iterator ff;
+                    bool multiDest = false;
+                    if (destCounts && !lhs->isFlags())
+                        {
+                            // Always propagate to %flags
+                            ff = destCounts->find(e);
+                            multiDest = ff != destCounts->end() && ff->second > 1;
+                        }
+                    findPropagationFacts(rhs, proc, facts, multiDest);
                     // If force is true, ignore the fact that a memof should not be propagated (for switch analysis)
-                    if (rhs->containsBadMemof(proc) && !(force && rhs->isMemOf()))
+                    if (facts.badMemof && !(force && rhs->isMemOf()))
                         // Must never propagate unsubscripted memofs, or memofs that don't yet have symbols. You could be
                         // propagating past a definition, thereby invalidating the IR
                         continue;
-                    Exp* lhs = def->getLeft();
 
                     if (EXPERIMENTAL)
                         {
@@ -937,19 +969,9 @@ bool Statement::propagateTo(bool& convert, std::map<Exp*, int, lessExpStar>* des
 #endif
 
                             // Check if the -l flag (propMaxDepth) prevents this propagation
-                            if (destCounts && !lhs->isFlags())
-                                {
-                                    // Always propagate to %flags
-                                    std::map<Exp*, int, lessExpStar>::iterator ff = destCounts->find(e);
-                                    if (ff != destCounts->end() && ff->second > 1 && rhs->getComplexityDepth(proc) >= propMaxDepth)
-                                        {
-                                            if (!def->getRight()->containsFlags())
-                                                {
-                                                    // This propagation is prevented by the -l limit
-                                                    continue;
-                                                }
-                                        }
-                                }
+                            if (multiDest && facts.complexity >= propMaxDepth && !facts.flags)
+                                // This propagation is prevented by the -l limit
+                                continue;
                             change |= doPropagateTo(e, def, convert);
                         }
                 }
@@ -2231,9 +2253,12 @@ bool Statement::propagateTo(bool& convert, std::map<Exp*, int, lessExpStar>* des
         CaseStatement* ret = new CaseStatement();
         ret->pDest = pDest->clone();
         ret->m_isComputed = m_isComputed;
-        ret->pSwitchInfo = new SWITCH_INFO;
-        *ret->pSwitchInfo = *pSwitchInfo;
-        ret->pSwitchInfo->pSwitchVar = pSwitchInfo->pSwitchVar->clone();
+        if (pSwitchInfo)
+            {
+                ret->pSwitchInfo = new SWITCH_INFO;
+                *ret->pSwitchInfo = *pSwitchInfo;
+                ret->pSwitchInfo->pSwitchVar = pSwitchInfo->pSwitchVar->clone();
+            }
         // Statement members
         ret->pbb = pbb;
         ret->proc = proc;
@@ -2282,7 +2307,7 @@ bool Statement::propagateTo(bool& convert, std::map<Exp*, int, lessExpStar>* des
      * PARAMETERS:		 None
      * RETURNS:			 <nothing>
      *============================================================================*/
-    CallStatement::CallStatement(): returnAfterCall(false), calleeReturn(NULL)
+    CallStatement::CallStatement(): returnAfterCall(false), sigShared(false), calleeReturn(NULL)
     {
         kind = STMT_CALL;
         procDest = NULL;
@@ -2394,8 +2419,16 @@ bool Statement::propagateTo(bool& convert, std::map<Exp*, int, lessExpStar>* des
         if (procDest == NULL)
             // FIXME: Need to check this
             return;
-        // Clone here because each call to procDest could have a different signature, modified by ellipsisProcessing
-        signature = procDest->getSignature()->clone();
+        // Each call to procDest could have a different signature, modified by ellipsisProcessing. A library proc's
+        // signature is only copied when that happens (see ownSignature); most calls never change it
+        if (procDest->isLib())
+            {
+                signature = procDest->getSignature();
+                sigShared = true;
+                Signature::stats.shared++;
+            }
+        else
+            signature = procDest->getSignature()->clone();
         procDest->addCaller(this);
 
         if (!procDest->isLib())
@@ -2405,14 +2438,16 @@ bool Statement::propagateTo(bool& convert, std::map<Exp*, int, lessExpStar>* des
         arguments.clear();
         for (i = 0; i < n; i++)
             {
+                // Copy before setting the proc; the signature may be shared
                 Exp *e = signature->getArgumentExp(i);
                 assert(e);
+                e = e->clone();
                 Location *l = dynamic_cast<Location*>(e);
                 if (l)
                     {
                         l->setProc(proc);		// Needed?
                     }
-                Assign* as = new Assign(signature->getParamType(i)->clone(), e->clone(), e->clone());
+                Assign* as = new Assign(signature->getParamType(i)->clone(), e, e->clone());
                 as->setProc(proc);
                 as->setBB(pbb);
                 as->setNumber(number);		// So fromSSAform will work later. But note: this call is probably not numbered yet!
@@ -2851,6 +2886,7 @@ bool Statement::propagateTo(bool& convert, std::map<Exp*, int, lessExpStar>* des
 
         // 3b
         signature = p->getSignature()->clone();
+        sigShared = false;
 
         // 4
         m_isComputed = false;
@@ -3065,6 +3101,7 @@ bool Statement::propagateTo(bool& convert, std::map<Exp*, int, lessExpStar>* des
                                 addSigParam(new PointerType(new VoidType()), false);
                             }
                         setNumArguments(format + n);
+                        ownSignature();
                         signature->killEllipsis();	// So we don't do this again
                         return true;
                     }
@@ -3272,10 +3309,21 @@ bool Statement::propagateTo(bool& convert, std::map<Exp*, int, lessExpStar>* des
             }
 
         setNumArguments(format + n);
+        ownSignature();
         signature->killEllipsis();	// So we don't do this again
         return true;
     }
 
+    // Give this call its own copy of a shared library signature, before changing it
+    void CallStatement::ownSignature()
+    {
+        if (!sigShared)
+            return;
+        signature = signature->clone();
+        sigShared = false;
+        Signature::stats.copied++;
+    }
+
     // Make an assign suitable for use as an argument from a callee context expression
     Assign* CallStatement::makeArgAssign(Type* ty, Exp* e)
     {
@@ -3300,6 +3348,7 @@ bool Statement::propagateTo(bool& convert, std::map<Exp*, int, lessExpStar>* des
     void CallStatement::addSigParam(Type* ty, bool isScanf)
     {
         if (isScanf) ty = new PointerType(ty);
+        ownSignature();
         signature->addParameter(ty);
         Exp* paramExp = signature->getParamExp(signature->getNumParams()-1);
         if (VERBOSE)
@@ -3945,11 +3994,6 @@ bool Statement::propagateTo(bool& convert, std::map<Exp*, int, lessExpStar>* des
         printCompact(os, html);
         if (html)
             os << "</a>";
-        if (!ranges.empty())
-            {
-                os << "\n\t\t\tranges: ";
-                ranges.print(os);
-            }
     }
     void Assign::printCompact(std::ostream& os, bool html)
     {
@@ -5985,8 +6029,6 @@ bool Statement::propagateTo(bool& convert, std::map<Exp*, int, lessExpStar>* des
             }
         if (isLoopJunction())
             os << "LOOP";
-        os << "\n\t\t\tranges: ";
-        ranges.print(os);
         if (html)
             os << "</a></td>";
     }
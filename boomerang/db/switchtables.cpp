@@ -0,0 +1,85 @@
+/*
+ * See the file "LICENSE.TERMS" for information on usage and
+ * redistribution of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+/*==============================================================================
+ * FILE:	   switchtables.cpp
+ * OVERVIEW:   Implementation of SwitchTables, which reads the tables of switch statements and remembers what it read.
+ *============================================================================*/
+/*
+ * $Revision$
+ */
+
+#include <cassert>
+#include "switchtables.h"
+#include "prog.h"
+#include "statement.h"
+#include "dataindex.h"
+
+SwitchTables::SwitchTables(Prog *prog) : prog(prog)
+{}
+
+/*==============================================================================
+ * FUNCTION:		SwitchTables::getWords
+ * OVERVIEW:		Get the first num words of the table at a. If they have not all been read before, they are decoded
+ *					from the section's bytes in one go, or read one at a time if the table is not all in one section
+ * PARAMETERS:		a: native address of the table
+ *					num: the number of words wanted
+ * RETURNS:			The words; there are at least num of them
+ *============================================================================*/
+const std::vector<int> &SwitchTables::getWords(ADDRESS a, int num)
+{
+    std::vector<int> &words = tables[a];
+    if ((int)words.size() >= num)
+        return words;
+    words.resize(num);
+    const unsigned char *p = prog->getSpan(a, num * 4);
+    if (p == NULL)
+        {
+            for (int i = 0; i < num; i++)
+                words[i] = prog->readNative4(a + i * 4);
+            return words;
+        }
+    if (prog->getDataIndex()->isBigEndian())
+        for (int i = 0; i < num; i++, p += 4)
+            words[i] = (int)(((unsigned)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3]);
+    else
+        for (int i = 0; i < num; i++, p += 4)
+            words[i] = (int)(p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned)p[3] << 24));
+    return words;
+}
+
+int SwitchTables::numCodeEntries(ADDRESS a, int max)
+{
+    const std::vector<int> &words = getWords(a, max);
+    ADDRESS lo = prog->getLimitTextLow(), hi = prog->getLimitTextHigh();
+    int n = 0;
+    while (n < max && (ADDRESS)words[n] >= lo && (ADDRESS)words[n] < hi)
+        n++;
+    return n;
+}
+
+void SwitchTables::getDests(SWITCH_INFO *si, int num, std::vector<ADDRESS> &dests)
+{
+    assert(si->chForm != 'F');
+    dests.resize(num);
+    if (si->chForm == 'H')
+        {
+            // Pairs of words: the value and the destination for that value, or -1 if the entry is not used
+            const std::vector<int> &words = getWords(si->uTable, num * 2);
+            for (int i = 0; i < num; i++)
+                dests[i] = words[i*2] == -1 ? NO_ADDRESS : (ADDRESS)words[i*2 + 1];
+            return;
+        }
+    const std::vector<int> &words = getWords(si->uTable, num);
+    for (int i = 0; i < num; i++)
+        {
+            dests[i] = (ADDRESS)words[i];
+            if ((si->chForm == 'O') || (si->chForm == 'R') || (si->chForm == 'r'))
+                // Offset: add table address to make a real pointer to code.  For type R, the table is relative to the
+                // branch, so take iOffset. For others, iOffset is 0, so no harm
+                dests[i] += si->uTable - si->iOffset;
+        }
+}
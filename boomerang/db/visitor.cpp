@@ -23,6 +23,120 @@
 #include <sstream>
 
 
+// FusedExpVisitor class
+
+void FusedExpVisitor::add(ExpVisitor* v)
+{
+    assert(numVisitors < 32);
+    visitors[numVisitors] = v;
+    active |= 1u << numVisitors++;
+}
+
+bool FusedExpVisitor::isStopped(ExpVisitor* v)
+{
+    for (unsigned i = 0; i < numVisitors; i++)
+        if (visitors[i] == v)
+            return (stopped & (1u << i)) != 0;
+    return false;
+}
+
+void FusedExpVisitor::reset()
+{
+    stopped = 0;
+    active = numVisitors == 0 ? 0 : (unsigned)(~0u >> (32 - numVisitors));
+}
+
+// Let each active member visit e. Returns the set of members that want the usual recursion into e's children
+template <class T>
+unsigned FusedExpVisitor::visitMembers(T* e)
+{
+    unsigned recurse = 0;
+    for (unsigned i = 0; i < numVisitors; i++)
+        {
+            unsigned bit = 1u << i;
+            if ((active & bit) == 0) continue;
+            bool override = false;
+            if (!visitors[i]->visit(e, override))
+                stopped |= bit;
+            else if (!override)
+                recurse |= bit;
+        }
+    return recurse;
+}
+
+template <class T>
+bool FusedExpVisitor::visitLeaf(T* e)
+{
+    for (unsigned i = 0; i < numVisitors; i++)
+        {
+            unsigned bit = 1u << i;
+            if ((active & bit) && !visitors[i]->visit(e))
+                stopped |= bit;
+        }
+    active &= ~stopped;
+    return active != 0;
+}
+
+// Walk the children with only the members in recurse, then carry on with whichever members are still searching
+bool FusedExpVisitor::walkChildren(unsigned recurse, Exp* e1, Exp* e2, Exp* e3)
+{
+    unsigned saved = active;
+    active = recurse & ~stopped;
+    if (active && e1) e1->accept(this);
+    if (active && e2) e2->accept(this);
+    if (active && e3) e3->accept(this);
+    active = saved & ~stopped;
+    return active != 0;
+}
+
+bool FusedExpVisitor::visit(Unary* e, bool& override)
+{
+    override = true;		// The children are walked here, for the members that want them
+    return walkChildren(visitMembers(e), e->getSubExp1());
+}
+bool FusedExpVisitor::visit(Binary* e, bool& override)
+{
+    override = true;
+    return walkChildren(visitMembers(e), e->getSubExp1(), e->getSubExp2());
+}
+bool FusedExpVisitor::visit(Ternary* e, bool& override)
+{
+    override = true;
+    return walkChildren(visitMembers(e), e->getSubExp1(), e->getSubExp2(), e->getSubExp3());
+}
+bool FusedExpVisitor::visit(TypedExp* e, bool& override)
+{
+    override = true;
+    return walkChildren(visitMembers(e), e->getSubExp1());
+}
+bool FusedExpVisitor::visit(FlagDef* e, bool& override)
+{
+    override = true;
+    return walkChildren(visitMembers(e), e->getSubExp1());
+}
+bool FusedExpVisitor::visit(RefExp* e, bool& override)
+{
+    override = true;
+    return walkChildren(visitMembers(e), e->getSubExp1());
+}
+bool FusedExpVisitor::visit(Location* e, bool& override)
+{
+    override = true;
+    return walkChildren(visitMembers(e), e->getSubExp1());
+}
+bool FusedExpVisitor::visit(Const* e)
+{
+    return visitLeaf(e);
+}
+bool FusedExpVisitor::visit(Terminal* e)
+{
+    return visitLeaf(e);
+}
+bool FusedExpVisitor::visit(TypeVal* e)
+{
+    return visitLeaf(e);
+}
+
 // FixProcVisitor class
 
 bool FixProcVisitor::visit(Location* l, bool& override)
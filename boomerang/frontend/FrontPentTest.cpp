@@ -10,6 +10,7 @@
  * 21 May 02 - Mike: Mods for gcc 3.1
  */
 
+#include <algorithm>
 #include "types.h"
 #include "rtl.h"
 #include "FrontPentTest.h"
@@ -19,6 +20,8 @@
 #include "BinaryFile.h"
 #include "BinaryFileStub.h"
 #include "decoder.h"
+#include "signature.h"
+#include "statement.h"
 #include "boomerang.h"
 #include "log.h"
 CPPUNIT_TEST_SUITE_REGISTRATION( FrontPentTest );
@@ -277,3 +280,136 @@ void FrontPentTest::testFindMain()
 
     delete pFE;
 }
+
+/*==============================================================================
+ * FUNCTION:		FrontPentTest::testWarmCaches
+ * OVERVIEW:		Test that front ends made after FrontEnd::warmCaches() get the same SSL dictionary, signatures
+ *					and named types as ones that read them for themselves
+ *============================================================================*/
+void FrontPentTest::testWarmCaches()
+{
+    BinaryFileFactory bff;
+    BinaryFile *pBF = bff.Load(HELLO_PENT);
+    CPPUNIT_ASSERT(pBF != NULL);
+    Prog *prog = new Prog;
+    FrontEnd *cold = new PentiumFrontEnd(pBF, prog, NULL);
+    Type::clearNamedTypes();
+    cold->readLibraryCatalog();
+    Signature *coldPrintf = cold->getLibSignature("printf");
+    unsigned coldDict = cold->getDecoder()->getRTLDict().idict.size();
+    CPPUNIT_ASSERT(coldDict != 0);
+    CPPUNIT_ASSERT(Type::getNamedType("size_t") != NULL);
+
+    FrontEnd::warmCaches();
+    CPPUNIT_ASSERT(Type::getNamedType("size_t") == NULL);		// Given back by readLibraryCatalog()
+    FrontEnd *warm1 = new PentiumFrontEnd(pBF, prog, NULL);
+    warm1->readLibraryCatalog();
+    FrontEnd *warm2 = new PentiumFrontEnd(pBF, prog, NULL);
+    warm2->readLibraryCatalog();
+    CPPUNIT_ASSERT_EQUAL(coldDict, (unsigned)warm1->getDecoder()->getRTLDict().idict.size());
+    CPPUNIT_ASSERT_EQUAL(coldDict, (unsigned)warm2->getDecoder()->getRTLDict().idict.size());
+    Signature *warmPrintf = warm1->getLibSignature("printf");
+    CPPUNIT_ASSERT(warmPrintf == warm2->getLibSignature("printf"));	// Parsed once
+    CPPUNIT_ASSERT(*warmPrintf == *coldPrintf);
+    CPPUNIT_ASSERT(Type::getNamedType("size_t") != NULL);
+
+    RTLInstDict::keepParsed = false;
+    FrontEnd::keepSignatures = false;
+    pBF->Close();
+}
+
+/*==============================================================================
+ * FUNCTION:		FrontPentTest::testFindProcCandidates
+ * OVERVIEW:		Test scanning the code for procs, with one thread and with several
+ *============================================================================*/
+void FrontPentTest::testFindProcCandidates()
+{
+    BinaryFileFactory bff;
+    BinaryFile *pBF = bff.Load(HELLO_PENT);
+    CPPUNIT_ASSERT(pBF != NULL);
+    Prog *prog = new Prog;
+    FrontEnd *pFE = new PentiumFrontEnd(pBF, prog, NULL);
+    std::vector<ADDRESS> found = pFE->findProcCandidates(1);
+    // Every candidate is a function in the symbol table, and main is one of them
+    CPPUNIT_ASSERT_EQUAL(6, (int)found.size());
+    for (unsigned i = 0; i < found.size(); i++)
+        CPPUNIT_ASSERT(pBF->SymbolByAddress(found[i]) != NULL);
+    CPPUNIT_ASSERT(std::find(found.begin(), found.end(), (ADDRESS)0x8048328) != found.end());
+    CPPUNIT_ASSERT(found == pFE->findProcCandidates(4));
+    pBF->Close();
+}
+
+/*==============================================================================
+ * FUNCTION:		FrontPentTest::testDecodeCache
+ * OVERVIEW:		Test that an instruction taken from the decode cache is a new copy of the same RTL
+ *============================================================================*/
+void FrontPentTest::testDecodeCache()
+{
+    BinaryFileFactory bff;
+    BinaryFile *pBF = bff.Load(HELLO_PENT);
+    CPPUNIT_ASSERT(pBF != NULL);
+    Prog *prog = new Prog;
+    FrontEnd *pFE = new PentiumFrontEnd(pBF, prog, &bff);
+    prog->setFrontEnd(pFE);
+
+    // As the decoder would make it for call printf (at 0x8048340), so that this part doesn't need the decoder
+    DecodeResult cached;
+    cached.reset();
+    cached.numBytes = 5;
+    cached.rtl = new RTL(0x8048340);
+    CallStatement *call = new CallStatement;
+    call->setDest(0x8048268);
+    call->setDestProc(prog->setNewProc(0x8048268));
+    cached.rtl->appendStmt(call);
+    CPPUNIT_ASSERT(call->getDestProc() != NULL);
+
+    DecodeResult first = pFE->reuseDecoded(cached);
+    CPPUNIT_ASSERT(first.rtl != cached.rtl);
+    CPPUNIT_ASSERT_EQUAL(5, first.numBytes);
+    CPPUNIT_ASSERT_EQUAL(std::string(cached.rtl->prints()), std::string(first.rtl->prints()));
+    // The copy still knows which proc it calls
+    CallStatement *call1 = (CallStatement*)first.rtl->getList().back();
+    CPPUNIT_ASSERT(call1->isCall());
+    CPPUNIT_ASSERT(call1->getDestProc() == call->getDestProc());
+    // Changing the copy doesn't change the next one
+    first.rtl->getList().clear();
+    DecodeResult again = pFE->reuseDecoded(cached);
+    CPPUNIT_ASSERT_EQUAL(std::string(cached.rtl->prints()), std::string(again.rtl->prints()));
+
+    // The decoders keep host addresses in 32 bits, so only decode for real if the text was loaded below 4GB
+    if (((unsigned long long)(pBF->getLimitTextLow() + pBF->getTextDelta()) >> 32) == 0)
+        {
+            DecodeResult decoded = pFE->decodeInstruction(0x8048340);
+            DecodeResult redecoded = pFE->decodeInstruction(0x8048340);
+            CPPUNIT_ASSERT(decoded.rtl != redecoded.rtl);
+            CPPUNIT_ASSERT_EQUAL(decoded.numBytes, redecoded.numBytes);
+            CPPUNIT_ASSERT_EQUAL(std::string(decoded.rtl->prints()), std::string(redecoded.rtl->prints()));
+            CPPUNIT_ASSERT(((CallStatement*)decoded.rtl->getList().back())->getDestProc() == call->getDestProc());
+            CPPUNIT_ASSERT(((CallStatement*)redecoded.rtl->getList().back())->getDestProc() == call->getDestProc());
+        }
+    delete prog;
+}
+
+/*==============================================================================
+ * FUNCTION:		FrontPentTest::testDefaultSignatures
+ * OVERVIEW:		Test that an unknown library function gets the same default signature each time
+ *============================================================================*/
+void FrontPentTest::testDefaultSignatures()
+{
+    BinaryFileFactory bff;
+    BinaryFile *pBF = bff.Load(HELLO_PENT);
+    CPPUNIT_ASSERT(pBF != NULL);
+    Prog *prog = new Prog;
+    FrontEnd *pFE = new PentiumFrontEnd(pBF, prog, &bff);
+    prog->setFrontEnd(pFE);
+
+    unsigned made = Signature::stats.defaultsMade, reused = Signature::stats.defaultsReused;
+    Signature *sig = pFE->getLibSignature("no_such_function");
+    CPPUNIT_ASSERT(sig != NULL);
+    CPPUNIT_ASSERT_EQUAL(std::string("no_such_function"), std::string(sig->getName()));
+    CPPUNIT_ASSERT(pFE->getLibSignature("no_such_function") == sig);
+    CPPUNIT_ASSERT(pFE->getLibSignature("another_function") != sig);
+    CPPUNIT_ASSERT_EQUAL(made + 2, Signature::stats.defaultsMade);
+    CPPUNIT_ASSERT_EQUAL(reused + 1, Signature::stats.defaultsReused);
+    delete prog;
+}
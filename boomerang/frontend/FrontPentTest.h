@@ -8,6 +8,10 @@ class FrontPentTest : public CPPUNIT_NS::TestFixture
     CPPUNIT_TEST( test3 );
     CPPUNIT_TEST( testBranch );
     CPPUNIT_TEST( testFindMain );
+    CPPUNIT_TEST( testWarmCaches );
+    CPPUNIT_TEST( testFindProcCandidates );
+    CPPUNIT_TEST( testDecodeCache );
+    CPPUNIT_TEST( testDefaultSignatures );
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -20,5 +24,9 @@ protected:
     void test3 ();
     void testBranch();
     void testFindMain();
+    void testWarmCaches();
+    void testFindProcCandidates();
+    void testDecodeCache();
+    void testDefaultSignatures();
 };
 
@@ -37,9 +37,15 @@
 #include <sstream>
 #include <cstring>
 #include <cstdlib>
+#include <climits>
 #ifndef _WIN32
 #include <dlfcn.h>			// dlopen, dlsym
 #endif
+#include <algorithm>
+#if !defined(_WIN32) && defined(NO_GARBAGE_COLLECTOR)
+#define PARALLEL_SCAN 1				// Threads for findProcCandidates; the collector would need to know about them
+#include <pthread.h>
+#endif
 
 #include "types.h"
 #include "exp.h"
@@ -55,6 +61,7 @@
 #include "mipsfrontend.h"
 #include "st20frontend.h"
 #include "prog.h"
+#include "dataindex.h"
 #include "signature.h"
 #include "boomerang.h"
 #include "log.h"
@@ -68,7 +75,8 @@
  *				  pbff: pointer to a BinaryFileFactory object (so the library can be unloaded)
  * RETURNS:		  <N/a>
  *============================================================================*/
-FrontEnd::FrontEnd(BinaryFile *pBF, Prog* prog, BinaryFileFactory* pbff) : pBF(pBF), pbff(pbff), prog(prog)
+FrontEnd::FrontEnd(BinaryFile *pBF, Prog* prog, BinaryFileFactory* pbff) : pBF(pBF), pbff(pbff), prog(prog),
+    cachedResult(NULL)
 {}
 
 // Static function to instantiate an appropriate concrete front end
@@ -104,6 +112,12 @@ FrontEnd* FrontEnd::Load(const char *fname, Prog* prog)
 // destructor
 FrontEnd::~FrontEnd()
 {
+    for (std::map<ADDRESS, DecodeResult*>::iterator it = decodeCache.begin(); it != decodeCache.end(); it++)
+        {
+            delete it->second->rtl;
+            delete it->second;
+        }
+    delete cachedResult;
     if (pbff)
         pbff->UnLoad();			// Unload the BinaryFile library with dlclose() or FreeLibrary()
 }
@@ -150,6 +164,14 @@ FrontEnd *FrontEnd::createById(std::string &str, BinaryFile *pBF, Prog* prog)
     return NULL;
 }
 
+// The signatures read from each file, by platform, calling convention and path, when keepSignatures is set
+static std::map<std::string, std::list<Signature*> > keptSignatures;
+
+// The named types defined by each platform's signature files, kept by warmCaches()
+static std::map<platform, std::map<std::string, Type*> > keptNamedTypes;
+
+bool FrontEnd::keepSignatures = false;
+
 void FrontEnd::readLibraryCatalog(const char *sPath)
 {
     std::ifstream inf(sPath);
@@ -181,6 +203,9 @@ void FrontEnd::readLibraryCatalog(const char *sPath)
 void FrontEnd::readLibraryCatalog()
 {
     librarySignatures.clear();
+    std::map<platform, std::map<std::string, Type*> >::iterator types = keptNamedTypes.find(getFrontEndId());
+    if (keepSignatures && types != keptNamedTypes.end())
+        Type::getNamedTypes().insert(types->second.begin(), types->second.end());
     std::string sList = Boomerang::get()->getProgPath() + "signatures/common.hs";
 
     readLibraryCatalog(sList.c_str());
@@ -273,6 +298,168 @@ std::vector<ADDRESS> FrontEnd::getEntryPoints()
     return entrypoints;
 }
 
+#define SCAN_CHUNK	0x10000			// Size of the chunks of code that findProcCandidates scans
+#define PROC_VOTES	3				// Votes needed to be a proc candidate
+
+// A chunk of code to scan for procs, and the votes from scanning it
+struct ScanJob
+{
+    const unsigned char *code;		// Host address of the section
+    ADDRESS		sectLo, sectHi;		// The section
+    ADDRESS		lo, hi;				// The chunk
+    std::map<ADDRESS, int> votes;
+};
+
+// The jobs shared by the scanning threads
+struct ScanBatch
+{
+    FrontEnd	*fe;
+    std::vector<ScanJob> *jobs;
+    unsigned	next;				// Index of the next job not yet taken by a thread
+#if PARALLEL_SCAN
+    pthread_mutex_t mutex;
+#endif
+};
+
+static void* scanThread(void* arg)
+{
+    ScanBatch* batch = (ScanBatch*)arg;
+    for (;;)
+        {
+#if PARALLEL_SCAN
+            pthread_mutex_lock(&batch->mutex);
+#endif
+            unsigned n = batch->next++;
+#if PARALLEL_SCAN
+            pthread_mutex_unlock(&batch->mutex);
+#endif
+            if (n >= batch->jobs->size())
+                break;
+            ScanJob& job = (*batch->jobs)[n];
+            batch->fe->scanForProcs(job.code, job.sectLo, job.sectHi, job.lo, job.hi, job.votes);
+        }
+    return NULL;
+}
+
+// For sorting the candidates: most votes first, then by address
+static bool moreVotes(const std::pair<ADDRESS, int>& x, const std::pair<ADDRESS, int>& y)
+{
+    if (x.second != y.second)
+        return x.second > y.second;
+    return x.first < y.first;
+}
+
+/*==============================================================================
+ * FUNCTION:	   FrontEnd::findProcCandidates
+ * OVERVIEW:	   Find the addresses in the code sections that look like the start of a proc, for finding procs that
+ *				   are only reached through pointers (or not at all). The code is split into chunks that are scanned
+ *				   by scanForProcs in numThreads threads; an address with at least PROC_VOTES votes is a candidate
+ * PARAMETERS:	   numThreads: the number of threads to scan with
+ * RETURNS:		   The candidates, the most votes first
+ *============================================================================*/
+std::vector<ADDRESS> FrontEnd::findProcCandidates(int numThreads)
+{
+    std::vector<ScanJob> jobs;
+    for (int i = 0; i < pBF->GetNumSections(); i++)
+        {
+            PSectionInfo sect = pBF->GetSectionInfo(i);
+            if (!sect->bCode || sect->bBss || sect->uHostAddr == NULL || sect->uSectionSize == 0)
+                continue;
+            ScanJob job;
+            job.code = sect->uHostAddr;
+            job.sectLo = sect->uNativeAddr;
+            job.sectHi = sect->uNativeAddr + sect->uSectionSize;
+            for (job.lo = job.sectLo; job.lo < job.sectHi; job.lo = job.hi)
+                {
+                    job.hi = job.lo + SCAN_CHUNK < job.sectHi ? job.lo + SCAN_CHUNK : job.sectHi;
+                    jobs.push_back(job);
+                }
+        }
+
+    ScanBatch batch;
+    batch.fe = this;
+    batch.jobs = &jobs;
+    batch.next = 0;
+#if PARALLEL_SCAN
+    pthread_mutex_init(&batch.mutex, NULL);
+    if ((unsigned)numThreads > jobs.size())
+        numThreads = jobs.size();
+    std::vector<pthread_t> threads(numThreads > 1 ? numThreads : 0);
+    int started = 0;
+    for (; started < (int)threads.size(); started++)
+        if (pthread_create(&threads[started], NULL, scanThread, &batch) != 0)
+            break;
+    if (started == 0)
+        scanThread(&batch);			// One thread, or couldn't start any; do it all here
+    for (int i = 0; i < started; i++)
+        pthread_join(threads[i], NULL);
+    pthread_mutex_destroy(&batch.mutex);
+#else
+    scanThread(&batch);
+#endif
+
+    std::map<ADDRESS, int> votes;
+    for (unsigned i = 0; i < jobs.size(); i++)
+        for (std::map<ADDRESS, int>::iterator it = jobs[i].votes.begin(); it != jobs[i].votes.end(); it++)
+            votes[it->first] += it->second;
+    std::vector<std::pair<ADDRESS, int> > ranked;
+    for (std::map<ADDRESS, int>::iterator it = votes.begin(); it != votes.end(); it++)
+        if (it->second >= PROC_VOTES)
+            ranked.push_back(*it);
+    std::sort(ranked.begin(), ranked.end(), moreVotes);
+    std::vector<ADDRESS> candidates;
+    candidates.reserve(ranked.size());
+    for (unsigned i = 0; i < ranked.size(); i++)
+        candidates.push_back(ranked[i].first);
+    return candidates;
+}
+
+// Add the extent of each basic block of proc to decoded, a map from the start to the end of each
+static void addDecoded(UserProc *proc, std::map<ADDRESS, ADDRESS> &decoded)
+{
+    BB_IT it;
+    Cfg *cfg = proc->getCFG();
+    for (PBB bb = cfg->getFirstBB(it); bb; bb = cfg->getNextBB(it))
+        if (bb->getRTLs())
+            decoded[bb->getLowAddr()] = bb->getHiAddr();
+}
+
+/*==============================================================================
+ * FUNCTION:	   FrontEnd::decodeProcCandidates
+ * OVERVIEW:	   Decode the candidates from findProcCandidates, most likely first, except those that are procs
+ *				   already or are in code that has been decoded (including code of candidates decoded before them)
+ * PARAMETERS:	   prog: the program
+ *				   numThreads: the number of threads to scan with
+ * RETURNS:		   The number of candidates decoded
+ *============================================================================*/
+int FrontEnd::decodeProcCandidates(Prog *prog, int numThreads)
+{
+    std::vector<ADDRESS> candidates = findProcCandidates(numThreads);
+    std::map<ADDRESS, ADDRESS> decoded;
+    PROGMAP::const_iterator pp;
+    for (Proc *p = prog->getFirstProc(pp); p; p = prog->getNextProc(pp))
+        if (!p->isLib() && ((UserProc*)p)->isDecoded())
+            addDecoded((UserProc*)p, decoded);
+    int n = 0;
+    for (unsigned i = 0; i < candidates.size(); i++)
+        {
+            ADDRESS a = candidates[i];
+            if (prog->findProc(a) != NULL)
+                continue;
+            std::map<ADDRESS, ADDRESS>::iterator it = decoded.upper_bound(a);
+            if (it != decoded.begin() && (--it)->second >= a)
+                continue;
+            if (VERBOSE)
+                LOG << "decoding proc candidate at " << a << "\n";
+            decode(prog, a);
+            UserProc *proc = (UserProc*)prog->findProc(a);
+            if (proc && !proc->isLib())
+                addDecoded(proc, decoded);
+            n++;
+        }
+    return n;
+}
+
 void FrontEnd::decode(Prog* prog, bool decodeMain, const char *pname)
 {
     if (pname)
@@ -409,6 +596,25 @@ void FrontEnd::decodeFragment(UserProc* proc, ADDRESS a)
     processProc(a, proc, os, true);
 }
 
+// Clone a decoded RTL. Cloning a call loses its destination proc; find it again, as the decoders do
+static RTL* cloneDecoded(RTL *rtl, Prog *prog)
+{
+    RTL *ret = rtl->clone();
+    std::list<Statement*> &orig = rtl->getList();
+    std::list<Statement*> &cloned = ret->getList();
+    std::list<Statement*>::iterator cc, ss;
+    for (cc = orig.begin(), ss = cloned.begin(); cc != orig.end(); cc++, ss++)
+        {
+            if (!(*cc)->isCall() || ((CallStatement*)*cc)->getDestProc() == NULL)
+                continue;
+            Proc *destProc = prog->setNewProc(((CallStatement*)*cc)->getFixedDest());
+            if (destProc == (Proc*)-1) destProc = NULL;		// In case a deleted Proc
+            if (destProc)
+                ((CallStatement*)*ss)->setDestProc(destProc);
+        }
+    return ret;
+}
+
 DecodeResult& FrontEnd::decodeInstruction(ADDRESS pc)
 {
     if (pBF->GetSectionInfoByAddr(pc) == NULL)
@@ -419,7 +625,90 @@ DecodeResult& FrontEnd::decodeInstruction(ADDRESS pc)
             invalid.valid = false;
             return invalid;
         }
-    return decoder->decodeInstruction(pc, pBF->getTextDelta());
+    std::map<ADDRESS, DecodeResult*>::iterator ff = decodeCache.find(pc);
+    if (ff != decodeCache.end())
+        return reuseDecoded(*ff->second);
+    DecodeResult &inst = decoder->decodeInstruction(pc, pBF->getTextDelta());
+    if (inst.reDecode)
+        noDecodeCache.insert(pc);
+    else if (inst.valid && inst.rtl && noDecodeCache.find(pc) == noDecodeCache.end())
+        {
+            DecodeResult *copy = new DecodeResult(inst);
+            copy->rtl = cloneDecoded(inst.rtl, prog);
+            decodeCache[pc] = copy;
+            newlyCached.push_back(pc);
+        }
+    return inst;
+}
+
+/*==============================================================================
+ * FUNCTION:	   FrontEnd::reuseDecoded
+ * OVERVIEW:	   Give the caller its own copy of an instruction that was decoded before
+ * PARAMETERS:	   cached: the instruction, from decodeCache
+ * RETURNS:		   The copy; valid until the next call
+ *============================================================================*/
+DecodeResult& FrontEnd::reuseDecoded(DecodeResult &cached)
+{
+    if (cachedResult == NULL)
+        cachedResult = new DecodeResult;
+    *cachedResult = cached;
+    cachedResult->rtl = cloneDecoded(cached.rtl, prog);
+    return *cachedResult;
+}
+
+// Remove the instruction at a from the decode cache
+static void uncache(std::map<ADDRESS, DecodeResult*> &decodeCache, ADDRESS a)
+{
+    std::map<ADDRESS, DecodeResult*>::iterator ff = decodeCache.find(a);
+    if (ff == decodeCache.end())
+        return;				// Already dropped, by another proc with the same code
+    delete ff->second->rtl;
+    delete ff->second;
+    decodeCache.erase(ff);
+}
+
+/*==============================================================================
+ * FUNCTION:	   FrontEnd::keepDecodeCache
+ * OVERVIEW:	   At the end of decoding a proc, keep the instructions it added to the decode cache only if the proc
+ *				   has indirect jumps or calls, and so will probably be decoded again. They are kept until
+ *				   dropDecodeCache is called for the proc
+ * PARAMETERS:	   first: the size of newlyCached when the proc was started
+ *				   pProc: the proc
+ *				   pCfg: the proc's CFG, or NULL to keep them regardless (e.g. for a fragment)
+ * RETURNS:		   <nothing>
+ *============================================================================*/
+void FrontEnd::keepDecodeCache(unsigned first, UserProc *pProc, Cfg *pCfg)
+{
+    bool keep = pCfg == NULL;
+    BB_IT it;
+    for (PBB pBB = keep ? NULL : pCfg->getFirstBB(it); pBB && !keep; pBB = pCfg->getNextBB(it))
+        keep = pBB->getType() == COMPJUMP || pBB->getType() == COMPCALL || pBB->getType() == NWAY;
+    if (keep)
+        {
+            std::vector<ADDRESS> &kept = procCached[pProc];
+            kept.insert(kept.end(), newlyCached.begin() + first, newlyCached.end());
+        }
+    else
+        for (unsigned i = first; i < newlyCached.size(); i++)
+            uncache(decodeCache, newlyCached[i]);
+    newlyCached.resize(first);
+}
+
+/*==============================================================================
+ * FUNCTION:	   FrontEnd::dropDecodeCache
+ * OVERVIEW:	   Free the instructions kept in the decode cache for a proc. Called when its indirect jumps and calls
+ *				   have been analysed as far as they will be, since it will not be decoded again after that
+ * PARAMETERS:	   pProc: the proc
+ * RETURNS:		   <nothing>
+ *============================================================================*/
+void FrontEnd::dropDecodeCache(UserProc *pProc)
+{
+    std::map<UserProc*, std::vector<ADDRESS> >::iterator pp = procCached.find(pProc);
+    if (pp == procCached.end())
+        return;
+    for (unsigned i = 0; i < pp->second.size(); i++)
+        uncache(decodeCache, pp->second[i]);
+    procCached.erase(pp);
 }
 
 /*==============================================================================
@@ -431,6 +720,17 @@ DecodeResult& FrontEnd::decodeInstruction(ADDRESS pc)
  *============================================================================*/
 void FrontEnd::readLibrarySignatures(const char *sPath, callconv cc)
 {
+    platform plat = getFrontEndId();
+    std::ostringstream key;
+    key << plat << " " << cc << " " << sPath;
+    std::map<std::string, std::list<Signature*> >::iterator kept = keptSignatures.find(key.str());
+    if (keepSignatures && kept != keptSignatures.end())
+        {
+            for (std::list<Signature*>::iterator it = kept->second.begin(); it != kept->second.end(); it++)
+                librarySignatures[(*it)->getName()] = *it;
+            return;
+        }
+
     std::ifstream ifs;
 
     ifs.open(sPath);
@@ -443,7 +743,6 @@ void FrontEnd::readLibrarySignatures(const char *sPath, callconv cc)
 
     AnsiCParser *p = new AnsiCParser(ifs, false);
 
-    platform plat = getFrontEndId();
     p->yyparse(plat, cc);
 
     for (std::list<Signature*>::iterator it = p->signatures.begin(); it != p->signatures.end(); it++)
@@ -454,11 +753,47 @@ void FrontEnd::readLibrarySignatures(const char *sPath, callconv cc)
             librarySignatures[(*it)->getName()] = *it;
             (*it)->setSigFile(sPath);
         }
+    if (keepSignatures)
+        keptSignatures[key.str()] = p->signatures;
 
     delete p;
     ifs.close();
 }
 
+/*==============================================================================
+ * FUNCTION:	   FrontEnd::warmCaches
+ * OVERVIEW:	   Read the SSL file and library signature catalogs of every platform that has a catalog, and keep
+ *				   them, so that front ends made later only have to copy them. The named types that each platform's
+ *				   signature files define are kept as well, and given back by readLibraryCatalog()
+ * PARAMETERS:	   <none>
+ * RETURNS:		   <nothing>
+ *============================================================================*/
+void FrontEnd::warmCaches()
+{
+    static const char *names[] = {"pentium", "sparc", "ppc", "mips", "st20"};
+    RTLInstDict::keepParsed = true;
+    keepSignatures = true;
+    std::string sigDir = Boomerang::get()->getProgPath() + "signatures/";
+    for (unsigned i = 0; i < sizeof(names) / sizeof(*names); i++)
+        {
+            std::string name(names[i]);
+            std::ifstream test((sigDir + name + ".hs").c_str());
+            if (!test.good())
+                continue;				// readLibraryCatalog() can't be used for this platform
+            FrontEnd *fe = createById(name, NULL, NULL);	// Makes the decoder, which reads the SSL file
+            Type::clearNamedTypes();
+            fe->readLibraryCatalog((sigDir + "common.hs").c_str());
+            fe->readLibraryCatalog((sigDir + name + ".hs").c_str());
+            if (name == "pentium")
+                fe->readLibraryCatalog((sigDir + "win32.hs").c_str());
+            if (name == "pentium" || name == "ppc")
+                fe->readLibraryCatalog((sigDir + "objc.hs").c_str());		// Mach-O
+            keptNamedTypes[fe->getFrontEndId()] = Type::getNamedTypes();
+            delete fe;
+        }
+    Type::clearNamedTypes();
+}
+
 Signature *FrontEnd::getDefaultSignature(const char *name)
 {
     Signature *signature = NULL;
@@ -481,12 +816,21 @@ Signature *FrontEnd::getLibSignature(const char *name)
     it = librarySignatures.find(name);
     if (it == librarySignatures.end())
         {
+            // Make the default signature once per name; it is shared like the ones from the catalog
+            it = defaultSignatures.find(name);
+            if (it != defaultSignatures.end())
+                {
+                    Signature::stats.defaultsReused++;
+                    return it->second;
+                }
             LOG << "Unknown library function " << name << "\n";
             signature = getDefaultSignature(name);
+            defaultSignatures[name] = signature;
+            Signature::stats.defaultsMade++;
         }
     else
         {
-            // Don't clone here; cloned in CallStatement::setSigArguments
+            // Don't clone here; the calls share it, and CallStatement::ownSignature copies it for a call that changes it
             signature = (*it).second;
             signature->setUnknown(false);
         }
@@ -528,6 +872,7 @@ bool FrontEnd::processProc(ADDRESS uAddr, UserProc* pProc, std::ofstream &os, bo
     if (spec && (pCfg == 0))
         return false;
     assert(pCfg);
+    unsigned firstCached = newlyCached.size();
 
     // Initialise the queue of control flow targets that have yet to be decoded.
     targetQueue.initial(uAddr);
@@ -560,7 +905,10 @@ bool FrontEnd::processProc(ADDRESS uAddr, UserProc* pProc, std::ofstream &os, bo
 
                     // If invalid and we are speculating, just exit
                     if (spec && !inst.valid)
-                        return false;
+                        {
+                            keepDecodeCache(firstCached, pProc, pCfg);
+                            return false;
+                        }
 
                     // Need to construct a new list of RTLs if a basic block has just been finished but decoding is
                     // continuing from its lexical successor
@@ -792,18 +1140,14 @@ bool FrontEnd::processProc(ADDRESS uAddr, UserProc* pProc, std::ofstream &os, bo
                                                 {
                                                     // assume subExp2 is a jump table
                                                     ADDRESS jmptbl = ((Const*)pDest->getSubExp1()->getSubExp2())->getInt();
-                                                    unsigned int i;
-                                                    for (i = 0; ; i++)
+                                                    // The data index finds where the words stop pointing to code
+                                                    int i, n = pProc->getProg()->getDataIndex()->codePointerRun(jmptbl, INT_MAX);
+                                                    for (i = 0; i < n; i++)
                                                         {
                                                             ADDRESS uDest = pBF->readNative4(jmptbl + i * 4);
-                                                            if (pBF->getLimitTextLow() <= uDest && uDest < pBF->getLimitTextHigh())
-                                                                {
-                                                                    LOG << "  guessed uDest " << uDest << "\n";
-                                                                    targetQueue.visit(pCfg, uDest, pBB);
-                                                                    pCfg->addOutEdge(pBB, uDest, true);
-                                                                }
-                                                            else
-                                                                break;
+                                                            LOG << "  guessed uDest " << uDest << "\n";
+                                                            targetQueue.visit(pCfg, uDest, pBB);
+                                                            pCfg->addOutEdge(pBB, uDest, true);
                                                         }
                                                     pBB->updateType(NWAY, i);
                                                 }
@@ -1128,6 +1472,7 @@ bool FrontEnd::processProc(ADDRESS uAddr, UserProc* pProc, std::ofstream &os, bo
     if (VERBOSE)
         LOG << "finished processing proc " << pProc->getName() << " at address " << pProc->getNativeAddress() << "\n";
 
+    keepDecodeCache(firstCached, pProc, frag ? NULL : pCfg);
     return true;
 }
 
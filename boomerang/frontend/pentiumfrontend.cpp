@@ -742,6 +742,44 @@ ADDRESS PentiumFrontEnd::getMainEntryPoint(bool& gotMain)
     return start;
 }
 
+/*==============================================================================
+ * FUNCTION:	  PentiumFrontEnd::scanForProcs
+ * OVERVIEW:	  Vote for the starts of procs in a chunk of code (see FrontEnd::findProcCandidates). A standard
+ *					prologue (push ebp; mov ebp, esp) gets two votes, and one more if it is aligned or follows padding
+ *					or a return; each call to an address gets it a vote. The bytes are found with memchr, which is
+ *					much faster than looking at each byte here
+ * PARAMETERS:	  code: host address of the section
+ *				  sectLo, sectHi: the section
+ *				  lo, hi: the chunk
+ *				  votes: the votes
+ * RETURNS:		  <nothing>
+ *============================================================================*/
+void PentiumFrontEnd::scanForProcs(const unsigned char *code, ADDRESS sectLo, ADDRESS sectHi, ADDRESS lo,
+                                   ADDRESS hi, std::map<ADDRESS, int> &votes)
+{
+    const unsigned char *start = code + (lo - sectLo);
+    const unsigned char *end = code + (hi - sectLo);
+    const unsigned char *sectEnd = code + (sectHi - sectLo);
+    const unsigned char *p;
+    for (p = start; (p = (const unsigned char*)memchr(p, 0x55, end - p)) != NULL && p + 3 <= sectEnd; p++)
+        {
+            if (!((p[1] == 0x89 && p[2] == 0xE5) || (p[1] == 0x8B && p[2] == 0xEC)))
+                continue;
+            ADDRESS a = sectLo + (p - code);
+            int v = 2;
+            if ((a & 0xF) == 0 || (p > code && (p[-1] == 0x90 || p[-1] == 0xCC || p[-1] == 0xC3)))
+                v++;
+            votes[a] += v;
+        }
+    for (p = start; (p = (const unsigned char*)memchr(p, 0xE8, end - p)) != NULL && p + 5 <= sectEnd; p++)
+        {
+            int disp = (int)(p[1] | (p[2] << 8) | (p[3] << 16) | ((unsigned)p[4] << 24));
+            ADDRESS dest = sectLo + (p - code) + 5 + disp;
+            if (dest >= sectLo && dest < sectHi)
+                votes[dest]++;
+        }
+}
+
 void toBranches(ADDRESS a, bool lastRtl, Cfg* cfg, RTL* rtl, PBB bb, BB_IT& it)
 {
     BranchStatement* br1 = new BranchStatement;
@@ -95,6 +95,50 @@ ADDRESS PPCFrontEnd::getMainEntryPoint( bool &gotMain )
     return start;
 }
 
+/*==============================================================================
+ * FUNCTION:	  PPCFrontEnd::scanForProcs
+ * OVERVIEW:	  Vote for the starts of procs in a chunk of code (see FrontEnd::findProcCandidates). A frame is made
+ *					with stwu r1, -n(r1), often just after mflr r0; that gets two votes, and one more if the mflr is
+ *					there or a blr is just before it. Each bl to an address gets it a vote
+ * PARAMETERS:	  code: host address of the section
+ *				  sectLo, sectHi: the section
+ *				  lo, hi: the chunk
+ *				  votes: the votes
+ * RETURNS:		  <nothing>
+ *============================================================================*/
+void PPCFrontEnd::scanForProcs(const unsigned char *code, ADDRESS sectLo, ADDRESS sectHi, ADDRESS lo,
+                               ADDRESS hi, std::map<ADDRESS, int> &votes)
+{
+    unsigned prev = 0;
+    if (lo >= sectLo + 4)
+        {
+            const unsigned char *p = code + (lo - sectLo) - 4;
+            prev = ((unsigned)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+        }
+    for (ADDRESS a = (lo + 3) & ~3; a + 4 <= hi; a += 4)
+        {
+            const unsigned char *p = code + (a - sectLo);
+            unsigned w = ((unsigned)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+            if ((w & 0xFFFF8000) == 0x94218000)				// stwu r1, -n(r1)
+                {
+                    if (prev == 0x7C0802A6)						// mflr r0 just before: the proc starts there
+                        votes[a - 4] += 3;
+                    else
+                        votes[a] += prev == 0x4E800020 ? 3 : 2;		// blr just before
+                }
+            else if ((w & 0xFC000003) == 0x48000001)			// bl
+                {
+                    int li = w & 0x03FFFFFC;
+                    if (li & 0x02000000)
+                        li |= 0xFC000000;
+                    ADDRESS dest = a + li;
+                    if (dest >= sectLo && dest < sectHi)
+                        votes[dest]++;
+                }
+            prev = w;
+        }
+}
+
 
 bool PPCFrontEnd::processProc(ADDRESS uAddr, UserProc* pProc, std::ofstream &os, bool frag /* = false */,
                               bool spec /* = false */)
@@ -796,6 +796,7 @@ bool SparcFrontEnd::processProc(ADDRESS address, UserProc* proc, std::ofstream &
     if (spec && (cfg == 0))
         return false;
     assert(cfg);
+    unsigned firstCached = newlyCached.size();
 
     // Initialise the queue of control flow targets that have yet to be decoded.
     targetQueue.initial(address);
@@ -833,7 +834,10 @@ bool SparcFrontEnd::processProc(ADDRESS address, UserProc* proc, std::ofstream &
 
                     // If invalid and we are speculating, just exit
                     if (spec && !inst.valid)
-                        return false;
+                        {
+                            keepDecodeCache(firstCached, proc, cfg);
+                            return false;
+                        }
 
                     // Check for invalid instructions
                     if (!inst.valid)
@@ -844,6 +848,7 @@ bool SparcFrontEnd::processProc(ADDRESS address, UserProc* proc, std::ofstream &
                             for (int j=0; j<inst.numBytes; j++)
                                 std::cerr << std::setfill('0') << std::setw(2) << (unsigned)*(unsigned char*)(address+delta + j) <<
                                           " " << std::setfill(' ') << std::setw(0) << "\n";
+                            keepDecodeCache(firstCached, proc, cfg);
                             return false;
                         }
 
@@ -1046,7 +1051,10 @@ bool SparcFrontEnd::processProc(ADDRESS address, UserProc* proc, std::ofstream &
                                             sequentialDecode = false;
                                         }
                                     if (spec && (inst.valid == false))
-                                        return false;
+                                        {
+                                            keepDecodeCache(firstCached, proc, cfg);
+                                            return false;
+                                        }
                                     break;
                                 }
 
@@ -1285,6 +1293,7 @@ bool SparcFrontEnd::processProc(ADDRESS address, UserProc* proc, std::ofstream &
     // MVE: Not 100% sure this is the right place for this
     proc->setEntryBB();
 
+    keepDecodeCache(firstCached, proc, fragment ? NULL : cfg);
     return true;
 }
 
@@ -1662,3 +1671,32 @@ ADDRESS SparcFrontEnd::getMainEntryPoint( bool &gotMain )
     gotMain = true;
     return start;
 }
+
+/*==============================================================================
+ * FUNCTION:	  SparcFrontEnd::scanForProcs
+ * OVERVIEW:	  Vote for the starts of procs in a chunk of code (see FrontEnd::findProcCandidates). A save %sp, n, %sp
+ *					is only ever found at the start of a proc, so it gets enough votes by itself; each call to an
+ *					address gets it a vote, which is what finds leaf procs
+ * PARAMETERS:	  code: host address of the section
+ *				  sectLo, sectHi: the section
+ *				  lo, hi: the chunk
+ *				  votes: the votes
+ * RETURNS:		  <nothing>
+ *============================================================================*/
+void SparcFrontEnd::scanForProcs(const unsigned char *code, ADDRESS sectLo, ADDRESS sectHi, ADDRESS lo,
+                                 ADDRESS hi, std::map<ADDRESS, int> &votes)
+{
+    for (ADDRESS a = (lo + 3) & ~3; a + 4 <= hi; a += 4)
+        {
+            const unsigned char *p = code + (a - sectLo);
+            unsigned w = ((unsigned)p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+            if ((w & 0xFFFFE000) == 0x9DE3A000)			// save %sp, simm13, %sp
+                votes[a] += 3;
+            else if ((w >> 30) == 1)						// call disp30
+                {
+                    ADDRESS dest = a + (int)(w << 2);
+                    if (dest >= sectLo && dest < sectHi)
+                        votes[dest]++;
+                }
+        }
+}
@@ -51,6 +51,9 @@ public:
 
     virtual ADDRESS getMainEntryPoint( bool &gotMain );
 
+    virtual void		scanForProcs(const unsigned char *code, ADDRESS sectLo, ADDRESS sectHi, ADDRESS lo, ADDRESS hi,
+                                     std::map<ADDRESS, int> &votes);
+
 private:
 
     void	warnDCTcouple(ADDRESS uAt, ADDRESS uDest);
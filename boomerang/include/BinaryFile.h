@@ -28,7 +28,7 @@
  *============================================================================*/
 
 #include "types.h"
-//#include "SymTab.h"	// Was used for relocaton stuff
+#include "SymTab.h"
 #include <list>
 #include <map>
 #include <string>
@@ -250,8 +250,7 @@ public:
     virtual const char* SymbolByAddress(ADDRESS uNative);
     // Lookup the name, return the address. If not found, return NO_ADDRESS
     virtual ADDRESS		GetAddressByName(const char* pName, bool bNoTypeOK = false);
-    virtual void		AddSymbol(ADDRESS uNative, const char *pName)
-    { }
+    virtual void		AddSymbol(ADDRESS uNative, const char *pName);
     // Lookup the name, return the size
     virtual int GetSizeByName(const char* pName, bool bTypeOK = false);
     // Get an array of addresses of imported function stubs
@@ -323,7 +322,7 @@ public:
 
     virtual std::map<ADDRESS, std::string> &getSymbols()
     {
-        return *new std::map<ADDRESS, std::string>();
+        return m_Symbols.getAll();
     }
 
     virtual std::map<std::string, ObjcModule> &getObjcModules()
@@ -369,6 +368,8 @@ protected:
     PSectionInfo m_pSections;				// The section info
     ADDRESS		m_uInitPC;					// Initial program counter
     ADDRESS		m_uInitSP;					// Initial stack pointer
+    SymTab		m_Symbols;					// The symbols, by address and by name. Used by the Symbol table
+                                            // functions above unless a loader overrides them
 
     // Public addresses being the lowest used native address (inclusive), and
     // the highest used address (not inclusive) in the text segment
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2005, Mike Van Emmerik
+ *
+ * See the file "LICENSE.TERMS" for information on usage and
+ * redistribution of this file, and for a DISCLAIMER OF ALL
+ * WARRANTIES.
+ *
+ */
+
+/*==============================================================================
+ * FILE:        SymTab.h
+ * OVERVIEW:    This file contains the definition of the class SymTab, the symbol table of a BinaryFile, that can be
+ *				looked up by address or by name.
+ *				The names are interned: each distinct name is stored once, in a pool that is never moved, so the
+ *				const char*s returned stay valid for the life of the table, and names can be compared by pointer.
+ *				Both lookups are hashed. The symbols are also kept in an array that is sorted by address when
+ *				needed, for iterating in address order and for finding the nearest symbol below an address.
+ *============================================================================*/
+
+/*
+ * $Revision$
+ *
+ * 12 Jul 05 - Mike: New implementation with two maps
+*/
+
+#ifndef __SYMTAB_H__
+#define __SYMTAB_H__
+
+#include "types.h"
+#include <map>
+#include <string>
+#include <vector>
+
+class SymTab
+{
+public:
+    struct Symbol
+    {
+        ADDRESS		addr;
+        const char	*name;					// Interned
+    };
+    typedef std::vector<Symbol>::const_iterator iterator;
+
+private:
+    struct NameSlot
+    {
+        const char	*name;					// Interned name; NULL if the slot is empty
+        unsigned	hash;
+        ADDRESS		addr;					// Lowest address with this name, or NO_ADDRESS if none now
+    };
+    // The symbols, one per address
+    std::vector<Symbol> syms;
+    bool		sorted;						// syms is in address order
+    // Open addressing hash table from address to index in syms; -1 for empty
+    std::vector<int> addrIndex;
+    // Open addressing hash table of names. Slots are never removed, so they also intern the names
+    std::vector<NameSlot> nameIndex;
+    unsigned	numNames;
+    // The pool that the names are stored in
+    std::vector<char*> pool;
+    char		*poolNext;
+    unsigned	poolLeft;
+    // The symbols as a map, made by getAll() when needed
+    std::map<ADDRESS, std::string> amap;
+    bool		amapValid;
+
+    NameSlot	*findName(const char* s, unsigned h);
+    NameSlot	*intern(const char* s);
+    int			findAddr(ADDRESS a);
+    void		insertAddr(ADDRESS a, int i);
+    void		rehashAddrs(unsigned size);
+    void		renamed(NameSlot *slot, ADDRESS a);
+    void		sort();
+
+    SymTab(const SymTab&);					// Not copyable; the names point into the pool
+    SymTab&		operator=(const SymTab&);
+public:
+    SymTab();						// Constructor
+    ~SymTab();						// Destructor
+    void		Add(ADDRESS a, const char* s);	// Add a new entry, replacing any at the same address
+    const char*	find(ADDRESS a);				// Find an entry by address; NULL if none
+    ADDRESS		find(const char* s);			// Find an entry by name (the lowest if several); NO_ADDRESS if none
+    // Find the entry at or nearest below a; NULL if none. The entry's address is returned in symAddr
+    const char*	findNearest(ADDRESS a, ADDRESS& symAddr);
+    // Make room for n entries, before adding many at once
+    void		reserve(unsigned n);
+    unsigned	size()
+    {
+        return syms.size();
+    }
+    // Iterate in address order. Adding an entry invalidates the iterators
+    iterator	begin();
+    iterator	end();
+    iterator	lowerBound(ADDRESS a);			// The first entry at or after a
+    // All the entries as a map from address to name. This is a copy, remade after any change to the table
+    std::map<ADDRESS, std::string>& getAll();
+};
+
+#ifndef NULL
+#define NULL 0          // Normally in stdio.h, it seems!
+#endif
+
+#endif  // __SYMTAB_H__
@@ -452,6 +452,7 @@ public:
     }
 
     void		getStatements(StatementList &stmts);
+    void		getStatements(StatementVec &stmts);
 
     /**
      * Get the statement number for the first BB as a character array.
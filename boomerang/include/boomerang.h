@@ -42,6 +42,7 @@
 #include <map>
 
 #include "types.h"
+#include "lock.h"
 
 class Log;
 class Prog;
@@ -122,6 +123,9 @@ private:
     Log			*logger;
     /// The watchers which are interested in this decompilation.
     std::set<Watcher*> watchers;
+    /// Held while the watchers are alerted, since code generation threads alert them too. Recursive, in case a
+    /// watcher's alert causes another.
+    Mutex		watchersMutex;
 
 
     /* Documentation about a function should be at one place only
@@ -134,6 +138,9 @@ private:
     int			splitLine(char *line, char ***pargv);
     int			parseCmd(int argc, const char **argv);
     int			cmdLine();
+    int			serve(const char *socketPath);
+    int			runJob(int fd, int job);
+    int			batch(int numInputs, const char **inputs);
 
 
     Boomerang();
@@ -188,6 +195,7 @@ public:
     /// Add a Watcher to the set of Watchers for this Boomerang object.
     void		addWatcher(Watcher *watcher)
     {
+        Lock lock(watchersMutex);
         watchers.insert(watcher);
     }
     void		persistToXML(Prog *prog);
@@ -198,105 +206,124 @@ public:
     /// Alert the watchers that decompilation has completed.
     void		alert_complete()
     {
+        Lock lock(watchersMutex);
         for (std::set<Watcher*>::iterator it = watchers.begin(); it != watchers.end(); it++)
             (*it)->alert_complete();
     }
     /// Alert the watchers we have found a new %Proc.
     void		alert_new(Proc *p)
     {
+        Lock lock(watchersMutex);
         for (std::set<Watcher*>::iterator it = watchers.begin(); it != watchers.end(); it++)
             (*it)->alert_new(p);
     }
     /// Alert the watchers we have removed a %Proc.
     void		alert_remove(Proc *p)
     {
+        Lock lock(watchersMutex);
         for (std::set<Watcher*>::iterator it = watchers.begin(); it != watchers.end(); it++)
             (*it)->alert_remove(p);
     }
     /// Alert the watchers we have updated this Procs signature
     void		alert_update_signature(Proc *p)
     {
+        Lock lock(watchersMutex);
         for (std::set<Watcher*>::iterator it = watchers.begin(); it != watchers.end(); it++)
             (*it)->alert_update_signature(p);
     }
     /// Alert the watchers we are currently decoding \a nBytes bytes at address \a pc.
     void		alert_decode(ADDRESS pc, int nBytes)
     {
+        Lock lock(watchersMutex);
         for (std::set<Watcher*>::iterator it = watchers.begin(); it != watchers.end(); it++)
             (*it)->alert_decode(pc, nBytes);
     }
     /// Alert the watchers of a bad decode of an instruction at \a pc.
     void		alert_baddecode(ADDRESS pc)
     {
+        Lock lock(watchersMutex);
         for (std::set<Watcher*>::iterator it = watchers.begin(); it != watchers.end(); it++)
             (*it)->alert_baddecode(pc);
     }
     /// Alert the watchers we have succesfully decoded this function
     void		alert_decode(Proc *p, ADDRESS pc, ADDRESS last, int nBytes)
     {
+        Lock lock(watchersMutex);
         for (std::set<Watcher*>::iterator it = watchers.begin(); it != watchers.end(); it++)
             (*it)->alert_decode(p, pc, last, nBytes);
     }
     /// Alert the watchers we have loaded the Proc.
     void		alert_load(Proc *p)
     {
+        Lock lock(watchersMutex);
         for (std::set<Watcher*>::iterator it = watchers.begin(); it != watchers.end(); it++)
             (*it)->alert_load(p);
     }
     /// Alert the watchers we are starting to decode.
     void		alert_start_decode(ADDRESS start, int nBytes)
     {
+        Lock lock(watchersMutex);
         for (std::set<Watcher*>::iterator it = watchers.begin(); it != watchers.end(); it++)
             (*it)->alert_start_decode(start, nBytes);
     }
     /// Alert the watchers we finished decoding.
     void		alert_end_decode()
     {
+        Lock lock(watchersMutex);
         for (std::set<Watcher*>::iterator it = watchers.begin(); it != watchers.end(); it++)
             (*it)->alert_end_decode();
     }
     virtual	void		alert_start_decompile(UserProc *p)
     {
+        Lock lock(watchersMutex);
         for (std::set<Watcher*>::iterator it = watchers.begin(); it != watchers.end(); it++)
             (*it)->alert_start_decompile(p);
     }
     virtual void		alert_proc_status_change(UserProc *p)
     {
+        Lock lock(watchersMutex);
         for (std::set<Watcher*>::iterator it = watchers.begin(); it != watchers.end(); it++)
             (*it)->alert_proc_status_change(p);
     }
     virtual	void		alert_decompile_SSADepth(UserProc *p, int depth)
     {
+        Lock lock(watchersMutex);
         for (std::set<Watcher*>::iterator it = watchers.begin(); it != watchers.end(); it++)
             (*it)->alert_decompile_SSADepth(p, depth);
     }
     virtual	void		alert_decompile_beforePropagate(UserProc *p, int depth)
     {
+        Lock lock(watchersMutex);
         for (std::set<Watcher*>::iterator it = watchers.begin(); it != watchers.end(); it++)
             (*it)->alert_decompile_beforePropagate(p, depth);
     }
     virtual void		alert_decompile_afterPropagate(UserProc *p, int depth)
     {
+        Lock lock(watchersMutex);
         for (std::set<Watcher*>::iterator it = watchers.begin(); it != watchers.end(); it++)
             (*it)->alert_decompile_afterPropagate(p, depth);
     }
     virtual void		alert_decompile_afterRemoveStmts(UserProc *p, int depth)
     {
+        Lock lock(watchersMutex);
         for (std::set<Watcher*>::iterator it = watchers.begin(); it != watchers.end(); it++)
             (*it)->alert_decompile_afterRemoveStmts(p, depth);
     }
     virtual void		alert_end_decompile(UserProc *p)
     {
+        Lock lock(watchersMutex);
         for (std::set<Watcher*>::iterator it = watchers.begin(); it != watchers.end(); it++)
             (*it)->alert_end_decompile(p);
     }
     virtual void		alert_considering(Proc *parent, Proc *p)
     {
+        Lock lock(watchersMutex);
         for (std::set<Watcher*>::iterator it = watchers.begin(); it != watchers.end(); it++)
             (*it)->alert_considering(parent, p);
     }
     virtual void		alert_decompiling(UserProc *p)
     {
+        Lock lock(watchersMutex);
         for (std::set<Watcher*>::iterator it = watchers.begin(); it != watchers.end(); it++)
             (*it)->alert_decompiling(p);
     }
@@ -348,9 +375,12 @@ public:
     bool		loadBeforeDecompile;
     bool		saveBeforeDecompile;
     bool		noProve;
+    unsigned	proofStepLimit;		///< Max prover steps for one proof, or 0 for no limit (-ps)
+    unsigned	proofTimeLimit;		///< Max milliseconds of processor time for one proof, or 0 for no limit (-pt)
     bool		noChangeSignatures;
     bool		conTypeAnalysis;
     bool		dfaTypeAnalysis;
+    bool		useTransformations;	///< Apply the rules in transformations/*.t when simplifying (-Tr)
     int			propMaxDepth;		///< Max depth of expression that will be propagated to more than one dest
     bool		generateCallGraph;
     bool		generateSymbols;
@@ -358,6 +388,15 @@ public:
     bool		assumeABI;			///< Assume ABI compliance
     bool		experimental;		///< Activate experimental code. Caution!
     int			minsToStopAfter;
+    int			codeGenThreads;		///< Number of threads to generate code with (experimental)
+    /// The file to which performance statistics (phase times, peak memory, IR sizes) are written, or NULL
+    const char	*statsFile;
+    const char	*serviceSocket;		///< The UNIX socket to accept decompile jobs on (-K), or NULL
+    int			serviceJobs;		///< Max number of service jobs running at once (-Kj)
+    unsigned	serviceTimeLimit;	///< Seconds after which a service job is killed, or 0 for no limit (-Kt)
+    unsigned	serviceMemLimit;	///< Megabytes of address space a service job may use, or 0 for no limit (-Km)
+    int			scanThreads;		///< Threads to scan the code for procs with before decompiling (-F), or 0 not to
+    int			batchJobs;			///< Max number of programs decompiled at once in batch mode (-b), or 0 if not
 };
 
 #define VERBOSE				(Boomerang::get()->vFlag)
@@ -146,6 +146,11 @@ public:
      */
     void		clear();
 
+    /*
+     * Tell the owning UserProc (if any) that statements or BBs have been added, removed or reordered
+     */
+    void		invalidateStatements();
+
     /*
      * Get the number of BBs
      */
@@ -0,0 +1,69 @@
+/*
+ * See the file "LICENSE.TERMS" for information on usage and
+ * redistribution of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+/*==============================================================================
+ * FILE:	   dataindex.h
+ * OVERVIEW:   Definition of DataIndex, an index of the strings and pointers in the sections of a BinaryFile.
+ *============================================================================*/
+/*
+ * $Revision$
+ *
+ * The sections are scanned once, when the index is made; after that, asking whether there is a string or a pointer at
+ * an address is a binary search. Strings are found by searching for their terminating NULs with memchr, then going
+ * back over the text before each one. Pointers are the aligned words whose value is an address in one of the sections.
+ */
+
+#ifndef __DATAINDEX_H__
+#define __DATAINDEX_H__
+
+#include <vector>
+#include <utility>
+#include "types.h"
+
+class BinaryFile;
+
+class DataIndex
+{
+    struct Run
+    {
+        ADDRESS		start;
+        ADDRESS		end;				// Address of the terminating NUL
+    };
+    std::vector<Run> strings;			// Runs of text ending in a NUL, in address order
+    std::vector<Run> wideStrings;		// Runs of UTF-16 text ending in a 16 bit NUL, in address order
+    // The aligned words that point into a section, and what they point to, in address order
+    std::vector<std::pair<ADDRESS, ADDRESS> > pointers;
+    std::vector<Run> sections;			// The sections that were scanned, in address order (end is one past)
+    ADDRESS		codeLo, codeHi;			// Limits of the code
+    bool		bigEndian;				// Byte order of the words in the sections
+    BinaryFile	*pBF;
+
+    void		scanStrings(const unsigned char *p, ADDRESS lo, unsigned size);
+    void		scanWideStrings(const unsigned char *p, ADDRESS lo, unsigned size);
+    void		scanPointers(const unsigned char *p, ADDRESS lo, unsigned size);
+    bool		findByteOrder();
+    bool		inSection(ADDRESS a);
+    static bool	runLess(const Run &x, const Run &y);
+    static bool	findRun(std::vector<Run> &runs, ADDRESS a, Run &run);
+
+public:
+    DataIndex(BinaryFile *pBF);
+
+    // If a is in a run of text ending in a NUL, return true and set len to the number of characters from a to the NUL
+    bool		stringAt(ADDRESS a, unsigned &len);
+    // As above for UTF-16 text (at least 4 characters); len is in characters
+    bool		wideStringAt(ADDRESS a, unsigned &len);
+    // If the aligned word at a points into a section, return true and set target to the address it points to
+    bool		pointerAt(ADDRESS a, ADDRESS &target);
+    // The number of words, up to max, from a on that point into the code
+    int			codePointerRun(ADDRESS a, int max);
+    bool		isBigEndian()
+    {
+        return bigEndian;
+    }
+};
+
+#endif
@@ -45,6 +45,7 @@
 //#include "statement.h"	// For StmtSet etc
 #include "exphelp.h"
 #include "memo.h"
+#include "lock.h"		// For HAVE_THREADS
 
 class UseSet;
 class DefSet;
@@ -77,14 +78,23 @@ class Exp
 {
 protected:
     OPER		op;			   // The operator (e.g. opPlus)
+    bool		simplified;	   // True if simplify() left this node in normal form and it has not been changed since
 
     unsigned	lexBegin, lexEnd;
 
     // Constructor, with ID
-    Exp(OPER op) : op(op)
-    {}
+    Exp(OPER op) : op(op), simplified(false)
+    {
+#if HAVE_THREADS
+        __sync_fetch_and_add(&numCreated, 1);	// Exps are made on the code generation threads too
+#else
+        numCreated++;
+#endif
+    }
 
 public:
+    static unsigned long numCreated;	// Number of Exps created so far (for the -B statistics)
+
     // Virtual destructor
     virtual				~Exp()
     {}
@@ -98,8 +108,25 @@ public:
     void		setOper(OPER x)
     {
         op = x;    // A few simplifications use this
+        simplified = false;
     }
 
+    // The known-simplified flag. simplify() sets it on every node of its result, and anything that changes a node
+    // clears it on that node. An expression is only known to be simplified if the flag is set on all of its nodes,
+    // since a child can be changed without its parent knowing
+    bool		isSimplified();
+    void		clearSimplified()
+    {
+        simplified = false;
+    }
+protected:
+    void		setSimplified();
+public:
+
+    // A hash of the operators and constants of this expression. Expressions that are equal (with no wildcards) have
+    // the same hash
+    unsigned	hash();
+
     void		setLexBegin(unsigned int n)
     {
         lexBegin = n;
@@ -362,8 +389,8 @@ public:
     // NULL
     virtual Exp			*match(Exp *pattern);
 
-    // match a string pattern
-    virtual bool 		match(const char *pattern, std::map<std::string, Exp*> &bindings);
+    // match a string pattern (see exppattern.h). The pattern is parsed the first time it is seen
+    bool 		match(const char *pattern, std::map<std::string, Exp*> &bindings);
 
     //	//	//	//	//	//	//
     //	Search and Replace	//
@@ -623,25 +650,30 @@ public:
     void		setInt(int i)
     {
         u.i = i;
+        simplified = false;
     }
 #ifndef _MSC_VER
     void		setLong(long unsigned long ll)
     {
         u.ll = ll;
+        simplified = false;
     }
 #else
     void		setLong(unsigned __int64 ll)
     {
         u.ll = ll;
+        simplified = false;
     }
 #endif
     void		setFlt(double d)
     {
         u.d = d;
+        simplified = false;
     }
     void		setStr(const char* p)
     {
         u.p = p;
+        simplified = false;
     }
     void		setAddr(ADDRESS a)
     {
@@ -650,6 +682,7 @@ public:
 #elif SIZEOF_INT_P == 8
 		u.ll = a;
 #endif
+        simplified = false;
     }
 
     // Get and set the type
@@ -660,6 +693,7 @@ public:
     void		setType(Type* ty)
     {
         type = ty;
+        simplified = false;
     }
 
     virtual void		print(std::ostream& os, bool html = false);
@@ -675,7 +709,6 @@ public:
     virtual bool		accept(ExpVisitor* v);
     virtual Exp*		accept(ExpModifier* v);
 
-    virtual bool 		match(const char *pattern, std::map<std::string, Exp*> &bindings);
 
     int			getConscript()
     {
@@ -728,7 +761,6 @@ public:
     virtual	Type*		ascendType();
     virtual void		descendType(Type* parentType, bool& ch, Statement* s);
 
-    virtual bool 		match(const char *pattern, std::map<std::string, Exp*> &bindings);
 
 protected:
     friend class XMLProgParser;
@@ -778,6 +810,7 @@ public:
     void		setSubExp1ND(Exp* e)
     {
         subExp1 = e;
+        simplified = false;
     }
     // Get first subexpression
     Exp*		getSubExp1();
@@ -785,7 +818,6 @@ public:
     Exp*&		refSubExp1();
 
     virtual Exp*		match(Exp *pattern);
-    virtual bool 		match(const char *pattern, std::map<std::string, Exp*> &bindings);
 
     // Search children
     void 			doSearchChildren(Exp* search, std::list<Exp**>& li, bool once);
@@ -861,7 +893,6 @@ public:
     Exp*&		refSubExp2();
 
     virtual Exp*		match(Exp *pattern);
-    virtual bool 		match(const char *pattern, std::map<std::string, Exp*> &bindings);
 
     // Search children
     void		doSearchChildren(Exp* search, std::list<Exp**>& li, bool once);
@@ -950,7 +981,6 @@ public:
     virtual bool	accept(ExpVisitor* v);
     virtual Exp*	accept(ExpModifier* v);
 
-    virtual bool 		match(const char *pattern, std::map<std::string, Exp*> &bindings);
 
     virtual	Type*	ascendType();
     virtual void	descendType(Type* parentType, bool& ch, Statement* s);
@@ -1000,6 +1030,7 @@ public:
     virtual void		setType(Type* ty)
     {
         type = ty;
+        simplified = false;
     }
 
     // polySimplify
@@ -1075,11 +1106,13 @@ public:
     Exp*		addSubscript(Statement* def)
     {
         this->def = def;
+        simplified = false;
         return this;
     }
     void		setDef(Statement* def)
     {
         this->def = def;
+        simplified = false;
     }
     virtual Exp*		genConstraints(Exp* restrictTo);
     bool		references(Statement* s)
@@ -1088,7 +1121,6 @@ public:
     }
     virtual Exp*		polySimplify(bool& bMod);
     virtual Exp			*match(Exp *pattern);
-    virtual bool 		match(const char *pattern, std::map<std::string, Exp*> &bindings);
 
     // Before type analysis, implicit definitions are NULL.  During and after TA, they point to an implicit
     // assignment statement.  Don't implement here, since it would require #including of statement.h
@@ -1127,6 +1159,7 @@ public:
     virtual void		setType(Type* t)
     {
         val = t;
+        simplified = false;
     }
     virtual Exp*		clone();
     virtual bool		operator==(const Exp& o) const;
@@ -1204,7 +1237,6 @@ public:
     // Visitation
     virtual bool		accept(ExpVisitor* v);
     virtual Exp*		accept(ExpModifier* v);
-    virtual bool 		match(const char *pattern, std::map<std::string, Exp*> &bindings);
 
 protected:
     friend class XMLProgParser;
@@ -0,0 +1,89 @@
+/*
+ * See the file "LICENSE.TERMS" for information on usage and
+ * redistribution of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+/*==============================================================================
+ * FILE:	   exppattern.h
+ * OVERVIEW:   Definition of ExpPattern, an expression pattern that is compiled once and then matched by walking the
+ *				expression tree directly.
+ *============================================================================*/
+/*
+ * $Revision$
+ *
+ * A pattern is written as an ordinary expression with wildcards in it:
+ *	opWild						matches anything
+ *	opWildIntConst				matches any integer constant
+ *	opWildStrConst				matches any string constant
+ *	opWildMemOf, opWildRegOf, opWildAddrOf	match any m[...], r[...] and a[...]
+ *	opVar "name"				matches anything; every occurrence of the same name must match the same expression
+ * It can also be given as a string in the form that Exp::match(const char*, ...) has always taken, e.g. "m[x + 4]{-}"
+ * or "a[y].member"; there every identifier is a named wildcard.
+ * Patterns given as expressions ignore subscripts by default, like operator*=. The subexpressions that the wildcards
+ * matched are returned in preorder (the order they appear in the printed pattern), unstripped of any subscripts.
+ */
+
+#ifndef __EXPPATTERN_H__
+#define __EXPPATTERN_H__
+
+#include <vector>
+#include <map>
+#include <string>
+#include "exp.h"
+
+class ExpPattern
+{
+    enum Kind
+    {
+        PAT_OPER,					// Operator must match, then the arity subpatterns that follow
+        PAT_WILD,					// Matches anything
+        PAT_WILDOPER,				// Matches anything with the operator (e.g. opWildMemOf matches any opMemOf)
+        PAT_INTCONST,				// A particular integer constant
+        PAT_FLTCONST,				// A particular floating point constant
+        PAT_STRCONST,				// A particular string constant
+        PAT_TYPEDEXP,				// A TypedExp with a particular type, then the subpattern
+        PAT_REF,					// A subscript with a definition of a particular number (-1 for none), then the
+                                    // subpattern. Only when subscripts are not ignored
+        PAT_TEXT					// Anything that prints as the given text (for string patterns that can't be parsed)
+    };
+    struct Node
+    {
+        Kind		kind;
+        OPER		op;
+        int			arity;			// PAT_OPER: number of subpatterns
+        int			i;				// Integer constant, or definition number
+        double		d;				// Floating point constant
+        std::string	s;				// String constant or text
+        Type		*type;			// PAT_TYPEDEXP
+        int			var;			// Wildcards: index of the binding, or -1 if not bound (always -1 for PAT_OPER)
+    };
+    std::vector<Node> code;			// The pattern in preorder
+    std::vector<std::string> names;	// Names of the bindings; "" for anonymous wildcards
+    bool		ignoreSubscripts;
+
+    void		compile(Exp *pattern);
+    void		parse(const char *pattern);
+    int			addBinding(const std::string &name);
+    bool		matchAt(unsigned &pc, Exp *e, std::vector<Exp*> &bindings);
+
+public:
+    // Compile a pattern expression
+    ExpPattern(Exp *pattern, bool ignoreSubscripts = true);
+    // Parse a pattern string (subscripts are never ignored)
+    ExpPattern(const char *pattern);
+
+    // Return true if e matches. The subexpressions matched by the wildcards are put in bindings, in preorder
+    bool		match(Exp *e);
+    bool		match(Exp *e, std::vector<Exp*> &bindings);
+    // As above, but the named wildcards are added to bindings by name
+    bool		match(Exp *e, std::map<std::string, Exp*> &bindings);
+
+    // The number of wildcards in the pattern (so the size of the bindings after a match)
+    unsigned	getNumBindings()
+    {
+        return names.size();
+    }
+};
+
+#endif
@@ -29,6 +29,8 @@
 
 #include <list>
 #include <map>
+#include <set>
+#include <vector>
 #include <queue>
 #include <fstream>
 #include "types.h"
@@ -121,10 +123,21 @@ protected:
     TargetQueue	targetQueue;
     // Public map from function name (string) to signature.
     std::map<std::string, Signature*> librarySignatures;
+    // Default signatures made for library functions that are not in the catalog, by name
+    std::map<std::string, Signature*> defaultSignatures;
     // Map from address to meaningful name
     std::map<ADDRESS, std::string> refHints;
     // Map from address to previously decoded RTLs for decoded indirect control transfer instructions
     std::map<ADDRESS, RTL*> previouslyDecoded;
+    // Pristine copies of the instructions decoded in procs with indirect jumps or calls. Those procs are decoded again
+    // once the jumps are analysed, and then only the newly reachable code needs to go through the decoder
+    std::map<ADDRESS, DecodeResult*> decodeCache;
+    std::set<ADDRESS> noDecodeCache;		// Instructions that decode differently each time (e.g. Pentium BSF)
+    std::vector<ADDRESS> newlyCached;		// Added to decodeCache by the processProc calls in progress
+    std::map<UserProc*, std::vector<ADDRESS> > procCached;	// The instructions in decodeCache kept for each proc
+    DecodeResult *cachedResult;				// What decodeInstruction returns for a cached instruction
+
+    void		keepDecodeCache(unsigned first, UserProc *pProc, Cfg *pCfg);
 public:
     /*
      * Constructor. Takes some parameters to save passing these around a lot
@@ -177,6 +190,10 @@ public:
     virtual	int			getInst(int addr);
 
     virtual DecodeResult& decodeInstruction(ADDRESS pc);
+    // Return a copy of an instruction from the decode cache, as decodeInstruction does (public for MicroBench)
+    DecodeResult& reuseDecoded(DecodeResult &cached);
+    // Free the cached instructions of a proc that will not be decoded again
+    void		dropDecodeCache(UserProc *pProc);
 
     virtual void extraProcessCall(CallStatement *call, std::list<RTL*> *BB_rtls)
     { }
@@ -198,6 +215,11 @@ public:
     // read from default catalog
     void		readLibraryCatalog();
 
+    // If set, the signatures parsed from each file are kept, and reading the same file again reuses them
+    static bool	keepSignatures;
+    // Parse every platform's SSL file and library catalogs now, and keep them, for the jobs of a service
+    static void	warmCaches();
+
     // lookup a library signature by name
     Signature	*getLibSignature(const char *name);
 
@@ -249,6 +271,26 @@ public:
      */
     std::vector<ADDRESS> getEntryPoints();
 
+    /*
+     * Vote for the addresses in [lo, hi) of a code section [sectLo, sectHi) that look like the start of a proc,
+     * e.g. because of a prologue there, or a call to there. code is the host address of sectLo. Called for several
+     * chunks of the code at once (in different threads), so it must only change votes
+     */
+    virtual void		scanForProcs(const unsigned char *code, ADDRESS sectLo, ADDRESS sectHi, ADDRESS lo, ADDRESS hi,
+                                     std::map<ADDRESS, int> &votes)
+    {}
+
+    /*
+     * Scan all the code with scanForProcs, in numThreads threads, and return the likely procs, most likely first
+     */
+    std::vector<ADDRESS> findProcCandidates(int numThreads);
+
+    /*
+     * Decode the likely procs found by findProcCandidates that are not already procs or in decoded code.
+     * Returns the number decoded
+     */
+    int			decodeProcCandidates(Prog *prog, int numThreads);
+
     /*
      * getInstanceFor. Get an instance of a class derived from FrontEnd, returning a pointer to the object of
      * that class. Do this by guessing the machine for the binary file whose name is sName, loading the
@@ -125,6 +125,8 @@ public:
     virtual void	AddProcEnd() = 0;
     virtual void	AddLocal(const char *name, Type *type, bool last = false) = 0;
     virtual void	AddGlobal(const char *name, Type *type, Exp *init = NULL) = 0;
+    // A global array of bytes, initialised straight from the given bytes (e.g. a whole data section)
+    virtual void	AddGlobalBytes(const char *name, const unsigned char *bytes, unsigned size) = 0;
     virtual void	AddPrototype(UserProc* proc) = 0;
 
     // comments
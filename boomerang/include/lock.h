@@ -0,0 +1,129 @@
+/*
+ * See the file "LICENSE.TERMS" for information on usage and
+ * redistribution of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+/*==============================================================================
+ * FILE:	   lock.h
+ * OVERVIEW:   Definition of Mutex, Condition and Lock, for the state that the code generation (-j) and scan (-F)
+ *			   threads share.
+ *============================================================================*/
+/*
+ * $Revision$
+ *
+ * Threads are only used where pthreads are available and the garbage collector is not, since the collector would have
+ * to be told about every thread. Elsewhere HAVE_THREADS is 0, and a Mutex does nothing.
+ */
+
+#ifndef __LOCK_H__
+#define __LOCK_H__
+
+#if !defined(_WIN32) && defined(NO_GARBAGE_COLLECTOR)
+#define HAVE_THREADS 1
+#include <pthread.h>
+#define THREAD_LOCAL	__thread		// One copy of the variable for each thread
+#else
+#define HAVE_THREADS 0
+#define THREAD_LOCAL
+#endif
+
+class Mutex
+{
+#if HAVE_THREADS
+    pthread_mutex_t mutex;
+    friend class Condition;
+#endif
+    Mutex(const Mutex&);				// Not copyable
+    Mutex &operator=(const Mutex&);
+
+public:
+#if HAVE_THREADS
+    // A recursive mutex can be locked again by the thread that holds it (e.g. by a callback)
+    Mutex(bool recursive = false)
+    {
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        if (recursive)
+            pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+        pthread_mutex_init(&mutex, &attr);
+        pthread_mutexattr_destroy(&attr);
+    }
+    ~Mutex()
+    {
+        pthread_mutex_destroy(&mutex);
+    }
+    void		lock()
+    {
+        pthread_mutex_lock(&mutex);
+    }
+    void		unlock()
+    {
+        pthread_mutex_unlock(&mutex);
+    }
+#else
+    Mutex(bool recursive = false)
+    {}
+    void		lock()
+    {}
+    void		unlock()
+    {}
+#endif
+};
+
+// Lets a thread wait, with a Mutex held, until another thread signals that something has changed
+class Condition
+{
+#if HAVE_THREADS
+    pthread_cond_t cond;
+#endif
+    Condition(const Condition&);
+    Condition &operator=(const Condition&);
+
+public:
+#if HAVE_THREADS
+    Condition()
+    {
+        pthread_cond_init(&cond, NULL);
+    }
+    ~Condition()
+    {
+        pthread_cond_destroy(&cond);
+    }
+    void		wait(Mutex &mutex)		// mutex must be held; it is released while waiting
+    {
+        pthread_cond_wait(&cond, &mutex.mutex);
+    }
+    void		broadcast()
+    {
+        pthread_cond_broadcast(&cond);
+    }
+#else
+    Condition()
+    {}
+    void		wait(Mutex &mutex)
+    {}
+    void		broadcast()
+    {}
+#endif
+};
+
+// Holds a Mutex for as long as it is in scope
+class Lock
+{
+    Mutex		&mutex;
+    Lock(const Lock&);
+    Lock &operator=(const Lock&);
+
+public:
+    Lock(Mutex &mutex) : mutex(mutex)
+    {
+        mutex.lock();
+    }
+    ~Lock()
+    {
+        mutex.unlock();
+    }
+};
+
+#endif
@@ -3,7 +3,10 @@
 #define LOG_H
 
 #include "types.h"
+#include "lock.h"
 #include <fstream>
+#include <string>
+#include <map>
 
 class Statement;
 class Exp;
@@ -50,16 +53,16 @@ class FileLogger : public Log
 {
 protected:
     std::ofstream out;
+    Mutex	mutex;		// The code generation threads log too
+#if HAVE_THREADS
+    pthread_t	mainThread;		// The thread that made the logger
+    std::map<pthread_t, std::string> pending;	// Each other thread's text since its last newline
+#endif
 public:
     FileLogger();		// Implemented in boomerang.cpp
     void	tail();
-    virtual Log &operator<<(const char *str)
-    {
-        out << str << std::flush;
-        return *this;
-    }
-    virtual ~FileLogger()
-    {};
+    virtual Log &operator<<(const char *str);
+    virtual ~FileLogger();
 };
 class NullLogger : public Log
 {
@@ -10,7 +10,8 @@
 /*===============================================================================================
  * FILE:	   managed.h
  * OVERVIEW:   Definition of "managed" classes such as StatementSet, which feature makeUnion etc
- * CLASSES:		StatementSet
+ * CLASSES:		SparseBitSet
+ *				StatementSet
  *				AssignSet
  *				StatementList
  *				StatementVec
@@ -23,6 +24,7 @@
  * $Revision$	// 1.11.2.15
  *
  * 26/Aug/03 - Mike: Split off from statement.h
+ * 18/Oct/26 - Added SparseBitSet, optionally used to implement StatementSet
  */
 
 #ifndef __MANAGED_H__
@@ -30,7 +32,9 @@
 
 #include <list>
 #include <set>
+#include <map>
 #include <vector>
+#include <deque>
 
 #include "exphelp.h"		// For lessExpStar
 
@@ -40,14 +44,155 @@ class Exp;
 class RefExp;
 class Cfg;
 class LocationSet;
+class StatementVec;
+class BasicBlock;
+
+// Set true to implement StatementSet with a SparseBitSet over statement indexes, instead of a std::set
+#ifndef USE_BITSET_STATEMENTSET
+#define USE_BITSET_STATEMENTSET 0
+#endif
+
+// A set of small unsigned integers, stored as a sorted vector of fixed size chunks of bits. Only chunks with at least
+// one bit set are stored, so a set of numbers that are close together is compact no matter how large the numbers are.
+// The set operations work a chunk at a time; the inner loops over the words of a chunk are simple enough for the
+// compiler to vectorise.
+class SparseBitSet
+{
+public:
+    typedef unsigned long word;
+    enum { WORD_BITS = sizeof(word) * 8, CHUNK_WORDS = 4, CHUNK_BITS = WORD_BITS * CHUNK_WORDS };
+    struct Chunk
+    {
+        unsigned	base;								// Index of this chunk, i.e. first element / CHUNK_BITS
+        word		bits[CHUNK_WORDS];
+    };
+
+    // Iterates through the elements in increasing order
+    class iterator
+    {
+        const std::vector<Chunk>* chunks;
+        unsigned	ci;									// Index into chunks
+        unsigned	bit;								// Bit number within the chunk
+        void		advance();							// Move to the first set bit at or after (ci, bit)
+    public:
+        iterator() : chunks(NULL), ci(0), bit(0) {}
+        iterator(const std::vector<Chunk>* c, unsigned ci, unsigned bit) : chunks(c), ci(ci), bit(bit)
+        {
+            advance();
+        }
+        unsigned	operator*() const
+        {
+            return (*chunks)[ci].base * CHUNK_BITS + bit;
+        }
+        iterator&	operator++()
+        {
+            bit++;
+            advance();
+            return *this;
+        }
+        iterator	operator++(int)
+        {
+            iterator ret = *this;
+            ++*this;
+            return ret;
+        }
+        bool		operator==(const iterator& o) const
+        {
+            return ci == o.ci && bit == o.bit;
+        }
+        bool		operator!=(const iterator& o) const
+        {
+            return !(*this == o);
+        }
+    };
+
+private:
+    std::vector<Chunk> chunks;							// Sorted by base; no chunk is all zeroes
+    unsigned	findChunk(unsigned base) const;			// Index of first chunk with base >= given base
+
+public:
+    void		makeUnion(const SparseBitSet& other);	// Set union
+    void		makeDiff (const SparseBitSet& other);	// Set difference
+    void		makeIsect(const SparseBitSet& other);	// Set intersection
+    bool		isSubSetOf(const SparseBitSet& other) const;	// Subset relation
+
+    bool		insert(unsigned n);						// Insertion; rets false if already present
+    bool		remove(unsigned n);						// Removal; rets false if not found
+    bool		exists(unsigned n) const;				// Search; returns false if !found
+    unsigned	size() const;							// Number of elements (counts bits)
+    bool		empty() const
+    {
+        return chunks.empty();
+    }
+    void		clear()
+    {
+        chunks.clear();
+    }
+    iterator	begin() const
+    {
+        return iterator(&chunks, 0, 0);
+    }
+    iterator	end() const
+    {
+        return iterator(&chunks, chunks.size(), 0);
+    }
+    bool		operator==(const SparseBitSet& o) const;
+    bool		operator<(const SparseBitSet& o) const;	// Arbitrary but consistent ordering
+};
 
 // A class to implement sets of statements
 class StatementSet
 {
+#if USE_BITSET_STATEMENTSET
+    SparseBitSet sset;									// Bits are indexes from StatementSet::indexOf
+
+    // The statement with each index, or NULL if the index is free. Index 0 is for a NULL Statement*. A deque, so that
+    // growing it never moves the entries; all access is under a lock, since the -j threads can add and remove
+    static std::deque<Statement*> statements;
+    static std::vector<unsigned> freeIndexes;			// Indexes of deleted statements, for reuse
+    static unsigned	indexOf(Statement* s);				// Get the index for s, allocating one if needed
+    static bool		findIndex(Statement* s, unsigned& n);	// Get the index for s if it has one
+    static Statement* statementAt(unsigned n);			// The statement with index n
+
+public:
+    static const unsigned NO_INDEX = ~0U;				// Statement::setIndex before s is first inserted
+    static void	releaseIndex(unsigned n);				// s with index n is being deleted
+    class iterator
+    {
+        SparseBitSet::iterator it;
+    public:
+        iterator() {}
+        iterator(const SparseBitSet::iterator& it) : it(it) {}
+        Statement*	operator*() const
+        {
+            return statementAt(*it);
+        }
+        iterator&	operator++()
+        {
+            ++it;
+            return *this;
+        }
+        iterator	operator++(int)
+        {
+            iterator ret = *this;
+            ++it;
+            return ret;
+        }
+        bool		operator==(const iterator& o) const
+        {
+            return it == o.it;
+        }
+        bool		operator!=(const iterator& o) const
+        {
+            return it != o.it;
+        }
+    };
+#else
     std::set<Statement*> sset;							// For now, use use standard sets
 
 public:
     typedef std::set<Statement*>::iterator iterator;
+#endif
 
     ~StatementSet()
     {}
@@ -69,10 +214,17 @@ public:
         return sset.end();
     }
 
+#if USE_BITSET_STATEMENTSET
+    void		insert(Statement* s)
+    {
+        sset.insert(indexOf(s));    // Insertion
+    }
+#else
     void		insert(Statement* s)
     {
         sset.insert(s);    // Insertion
     }
+#endif
     bool		remove(Statement* s);					// Removal; rets false if not found
     bool		removeIfDefines(Exp* given);			// Remove if given exp is defined
     bool		removeIfDefines(StatementSet& given);	// Remove if any given is def'd
@@ -197,6 +349,7 @@ public:
     }
     void		append(StatementList& sl);			// Append whole StatementList
     void		append(StatementSet& sl);			// Append whole StatementSet
+    void		append(StatementVec& sv);			// Append whole StatementVec
     bool		remove(Statement* s);				// Removal; rets false if not found
     void		removeDefOf(Exp* loc);				// Remove definitions of loc
     // This one is needed where you remove in the middle of a loop
@@ -281,6 +434,14 @@ public:
     {
         svec.push_back(s);
     }
+    void		append(StatementVec& sv)
+    {
+        svec.insert(svec.end(), sv.svec.begin(), sv.svec.end());    // Append whole StatementVec
+    }
+    void		reserve(unsigned n)
+    {
+        svec.reserve(n);
+    }
     void		erase(iterator it)
     {
         svec.erase(it);
@@ -421,6 +582,52 @@ public:
     }
 };
 
+/// The results of range analysis for one procedure. Range analysis is only performed on request, so instead of every
+/// Statement carrying RangeMaps that are almost always empty, UserProc::rangeAnalysis() creates one of these for the
+/// duration of the analysis. It also holds the worklist of BBs still to be (re)processed.
+class RangeData
+{
+    std::map<Statement*, RangeMap> ranges;			// Overestimation of the ranges of locations after each statement
+    std::map<Statement*, RangeMap> branchRanges;	// As above, for the not taken edge of branches
+    std::set<BasicBlock*, bool(*)(BasicBlock*, BasicBlock*)> workList;	// In depth first order
+    int			bbVisits;						// Number of BBs taken from the worklist so far
+
+    static bool	lessWorkOrder(BasicBlock* bb1, BasicBlock* bb2);	// Order of the worklist
+
+public:
+    RangeData();
+
+    RangeMap	&getRanges(Statement* s)
+    {
+        return ranges[s];
+    }
+    void		setRanges(Statement* s, RangeMap &r)
+    {
+        ranges[s] = r;
+    }
+    RangeMap	&getBranchRanges(Statement* s)
+    {
+        return branchRanges[s];
+    }
+    void		setBranchRanges(Statement* s, RangeMap &r)
+    {
+        branchRanges[s] = r;
+    }
+
+    // The worklist. Adding a BB that is already waiting has no effect
+    void		addToWorkList(BasicBlock* bb)
+    {
+        workList.insert(bb);
+    }
+    BasicBlock*	nextFromWorkList();					// Remove and return the earliest BB, or NULL if none left
+    int			getNumVisits()
+    {
+        return bbVisits;
+    }
+
+    void		print(std::ostream &os, StatementVec &stmts);	// Print the ranges after each of stmts
+};
+
 /// A class to store connections in a graph, e.g. for interferences of types or live ranges, or the phi_unite relation
 /// that phi statements imply
 /// If a is connected to b, then b is automatically connected to a
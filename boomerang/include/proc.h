@@ -351,6 +351,66 @@ enum ProcStatus
 };
 
 typedef std::set <UserProc*> ProcSet;
+
+/// Statistics of the proof engine (UserProc::prove) over the whole program, e.g. for the -B statistics
+struct ProofStats
+{
+    unsigned	attempted;		///< Top level proofs attempted
+    unsigned	proven;			///< Top level proofs that succeeded
+    unsigned	outOfBudget;	///< Top level proofs given up because of the step or time limit (-ps, -pt)
+    unsigned	cacheHits;		///< Nested proofs answered from the proof cache
+    ProofStats() : attempted(0), proven(0), outOfBudget(0), cacheHits(0)
+    { }
+};
+
+/// The results of the nested proofs of a proof session (see UserProc::prove). A result depends on the proc, the query,
+/// and the premises assumed in all procs at the time, so a result is only used again when all three are exactly the
+/// same. The premises are compared by value, not by hash, since hashes ignore subscripts and types
+class ProofCache
+{
+    struct Premise
+    {
+        UserProc	*proc;
+        Exp			*lhs;
+        Exp			*rhs;
+    };
+    struct Entry
+    {
+        UserProc	*proc;
+        Exp			*query;
+        bool		conditional;
+        unsigned	generation;					///< The generation of the premises when the proof was started
+        std::vector<Premise> premises;			///< Copies of those premises
+        bool		result;
+    };
+    std::multimap<unsigned, Entry> entries;		///< Keyed by the hash of the query
+    std::vector<Premise> premises;				///< The premises assumed now, in the order they were assumed
+    unsigned	generation;						///< Changed whenever the premises change
+
+    bool		samePremises(const std::vector<Premise> &other);
+
+public:
+    /// The premises when a proof is started, to give to add() when it ends
+    class Snapshot
+    {
+        friend class ProofCache;
+        unsigned	generation;
+        std::vector<Premise> premises;
+    };
+
+    ProofCache() : generation(0)
+    { }
+    /// Assume lhs = rhs in proc, replacing any premise with the same lhs there
+    void		setPremise(UserProc *proc, Exp *lhs, Exp *rhs);
+    void		removePremise(UserProc *proc, Exp *lhs);
+    void		snapshot(Snapshot &snap);
+    /// If there is a result for query in proc under the current premises, set result to it and return true
+    bool		find(UserProc *proc, Exp *query, bool conditional, bool &result);
+    /// Remember the result of query in proc, proven under the premises in snap. query is kept, not copied
+    void		add(UserProc *proc, Exp *query, bool conditional, Snapshot &snap, bool result);
+    /// Forget all the results (the premises are kept)
+    void		clear();
+};
 typedef std::list<UserProc*> ProcList;
 
 /*==============================================================================
@@ -441,6 +501,17 @@ private:
      */
     int			stmtNumber;
 
+    /**
+     * Contiguous copy of all the statements of this procedure, in the same order as the BBs and RTLs hold them.
+     * The whole-procedure passes iterate this instead of walking the list of RTLs of every BB. It is rebuilt lazily;
+     * anything that adds, removes or reorders statements or BBs must call invalidateStatements().
+     */
+    StatementVec stmtCache;
+    bool		stmtCacheValid;
+
+    /// Rebuild stmtCache from the Cfg
+    void		updateStatementCache();
+
     /**
      * Pointer to a set of procedures involved in a recursion group.
      * NOTE: Each procedure in the cycle points to the same set! However, there can be several separate cycles.
@@ -588,8 +659,8 @@ public:
     void		insertCasts();
     // Range analysis (for this procedure).
     void		rangeAnalysis();
-    // Detect and log possible buffer overflows
-    void		logSuspectMemoryDefs();
+    // Detect and log possible buffer overflows, using the results of range analysis
+    void		logSuspectMemoryDefs(RangeData &rd);
     // Split the set of cycle-associated procs into individual subcycles.
     //void		findSubCycles(CycleList& path, CycleSet& cs, CycleSetSet& sset);
     // The inductive preservation analysis.
@@ -680,7 +751,7 @@ public:
     void		eliminateDuplicateArgs();
 
 private:
-    void		searchRegularLocals(OPER minusOrPlus, bool lastPass, int sp, StatementList& stmts);
+    void		searchRegularLocals(OPER minusOrPlus, bool lastPass, int sp, StatementVec& stmts);
 public:
     bool		removeNullStatements();
     bool		removeDeadStatements();
@@ -702,7 +773,6 @@ public:
 #endif
     void		propagateToCollector();
     void		clearUses();					///< Clear the useCollectors (in this Proc, and all calls).
-    void		clearRanges();
     //int		findMaxDepth();					///< Find max memory nesting depth.
 
     void		fromSSAform();
@@ -746,7 +816,8 @@ public:
     /// prove any arbitary property of this procedure. If conditional is true, do not save the result, as it may
     /// be conditional on premises stored in other procedures
     bool		prove(Exp *query, bool conditional = false);
-    /// helper function, should be private
+    /// helper functions, should be private
+    bool		proveQuery(Exp *query, bool conditional);
     bool		prover(Exp *query, std::set<PhiAssign*> &lastPhis, std::map<PhiAssign*, Exp*> &cache,
                        Exp* original, PhiAssign *lastPhi = NULL);
 
@@ -755,6 +826,12 @@ public:
 
     /// get all the statements
     void		getStatements(StatementList &stmts);
+    void		getStatements(StatementVec &stmts);
+    /// note that statements or BBs have been added, removed or reordered, so the statement cache is stale
+    void		invalidateStatements()
+    {
+        stmtCacheValid = false;
+    }
 
     virtual	void		removeReturn(Exp *e);
 //virtual void		addReturn(Exp *e);
@@ -832,6 +909,8 @@ public:
     void		setLocalType(const char *nam, Type *ty);
 
     Type		*getParamType(const char *nam);
+    /// Return the type of the local with the given name, else of the parameter with that name, else NULL
+    Type		*getSymbolType(const char *nam);
 
     /// return a symbol's exp (note: the original exp, like r24, not local1)
     Exp			*expFromSymbol(const char *nam);
@@ -927,15 +1006,15 @@ public:
     virtual Exp*		getProven(Exp* left);
     virtual Exp*		getPremised(Exp* left);
     // Set a location as a new premise, i.e. assume e=e
-    void		setPremise(Exp* e)
-    {
-        e = e->clone();
-        recurPremises[e] = e;
-    }
-    void		killPremise(Exp* e)
-    {
-        recurPremises.erase(e);
-    }
+    void		setPremise(Exp* e);
+    void		killPremise(Exp* e);
+    // Add or remove the premise lhs = rhs, keeping the premises known to the proof cache up to date
+    void		addPremise(Exp* lhs, Exp* rhs);
+    void		removePremise(Exp* lhs);
+    /// Statistics of all the proofs so far
+    static ProofStats	proofStats;
+    /// The results of the nested proofs of the current proof session
+    static ProofCache	proofCache;
     virtual	bool		isPreserved(Exp* e);				///< Return whether e is preserved by this proc
 
     virtual void		printCallGraphXML(std::ostream &os, int depth,
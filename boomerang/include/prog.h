@@ -36,6 +36,8 @@ class Statement;
 class StatementSet;
 class Cluster;
 class XMLProgParser;
+class DataIndex;
+class SwitchTables;
 
 typedef std::map<ADDRESS, Proc*, std::less<ADDRESS> > PROGMAP;
 
@@ -152,6 +154,8 @@ public:
 
     // Re-decode this proc from scratch
     void		reDecode(UserProc* proc);
+    // The proc will not be decoded again; free what was kept for decoding it again
+    void		doneDecoding(UserProc* proc);
 
     // Well form all the procedures/cfgs in this program
     bool		wellForm();
@@ -261,6 +265,13 @@ public:
     // get a string constant at a give address if appropriate
     char		*getStringConstant(ADDRESS uaddr, bool knownString = false);
     double		getFloatConstant(ADDRESS uaddr, bool &ok, int bits = 64);
+    // The index of the strings and pointers in the data, made the first time it is asked for
+    DataIndex	*getDataIndex();
+    // The switch tables read so far, made the first time it is asked for
+    SwitchTables *getSwitchTables();
+    // The host address of the size bytes at native address a, if they are all in one section that has contents;
+    // else NULL
+    const unsigned char *getSpan(ADDRESS a, unsigned size);
 
     // Hacks for Mike
     MACHINE		getMachine()
@@ -387,6 +398,8 @@ public:
 protected:
     BinaryFile*	pBF;					// Pointer to the BinaryFile object for the program
     FrontEnd	*pFE;					// Pointer to the FrontEnd object for the project
+    DataIndex	*dataIndex;				// Strings and pointers in the data; NULL until needed
+    SwitchTables *switchTables;			// Switch tables read so far; NULL until needed
 
     /* Persistent state */
     std::string	m_name, m_path;			// name of the program and its full path
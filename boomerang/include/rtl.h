@@ -277,6 +277,9 @@ public:
     // Reset the object to "undo" a readSSLFile()
     void	reset();
 
+    // If set, readSSLFile() keeps a copy of each file it parses, and reading the same file again copies that
+    static bool	keepParsed;
+
     // Return the signature of the given instruction.
     std::pair<std::string,unsigned> getSignature(const char* name);
 
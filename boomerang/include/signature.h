@@ -115,6 +115,16 @@ public:
 
 typedef std::vector<Return*> Returns;
 
+// How call sites got their signatures, for the -B statistics
+struct SignatureStats
+{
+    unsigned	shared;			// Calls to library procs that use the proc's signature rather than a copy
+    unsigned	copied;			// Of those, the ones that later needed their own copy (for ellipsis processing)
+    unsigned	defaultsMade;	// Default signatures made for unknown library functions
+    unsigned	defaultsReused;	// Lookups of unknown library functions answered with a default made earlier
+    SignatureStats() : shared(0), copied(0), defaultsMade(0), defaultsReused(0)
+    { }
+};
 
 class Signature
 {
@@ -141,6 +151,8 @@ protected:
     //void		addImplicitParameter(Type *type, const char *name, Exp *e, Parameter *parent);
 
 public:
+    static SignatureStats stats;
+
     Signature(const char *nam);
     // Platform plat, calling convention cc (both enums)
     // nam is name of the procedure (no longer stored in the Proc)
@@ -82,6 +82,20 @@ class ReturnStatement;
 
 typedef std::set<UserProc*> CycleSet;
 
+// What propagateTo() needs to know about the right hand side of an assignment before propagating it. Each takes a
+// walk of the whole expression to find, and an assignment with many uses would otherwise be walked again for each use.
+// -1 means not found yet
+struct PropagationFacts
+{
+    int			badMemof;		// 1 if the RHS contains a bare memof (Exp::containsBadMemof)
+    int			flags;			// 1 if the RHS contains a flag call (Exp::containsFlags)
+    int			complexity;		// Exp::getComplexityDepth of the RHS
+    PropagationFacts() : badMemof(-1), flags(-1), complexity(-1) {}
+};
+// The facts for assignments, valid for one propagation pass. The entry for an assignment must be erased whenever the
+// assignment is changed
+typedef std::map<Statement*, PropagationFacts> PropagationCache;
+
 /*==============================================================================
  * Kinds of Statements, or high-level register transfer lists.
  * changing the order of these will result in save files not working - trent
@@ -156,17 +170,28 @@ protected:
 #endif
     STMT_KIND	kind;			// Statement kind (e.g. STMT_BRANCH)
     Statement	*parent;		// The statement that contains this one
-    RangeMap	ranges;			// overestimation of ranges of locations
-    RangeMap    savedInputRanges;  // saved overestimation of ranges of locations
 
     unsigned int lexBegin, lexEnd;
+#if USE_BITSET_STATEMENTSET
+    unsigned	setIndex;		// This statement's bit in a StatementSet, once it has been inserted into one
+    friend class StatementSet;
+#endif
 
 public:
 
+#if USE_BITSET_STATEMENTSET
+    Statement() : pbb(NULL), proc(NULL), number(0), parent(NULL), setIndex(StatementSet::NO_INDEX)
+    { }
+    virtual				~Statement()
+    {
+        StatementSet::releaseIndex(setIndex);
+    }
+#else
     Statement() : pbb(NULL), proc(NULL), number(0), parent(NULL)
     { }
     virtual				~Statement()
     { }
+#endif
 
     // get/set the enclosing BB, etc
     PBB			getBB()
@@ -213,15 +238,6 @@ public:
         return parent;
     }
 
-    RangeMap &getRanges()
-    {
-        return ranges;
-    }
-    void	  clearRanges()
-    {
-        ranges.clear();
-    }
-
     virtual Statement*	clone() = 0;			   // Make copy of self
 
     // Accept a visitor (of various kinds) to this Statement. Return true to continue visiting
@@ -386,8 +402,9 @@ public:
     // dnp is a StatementSet with statements that should not be propagated
     // Set convert if an indirect call is changed to direct (otherwise, no change)
     // Set force to true to propagate even memofs (for switch analysis)
+    // cache, if given, remembers facts about the definitions propagated from
     bool		propagateTo(bool& convert, std::map<Exp*, int, lessExpStar>* destCounts = NULL,
-                            LocationSet* usedByDomPhi = NULL, bool force = false);
+                            LocationSet* usedByDomPhi = NULL, bool force = false, PropagationCache* cache = NULL);
     bool		propagateFlagsTo();
 
     // code generation
@@ -424,16 +441,12 @@ public:
     {}			// Use the type information in this Statement
     Type*		meetWithFor(Type* ty, Exp* e, bool& ch);// Meet the type associated with e with ty
 
-    // Range analysis
+    // Range analysis. The results are kept in rd, not in the Statement
 protected:
-    void		updateRanges(RangeMap &output, std::list<Statement*> &execution_paths, bool notTaken = false);
+    void		updateRanges(RangeData &rd, RangeMap &output, bool notTaken = false);
 public:
-    RangeMap    &getSavedInputRanges()
-    {
-        return savedInputRanges;
-    }
-    RangeMap	getInputRanges();
-    virtual void		rangeAnalysis(std::list<Statement*> &execution_paths);
+    RangeMap	getInputRanges(RangeData &rd);
+    virtual void		rangeAnalysis(RangeData &rd);
 
     // helper functions
     bool		isFirstStatementInBB();
@@ -729,7 +742,7 @@ public:
     void		dfaTypeAnalysis(bool& ch);
 
     // Range analysis
-    void		rangeAnalysis(std::list<Statement*> &execution_paths);
+    void		rangeAnalysis(RangeData &rd);
 
     // FIXME: I suspect that this was only used by adhoc TA, and can be deleted
     bool match(const char *pattern, std::map<std::string, Exp*> &bindings);
@@ -1181,7 +1194,7 @@ public:
     void		simplify()
     { }
 
-    void		rangeAnalysis(std::list<Statement*> &execution_paths);
+    void		rangeAnalysis(RangeData &rd);
     bool		isLoopJunction();
 };
 
@@ -1196,7 +1209,6 @@ class BranchStatement: public GotoStatement
     // jtCond seems to be mainly needed for the Pentium weirdness.
     // Perhaps bFloat, jtCond, and size could one day be merged into a type
     int			size;			// Size of the operands, in bits
-    RangeMap	ranges2;		// ranges for the not taken edge
 
 public:
     BranchStatement();
@@ -1264,16 +1276,8 @@ public:
     virtual bool		usesExp(Exp *e);
 
     // Range analysis
-    void		rangeAnalysis(std::list<Statement*> &execution_paths);
-    RangeMap	&getRangesForOutEdgeTo(PBB out);
-    RangeMap	&getRanges2Ref()
-    {
-        return ranges2;
-    }
-    void		setRanges2(RangeMap &r)
-    {
-        ranges2 = r;
-    }
+    void		rangeAnalysis(RangeData &rd);
+    RangeMap	&getRangesForOutEdgeTo(RangeData &rd, PBB out);
     void		limitOutputWithCondition(RangeMap &output, Exp *e);
 
     // simplify all the uses/defs in this Statememt
@@ -1371,6 +1375,8 @@ class CallStatement: public GotoStatement
     // The signature for this call. NOTE: this used to be stored in the Proc, but this does not make sense when
     // the proc happens to have varargs
     Signature*	signature;
+    // True if signature is the library proc's own, shared with its other calls. It is copied before it is changed
+    bool		sigShared;
 
     // A UseCollector object to collect the live variables at this call. Used as part of the calculation of
     // results
@@ -1458,7 +1464,7 @@ public:
     void		eliminateDuplicateArgs();
 
     // Range analysis
-    void		rangeAnalysis(std::list<Statement*> &execution_paths);
+    void		rangeAnalysis(RangeData &rd);
 
     virtual void		print(std::ostream& os = std::cout, bool html = false);
 
@@ -1556,6 +1562,7 @@ public:
 private:
     // Private helper functions for the above
     void		addSigParam(Type* ty, bool isScanf);
+    void		ownSignature();
     Assign*		makeArgAssign(Type* ty, Exp* e);
 
 protected:
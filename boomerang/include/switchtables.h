@@ -0,0 +1,46 @@
+/*
+ * See the file "LICENSE.TERMS" for information on usage and
+ * redistribution of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+/*==============================================================================
+ * FILE:	   switchtables.h
+ * OVERVIEW:   Definition of SwitchTables, which reads the tables of switch statements and remembers what it read.
+ *============================================================================*/
+/*
+ * $Revision$
+ *
+ * A switch table is looked at when the indirect jump is first analysed (to find how many entries point to code), and
+ * again each time the switch is processed, which happens every time its procedure is decoded again. The words of each
+ * table are read from the binary once, as one span of the section, and kept by table address.
+ */
+
+#ifndef __SWITCHTABLES_H__
+#define __SWITCHTABLES_H__
+
+#include <map>
+#include <vector>
+#include "types.h"
+
+class Prog;
+struct SWITCH_INFO;
+
+class SwitchTables
+{
+    Prog		*prog;
+    std::map<ADDRESS, std::vector<int> > tables;	// The words read so far from each table, by table address
+
+    const std::vector<int> &getWords(ADDRESS a, int num);
+
+public:
+    SwitchTables(Prog *prog);
+
+    // The number of entries, up to max, at the start of the form A table at a that point into the code
+    int			numCodeEntries(ADDRESS a, int max);
+    // Set dests to the destinations of the first num entries of the switch; NO_ADDRESS for unused entries of a hash
+    // table. Not for form F
+    void		getDests(SWITCH_INFO *si, int num, std::vector<ADDRESS> &dests);
+};
+
+#endif
@@ -20,6 +20,7 @@ class ExpTransformer
 {
 protected:
     static std::list<ExpTransformer*> transformers;
+    int					number;			// Position in transformers; transformers are applied in this order
 public:
     ExpTransformer();
     virtual				~ExpTransformer()
@@ -27,9 +28,18 @@ public:
 
     static void			loadAll();
 
+    int					getNumber()
+    {
+        return number;
+    }
+    // Return the pattern of the expressions that this transformer can change, with opVar where anything can appear,
+    // or NULL if it could change any expression. Used to index the transformers by the shape of what they match
+    virtual Exp			*getPattern()
+    {
+        return NULL;
+    }
     virtual Exp			*applyTo(Exp *e, bool &bMod) = 0;
     static Exp			*applyAllTo(Exp *e, bool &bMod);
 };
 
 #endif
-
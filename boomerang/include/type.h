@@ -95,6 +95,11 @@ public:
     // Return type for given temporary variable name
     static Type*		getTempType(const std::string &name);
     static Type*		parseType(const char *str); // parse a C type
+    // Return the shared instance of a common simple type (void, bool, char, and integer, float or size types of the
+    // usual sizes) equal to ty. Other types, including all composite types, are cloned; there is no interning of
+    // types in general. Shared types must never be modified (e.g. setSize or meetWith); they are for code that only
+    // reads the type, such as code generation. Safe to call from any thread
+    static Type*		getShared(const Type& ty);
 
     bool	isCString();
 
@@ -243,6 +248,11 @@ public:
     {
         namedTypes.clear();
     }
+    // The named type map itself, e.g. to keep a platform's types (see FrontEnd::warmCaches)
+    static	std::map<std::string, Type*> &getNamedTypes()
+    {
+        return namedTypes;
+    }
 
     bool		isPointerToAlpha();
 
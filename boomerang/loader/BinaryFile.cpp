@@ -111,12 +111,17 @@ PSectionInfo BinaryFile::GetSectionInfoByName(const char* sName)
 
 const char* BinaryFile::SymbolByAddress(ADDRESS uNative)
 {
-    return 0; // Overridden by subclasses that support syms
+    return m_Symbols.find(uNative);
 }
 
 ADDRESS BinaryFile::GetAddressByName(const char* pName, bool bNoTypeOK)
 {
-    return 0;
+    return m_Symbols.find(pName);
+}
+
+void BinaryFile::AddSymbol(ADDRESS uNative, const char *pName)
+{
+    m_Symbols.Add(uNative, pName);
 }
 
 int BinaryFile::GetSizeByName(const char* pName, bool bNoTypeOK)
@@ -202,7 +202,7 @@ BinaryFileStub::BinaryFileStub()
     SectionInfo *text = new SectionInfo();
     text->pSectionName = const_cast<char *> (".text");
     text->uNativeAddr = 0x8048810;
-    text->uHostAddr = (ADDRESS) pent_hello_text;
+    text->uHostAddr = pent_hello_text;
     text->uSectionSize = sizeof (pent_hello_text);
     text->uSectionEntrySize = 0;
     text->uType = 0;
@@ -240,91 +240,91 @@ bool DOS4GWBinaryFile::RealLoad(const char* sName)
 
 #if 0
     // you probably don't want this, it's a bunch of symbols I pulled out of a disassmbly of a binary I'm working on.
-    dlprocptrs[0x101ac] = "main";
-    dlprocptrs[0x10a24] = "vfprintf";
-    dlprocptrs[0x12d2c] = "atoi";
-    dlprocptrs[0x12d74] = "malloc";
-    dlprocptrs[0x12d84] = "__LastFree";
-    dlprocptrs[0x12eaa] = "__ExpandDGROUP";
-    dlprocptrs[0x130a7] = "free";
-    dlprocptrs[0x130b7] = "_nfree";
-    dlprocptrs[0x130dc] = "start";
-    dlprocptrs[0x132fa] = "__exit_";
-    dlprocptrs[0x132fc] = "__exit_with_msg_";
-    dlprocptrs[0x1332a] = "__GETDS";
-    dlprocptrs[0x13332] = "inp";
-    dlprocptrs[0x1333d] = "outp";
-    dlprocptrs[0x13349] = "_dos_getvect";
-    dlprocptrs[0x13383] = "_dos_setvect";
-    dlprocptrs[0x133ba] = "int386";
-    dlprocptrs[0x133f9] = "sprintf";
-    dlprocptrs[0x13423] = "vsprintf";
-    dlprocptrs[0x13430] = "segread";
-    dlprocptrs[0x1345d] = "int386x";
-    dlprocptrs[0x1347e] = "creat";
-    dlprocptrs[0x13493] = "setmode";
-    dlprocptrs[0x1355f] = "close";
-    dlprocptrs[0x1384a] = "read";
-    dlprocptrs[0x13940] = "write";
-    dlprocptrs[0x13b2e] = "filelength";
-    dlprocptrs[0x13b74] = "printf";
-    dlprocptrs[0x13b94] = "__null_int23_exit";
-    dlprocptrs[0x13b95] = "exit";
-    dlprocptrs[0x13bad] = "_exit";
-    dlprocptrs[0x13bc4] = "tell";
-    dlprocptrs[0x13cba] = "rewind";
-    dlprocptrs[0x13cd3] = "fread";
-    dlprocptrs[0x13fe1] = "strcat";
-    dlprocptrs[0x1401c] = "__open_flags";
-    dlprocptrs[0x141a8] = "fopen";
-    dlprocptrs[0x141d0] = "freopen";
-    dlprocptrs[0x142c4] = "__MemAllocator";
-    dlprocptrs[0x14374] = "__MemFree";
-    dlprocptrs[0x1447f] = "__nmemneed";
-    dlprocptrs[0x14487] = "sbrk";
-    dlprocptrs[0x14524] = "__brk";
-    dlprocptrs[0x145d0] = "__CMain";
-    dlprocptrs[0x145ff] = "_init_files";
-    dlprocptrs[0x1464c] = "__InitRtns";
-    dlprocptrs[0x1468b] = "__FiniRtns";
-    dlprocptrs[0x146ca] = "__prtf";
-    dlprocptrs[0x14f58] = "__int386x_";
-    dlprocptrs[0x14fb3] = "_DoINTR_";
-    dlprocptrs[0x15330] = "__Init_Argv";
-    dlprocptrs[0x15481] = "isatty";
-    dlprocptrs[0x154a1] = "_dosret0";
-    dlprocptrs[0x154bd] = "_dsretax";
-    dlprocptrs[0x154d4] = "_EINVAL";
-    dlprocptrs[0x154e5] = "_set_errno";
-    dlprocptrs[0x15551] = "__CHK";
-    dlprocptrs[0x15561] = "__STK";
-    dlprocptrs[0x15578] = "__STKOVERFLOW";
-    dlprocptrs[0x15588] = "__GRO";
-    dlprocptrs[0x155c2] = "__fprtf";
-    dlprocptrs[0x15640] = "__ioalloc";
-    dlprocptrs[0x156c3] = "__chktty";
-    dlprocptrs[0x156f0] = "__qread";
-    dlprocptrs[0x15721] = "fgetc";
-    dlprocptrs[0x1578f] = "__filbuf";
-    dlprocptrs[0x157b9] = "__fill_buffer";
-    dlprocptrs[0x15864] = "fflush";
-    dlprocptrs[0x1591c] = "ftell";
-    dlprocptrs[0x15957] = "tolower";
-    dlprocptrs[0x159b4] = "remove";
-    dlprocptrs[0x159e9] = "utoa";
-    dlprocptrs[0x15a36] = "itoa";
-    dlprocptrs[0x15a97] = "ultoa";
-    dlprocptrs[0x15ae4] = "ltoa";
-    dlprocptrs[0x15b14] = "toupper";
-    dlprocptrs[0x15b29] = "fputc";
-    dlprocptrs[0x15bca] = "__full_io_exit";
-    dlprocptrs[0x15c0b] = "fcloseall";
-    dlprocptrs[0x15c3e] = "flushall";
-    dlprocptrs[0x15c49] = "__flushall";
-    dlprocptrs[0x15c85] = "getche";
-    dlprocptrs[0x15caa] = "__qwrite";
-    dlprocptrs[0x15d1f] = "unlink";
-    dlprocptrs[0x15d43] = "putch";
+    m_Symbols.Add(0x101ac, "main");
+    m_Symbols.Add(0x10a24, "vfprintf");
+    m_Symbols.Add(0x12d2c, "atoi");
+    m_Symbols.Add(0x12d74, "malloc");
+    m_Symbols.Add(0x12d84, "__LastFree");
+    m_Symbols.Add(0x12eaa, "__ExpandDGROUP");
+    m_Symbols.Add(0x130a7, "free");
+    m_Symbols.Add(0x130b7, "_nfree");
+    m_Symbols.Add(0x130dc, "start");
+    m_Symbols.Add(0x132fa, "__exit_");
+    m_Symbols.Add(0x132fc, "__exit_with_msg_");
+    m_Symbols.Add(0x1332a, "__GETDS");
+    m_Symbols.Add(0x13332, "inp");
+    m_Symbols.Add(0x1333d, "outp");
+    m_Symbols.Add(0x13349, "_dos_getvect");
+    m_Symbols.Add(0x13383, "_dos_setvect");
+    m_Symbols.Add(0x133ba, "int386");
+    m_Symbols.Add(0x133f9, "sprintf");
+    m_Symbols.Add(0x13423, "vsprintf");
+    m_Symbols.Add(0x13430, "segread");
+    m_Symbols.Add(0x1345d, "int386x");
+    m_Symbols.Add(0x1347e, "creat");
+    m_Symbols.Add(0x13493, "setmode");
+    m_Symbols.Add(0x1355f, "close");
+    m_Symbols.Add(0x1384a, "read");
+    m_Symbols.Add(0x13940, "write");
+    m_Symbols.Add(0x13b2e, "filelength");
+    m_Symbols.Add(0x13b74, "printf");
+    m_Symbols.Add(0x13b94, "__null_int23_exit");
+    m_Symbols.Add(0x13b95, "exit");
+    m_Symbols.Add(0x13bad, "_exit");
+    m_Symbols.Add(0x13bc4, "tell");
+    m_Symbols.Add(0x13cba, "rewind");
+    m_Symbols.Add(0x13cd3, "fread");
+    m_Symbols.Add(0x13fe1, "strcat");
+    m_Symbols.Add(0x1401c, "__open_flags");
+    m_Symbols.Add(0x141a8, "fopen");
+    m_Symbols.Add(0x141d0, "freopen");
+    m_Symbols.Add(0x142c4, "__MemAllocator");
+    m_Symbols.Add(0x14374, "__MemFree");
+    m_Symbols.Add(0x1447f, "__nmemneed");
+    m_Symbols.Add(0x14487, "sbrk");
+    m_Symbols.Add(0x14524, "__brk");
+    m_Symbols.Add(0x145d0, "__CMain");
+    m_Symbols.Add(0x145ff, "_init_files");
+    m_Symbols.Add(0x1464c, "__InitRtns");
+    m_Symbols.Add(0x1468b, "__FiniRtns");
+    m_Symbols.Add(0x146ca, "__prtf");
+    m_Symbols.Add(0x14f58, "__int386x_");
+    m_Symbols.Add(0x14fb3, "_DoINTR_");
+    m_Symbols.Add(0x15330, "__Init_Argv");
+    m_Symbols.Add(0x15481, "isatty");
+    m_Symbols.Add(0x154a1, "_dosret0");
+    m_Symbols.Add(0x154bd, "_dsretax");
+    m_Symbols.Add(0x154d4, "_EINVAL");
+    m_Symbols.Add(0x154e5, "_set_errno");
+    m_Symbols.Add(0x15551, "__CHK");
+    m_Symbols.Add(0x15561, "__STK");
+    m_Symbols.Add(0x15578, "__STKOVERFLOW");
+    m_Symbols.Add(0x15588, "__GRO");
+    m_Symbols.Add(0x155c2, "__fprtf");
+    m_Symbols.Add(0x15640, "__ioalloc");
+    m_Symbols.Add(0x156c3, "__chktty");
+    m_Symbols.Add(0x156f0, "__qread");
+    m_Symbols.Add(0x15721, "fgetc");
+    m_Symbols.Add(0x1578f, "__filbuf");
+    m_Symbols.Add(0x157b9, "__fill_buffer");
+    m_Symbols.Add(0x15864, "fflush");
+    m_Symbols.Add(0x1591c, "ftell");
+    m_Symbols.Add(0x15957, "tolower");
+    m_Symbols.Add(0x159b4, "remove");
+    m_Symbols.Add(0x159e9, "utoa");
+    m_Symbols.Add(0x15a36, "itoa");
+    m_Symbols.Add(0x15a97, "ultoa");
+    m_Symbols.Add(0x15ae4, "ltoa");
+    m_Symbols.Add(0x15b14, "toupper");
+    m_Symbols.Add(0x15b29, "fputc");
+    m_Symbols.Add(0x15bca, "__full_io_exit");
+    m_Symbols.Add(0x15c0b, "fcloseall");
+    m_Symbols.Add(0x15c3e, "flushall");
+    m_Symbols.Add(0x15c49, "__flushall");
+    m_Symbols.Add(0x15c85, "getche");
+    m_Symbols.Add(0x15caa, "__qwrite");
+    m_Symbols.Add(0x15d1f, "unlink");
+    m_Symbols.Add(0x15d43, "putch");
 #endif
 
     // fixups
@@ -374,10 +374,8 @@ bool DOS4GWBinaryFile::RealLoad(const char* sName)
 
 bool DOS4GWBinaryFile::IsDynamicLinkedProc(ADDRESS uNative)
 {
-    if (dlprocptrs.find(uNative) != dlprocptrs.end() &&
-            dlprocptrs[uNative] != "main" && dlprocptrs[uNative] != "_start")
-        return true;
-    return false;
+    const char *name = m_Symbols.find(uNative);
+    return name && strcmp(name, "main") != 0 && strcmp(name, "_start") != 0;
 }
 
 // Clean up and unload the binary image
@@ -391,35 +389,6 @@ bool DOS4GWBinaryFile::PostLoad(void* handle)
     return false;
 }
 
-const char* DOS4GWBinaryFile::SymbolByAddress(ADDRESS dwAddr)
-{
-    std::map<ADDRESS, std::string>::iterator it = dlprocptrs.find(dwAddr);
-    if (it == dlprocptrs.end())
-        return 0;
-    return (char*) it->second.c_str();
-}
-
-ADDRESS DOS4GWBinaryFile::GetAddressByName(const char* pName,
-        bool bNoTypeOK /* = false */)
-{
-    // This is "looking up the wrong way" and hopefully is uncommon
-    // Use linear search
-    std::map<ADDRESS, std::string>::iterator it = dlprocptrs.begin();
-    while (it != dlprocptrs.end())
-        {
-            // std::cerr << "Symbol: " << it->second.c_str() << " at 0x" << std::hex << it->first << "\n";
-            if (strcmp(it->second.c_str(), pName) == 0)
-                return it->first;
-            it++;
-        }
-    return NO_ADDRESS;
-}
-
-void DOS4GWBinaryFile::AddSymbol(ADDRESS uNative, const char *pName)
-{
-    dlprocptrs[uNative] = pName;
-}
-
 bool DOS4GWBinaryFile::DisplayDetails(const char* fileName, FILE* f
                                       /* = stdout */)
 {
@@ -523,14 +492,13 @@ double DOS4GWBinaryFile::readNativeFloat8(ADDRESS nat)
 
 bool DOS4GWBinaryFile::IsDynamicLinkedProcPointer(ADDRESS uNative)
 {
-    if (dlprocptrs.find(uNative) != dlprocptrs.end())
-        return true;
-    return false;
+    return m_Symbols.find(uNative) != NULL;
 }
 
 const char *DOS4GWBinaryFile::GetDynamicProcName(ADDRESS uNative)
 {
-    return dlprocptrs[uNative].c_str();
+    const char *name = m_Symbols.find(uNative);
+    return name ? name : "";
 }
 
 LOAD_FMT DOS4GWBinaryFile::GetFormat() const
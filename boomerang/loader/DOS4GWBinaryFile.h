@@ -164,10 +164,6 @@ public:
     virtual ADDRESS GetMainEntryPoint();
     virtual ADDRESS GetEntryPoint();
     ptrdiff_t getDelta();
-    virtual const char* SymbolByAddress(ADDRESS dwAddr); // Get sym from addr
-    virtual ADDRESS GetAddressByName(const char* name,
-                                     bool bNoTypeOK = false); // Find addr given name
-    virtual void AddSymbol(ADDRESS uNative, const char *pName);
 
     //
     //		--		--		--		--		--		--		--		--		--
@@ -194,11 +190,6 @@ public:
     virtual bool IsDynamicLinkedProc(ADDRESS uNative);
     virtual const char *GetDynamicProcName(ADDRESS uNative);
 
-    virtual std::map<ADDRESS, std::string> &getSymbols()
-    {
-        return dlprocptrs;
-    }
-
 protected:
     virtual bool RealLoad(const char* sName); // Load the file; pure virtual
 
@@ -214,8 +205,6 @@ private:
     //int		m_cReloc;				// Number of relocation entries
     //DWord*	m_pRelocTable;			// The relocation table
     unsigned char *base; // Beginning of the loaded image
-    // Map from address of dynamic pointers to library procedure names:
-    std::map<ADDRESS, std::string> dlprocptrs;
     const char *m_pFileName;
 
 };
@@ -330,35 +330,34 @@ char *ElfBinaryFile::GetStrPtr(int idx, int offset)
     return pSym + offset;
 }
 
-// Search the .rel[a].plt section for an entry with symbol table index i.
-// If found, return the native address of the associated PLT entry.
-// A linear search will be needed. However, starting at offset i and searching backwards with wraparound should
-// typically minimise the number of entries to search
+// Make a table from symbol table index to the native address of the associated PLT entry, or 0 if the symbol has no
+// entry in the .rel[a].plt section. This used to be a search for each symbol, backwards with wraparound from offset i;
+// that was quadratic for big shared objects. If a symbol has more than one entry, the one that search would have found
+// is used: the last one at or before offset i, or failing that the last one
 
-ADDRESS ElfBinaryFile::findRelPltOffset(int i, unsigned char *addrRelPlt, int sizeRelPlt, int numRelPlt, ADDRESS addrPlt)
+void ElfBinaryFile::buildRelPltTable(std::vector<ADDRESS>& pltAddrs, int nSyms, unsigned char *addrRelPlt,
+                                     int sizeRelPlt, int numRelPlt, ADDRESS addrPlt)
 {
-    int first = i;
-    if (first >= numRelPlt)
-        first = numRelPlt - 1;
-    int curr = first;
-    do
+    pltAddrs.assign(nSyms, 0);
+    std::vector<int> slots(nSyms, -1);
+    for (int curr = 0; curr < numRelPlt; curr++)
         {
             // Each entry is sizeRelPlt bytes, and will contain the offset, then the info (addend optionally follows)
             int* pEntry = (int*) (addrRelPlt + (curr * sizeRelPlt));
             int entry = elfRead4(pEntry + 1); // Read pEntry[1]
-            int sym = entry >> 8; // The symbol index is in the top 24 bits (Elf32 only)
-            if (sym == i)
-                {
-                    // Found! Now we want the native address of the associated PLT entry.
-                    // For now, assume a size of 0x10 for each PLT entry, and assume that each entry in the .rel.plt section
-                    // corresponds exactly to an entry in the .plt (except there is one dummy .plt entry)
-                    return addrPlt + 0x10 * (curr + 1);
-                }
-            if (--curr < 0)
-                curr = numRelPlt - 1;
+            int sym = (unsigned)entry >> 8; // The symbol index is in the top 24 bits (Elf32 only)
+            if (sym >= nSyms)
+                continue;
+            int first = sym < numRelPlt ? sym : numRelPlt - 1;
+            if (curr <= first || slots[sym] < 0 || slots[sym] > first)
+                slots[sym] = curr;
         }
-    while (curr != first);   // Will eventually wrap around to first if not present
-    return 0; // Exit if this happens
+    for (int i = 0; i < nSyms; i++)
+        if (slots[i] >= 0)
+            // We want the native address of the associated PLT entry.
+            // For now, assume a size of 0x10 for each PLT entry, and assume that each entry in the .rel.plt section
+            // corresponds exactly to an entry in the .plt (except there is one dummy .plt entry)
+            pltAddrs[i] = addrPlt + 0x10 * (slots[i] + 1);
 }
 
 // Add appropriate symbols to the symbol table.  secIndex is the section index of the symbol table.
@@ -388,6 +387,11 @@ void ElfBinaryFile::AddSyms(int secIndex)
             addrRelPlt = siRelPlt->uHostAddr;
             numRelPlt = sizeRelPlt ? siRelPlt->uSectionSize / sizeRelPlt : 0;
         }
+    // Symbol index to PLT entry address; made when first needed
+    std::vector<ADDRESS> pltAddrs;
+    bool havePltAddrs = false;
+    // The string table, looked up once rather than for every symbol
+    char *strTab = strIdx < 0 ? NULL : GetStrPtr(strIdx, 0);
     // Number of entries in the PLT:
     // int max_i_for_hack = siPlt ? (int)siPlt->uSectionSize / 0x10 : 0;
     // Index 0 is a dummy entry
@@ -396,14 +400,12 @@ void ElfBinaryFile::AddSyms(int secIndex)
             ADDRESS val = (ADDRESS) elfRead4((int*) & m_pSym[i].st_value);
             int name = elfRead4(&m_pSym[i].st_name);
             if (name == 0) /* Silly symbols with no names */ continue;
-            std::string str(GetStrPtr(strIdx, name));
+            const char *pName = strTab ? strTab + name : GetStrPtr(strIdx, name);
             // Hack off the "@@GLIBC_2.0" of Linux, if present
-            size_t pos;
-            if ((pos = str.find("@@")) != std::string::npos)
-                str.erase(pos);
-            std::map<ADDRESS, std::string>::iterator aa = m_SymTab.find(val);
+            const char *pAt = strstr(pName, "@@");
+            std::string str(pName, pAt ? pAt - pName : strlen(pName));
             // Ensure no overwriting (except functions)
-            if (aa == m_SymTab.end() || ELF32_ST_TYPE(m_pSym[i].st_info) == STT_FUNC)
+            if (m_Symbols.find(val) == NULL || ELF32_ST_TYPE(m_pSym[i].st_info) == STT_FUNC)
                 {
                     if (val == 0 && siPlt)   //&& i < max_i_for_hack) {
                         {
@@ -411,7 +413,12 @@ void ElfBinaryFile::AddSyms(int secIndex)
                             // is zero!  I was assuming that index i in the dynamic symbol table would always correspond to index i
                             // in the .plt section, but for fedora2_true, this doesn't work. So we have to look in the .rel[a].plt
                             // section. Thanks, gcc!  Note that this hack can cause strange symbol names to appear
-                            val = findRelPltOffset(i, addrRelPlt, sizeRelPlt, numRelPlt, addrPlt);
+                            if (!havePltAddrs)
+                                {
+                                    buildRelPltTable(pltAddrs, nSyms, addrRelPlt, sizeRelPlt, numRelPlt, addrPlt);
+                                    havePltAddrs = true;
+                                }
+                            val = pltAddrs[i];
                         }
                     else if (e_type == E_REL)
                         {
@@ -424,15 +431,14 @@ void ElfBinaryFile::AddSyms(int secIndex)
 #if		ECHO_SYMS
                     std::cerr << "Elf AddSym: about to add " << str << " to address " << std::hex << val << std::dec << "\n";
 #endif
-                    m_SymTab[val] = str;
+                    m_Symbols.Add(val, str.c_str());
                 }
         }
     ADDRESS uMain = GetMainEntryPoint();
-    if (uMain != NO_ADDRESS && m_SymTab.find(uMain) == m_SymTab.end())
+    if (uMain != NO_ADDRESS && m_Symbols.find(uMain) == NULL)
         {
             // Ugh - main mustn't have the STT_FUNC attribute. Add it
-            std::string sMain("main");
-            m_SymTab[uMain] = sMain;
+            m_Symbols.Add(uMain, "main");
         }
     return;
 }
@@ -530,33 +536,19 @@ void ElfBinaryFile::AddRelocsAsSyms(int relSecIdx)
             size_t pos;
             if ((pos = str.find("@@")) != std::string::npos)
                 str.erase(pos);
-            std::map<ADDRESS, std::string>::iterator it;
-            // Linear search!
-            for (it = m_SymTab.begin(); it != m_SymTab.end(); it++)
-                if ((*it).second == str)
-                    break;
+            ADDRESS a = m_Symbols.find(str.c_str());
             // Add new extern
-            if (it == m_SymTab.end())
+            if (a == NO_ADDRESS)
                 {
-                    m_SymTab[next_extern] = str;
-                    it = m_SymTab.find(next_extern);
+                    a = next_extern;
+                    m_Symbols.Add(a, str.c_str());
                     next_extern += 4;
                 }
-            writeNative4(val, (*it).first - val - 4);
+            writeNative4(val, a - val - 4);
         }
     return;
 }
 
-// Note: this function overrides a simple "return 0" function in the base class (i.e. BinaryFile::SymbolByAddress())
-
-const char* ElfBinaryFile::SymbolByAddress(const ADDRESS dwAddr)
-{
-    std::map<ADDRESS, std::string>::iterator aa = m_SymTab.find(dwAddr);
-    if (aa == m_SymTab.end())
-        return 0;
-    return (char*) aa->second.c_str();
-}
-
 bool ElfBinaryFile::ValueByName(const char* pName, SymValue* pVal, bool bNoTypeOK /* = false */)
 {
     int hash, numBucket, numChain, y;
@@ -573,7 +565,7 @@ bool ElfBinaryFile::ValueByName(const char* pName, SymValue* pVal, bool bNoTypeO
             // We have a file with no .dynsym section, and hence no .hash section (from my understanding - MVE).
             // It seems that the only alternative is to linearly search the symbol tables.
             // This must be one of the big reasons that linking is so slow! (at least, for statically linked files)
-            // Note MVE: We can't use m_SymTab because we may need the size
+            // Note MVE: We can't use the symbol table because we may need the size
             return SearchValueByName(pName, pVal);
         }
     pSym = (Elf32_Sym*) pSect->uHostAddr;
@@ -933,37 +925,39 @@ ADDRESS* ElfBinaryFile::GetImportStubs(int& numImports)
 {
     ADDRESS a = m_uPltMin;
     int n = 0;
-    std::map<ADDRESS, std::string>::iterator aa = m_SymTab.find(a);
-    std::map<ADDRESS, std::string>::iterator ff = aa;
-    bool delDummy = false;
-    if (aa == m_SymTab.end())
+    // The addresses of the symbols from m_uPltMin on, as far as the first one past m_uPltMax
+    std::vector<ADDRESS> addrs;
+    SymTab::iterator it = m_Symbols.lowerBound(a);
+    unsigned aa = 0;
+    if (it == m_Symbols.end() || it->addr != a)
         {
-            // Need to insert a dummy entry at m_uPltMin
-            delDummy = true;
-            m_SymTab[a] = std::string();
-            ff = m_SymTab.find(a);
-            aa = ff;
-            aa++;
+            // Need a dummy entry at m_uPltMin
+            addrs.push_back(a);
+            aa = 1;
+        }
+    for (; it != m_Symbols.end(); ++it)
+        {
+            addrs.push_back(it->addr);
+            if (it->addr >= m_uPltMax)
+                break;
         }
-    while ((aa != m_SymTab.end()) && (a < m_uPltMax))
+    while ((aa < addrs.size()) && (a < m_uPltMax))
         {
             n++;
-            a = aa->first;
+            a = addrs[aa];
             aa++;
         }
     // Allocate an array of ADDRESSESes
     m_pImportStubs = new ADDRESS[n];
-    aa = ff; // Start at first
-    a = aa->first;
+    aa = 0; // Start at first
+    a = addrs[aa];
     int i = 0;
-    while ((aa != m_SymTab.end()) && (a < m_uPltMax))
+    while ((aa < addrs.size()) && (a < m_uPltMax) && (i < n))
         {
             m_pImportStubs[i++] = a;
-            a = aa->first;
+            a = addrs[aa];
             aa++;
         }
-    if (delDummy)
-        m_SymTab.erase(ff); // Delete dummy entry
     numImports = n;
     return m_pImportStubs;
 }
@@ -1526,18 +1520,11 @@ void ElfBinaryFile::getFunctionSymbols(std::map<std::string, std::map<ADDRESS, s
         }
 }
 
-// A map for extra symbols, those not in the usual Elf symbol tables
-
-void ElfBinaryFile::AddSymbol(ADDRESS uNative, const char *pName)
-{
-    m_SymTab[uNative] = pName;
-}
-
 void ElfBinaryFile::dumpSymbols()
 {
-    std::map<ADDRESS, std::string>::iterator it;
+    SymTab::iterator it;
     std::cerr << std::hex;
-    for (it = m_SymTab.begin(); it != m_SymTab.end(); ++it)
-        std::cerr << "0x" << it->first << " " << it->second << "        ";
+    for (it = m_Symbols.begin(); it != m_Symbols.end(); ++it)
+        std::cerr << "0x" << it->addr << " " << it->name << "        ";
     std::cerr << std::dec << "\n";
 }
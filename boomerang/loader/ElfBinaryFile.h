@@ -26,7 +26,7 @@
  *============================================================================*/
 
 #include "BinaryFile.h"
-#include "SymTab.h"					// For SymTab (probably unused)
+#include "SymTab.h"					// For m_Reloc (probably unused)
 typedef std::map<ADDRESS, std::string, std::less<ADDRESS> > RelocMap;
 
 typedef struct
@@ -203,8 +203,8 @@ public:
 
     void writeNative4(ADDRESS nat, unsigned int n);
 
-    // Symbol functions
-    const char* SymbolByAddress(ADDRESS uAddr); // Get name of symbol
+    // Symbol functions. SymbolByAddress() and AddSymbol() use the BinaryFile symbol table, which holds the symbols
+    // from the various elf symbol tables, and possibly some symbols with fake addresses
     // Get value of symbol, if any
     ADDRESS GetAddressByName(const char* pName, bool bNoTypeOK = false);
     // Get the size associated with the symbol
@@ -212,8 +212,6 @@ public:
     // Get the size associated with the symbol; guess if necessary
     int GetDistanceByName(const char* pName);
     int GetDistanceByName(const char* pName, const char* pSectName);
-    // Add an extra symbol
-    void AddSymbol(ADDRESS uNative, const char *pName);
     void dumpSymbols(); // For debugging
 
     virtual ADDRESS* GetImportStubs(int& numImports);
@@ -254,11 +252,6 @@ public:
     // The ADDRESS is the native address of a pointer to the real dynamic data object.
     virtual std::map<ADDRESS, const char*>* GetDynamicGlobalMap();
 
-    virtual std::map<ADDRESS, std::string> &getSymbols()
-    {
-        return m_SymTab;
-    }
-
     virtual void getFunctionSymbols(std::map<std::string, std::map<ADDRESS, std::string> > &syms_in_file);
 
     // Not meant to be used externally, but sometimes you just have to have it.
@@ -283,9 +276,10 @@ private:
     bool SearchValueByName(const char* pName, SymValue* pVal);
     bool SearchValueByName(const char* pName, SymValue* pVal, const char* pSectName, const char* pStrName);
     bool PostLoad(void* handle); // Called after archive member loaded
-    // Search the .rel[a].plt section for an entry with symbol table index i.
-    // If found, return the native address of the associated PLT entry.
-    ADDRESS findRelPltOffset(int i, unsigned char *addrRelPlt, int sizeRelPlt, int numRelPlt, ADDRESS addrPlt);
+    // Make a table from symbol table index to the native address of the associated PLT entry (0 if none), in one
+    // pass over the .rel[a].plt section
+    void buildRelPltTable(std::vector<ADDRESS>& pltAddrs, int nSyms, unsigned char *addrRelPlt, int sizeRelPlt,
+                          int numRelPlt, ADDRESS addrPlt);
 
     // Internal elf reading methods
     int elfRead2(short* ps) const; // Read a short with endianness care
@@ -299,9 +293,6 @@ private:
     Elf32_Shdr* m_pShdrs; // Array of section header structs
     char* m_pStrings; // Pointer to the string section
     char m_elfEndianness; // 1 = Big Endian
-    std::map<ADDRESS, std::string> m_SymTab; // Map from address to symbol name; contains symbols from the
-    // various elf symbol tables, and possibly some symbols with fake
-    // addresses
     SymTab m_Reloc; // Object to store the reloc syms
     Elf32_Rel* m_pReloc; // Pointer to the relocation section
     Elf32_Sym* m_pSym; // Pointer to loaded symbol section
@@ -326,7 +326,7 @@ bool HpSomBinaryFile::RealLoad(const char* sName)
                             u = (offset - minPLT) / sizeof (plt_record);
                             // Add an offset for the DLT entries
                             u += numDLT;
-                            symbols[import_list[u].name + pDlStrings] = host - deltaText;
+                            m_Symbols.Add(host - deltaText, import_list[u].name + pDlStrings);
                             cout << "Added sym " << (import_list[u].name + pDlStrings) << ", value " << hex << (host - deltaText) << endl;
                         }
                 }
@@ -342,7 +342,7 @@ bool HpSomBinaryFile::RealLoad(const char* sName)
     for (; u < numImports; u++, v++)
         {
             //cout << "Importing " << (pDlStrings+import_list[u].name) << endl;
-            symbols.Add(PLTs[v].value, pDlStrings + UINT4(&import_list[u].name));
+            m_Symbols.Add(PLTs[v].value, pDlStrings + UINT4(&import_list[u].name));
             // Add it to the set of imports; needed by IsDynamicLinkedProc()
             imports.insert(PLTs[v].value);
             //cout << "Added import sym " << (import_list[u].name + pDlStrings) << ", value " << hex << PLTs[v].value << endl;
@@ -355,7 +355,7 @@ bool HpSomBinaryFile::RealLoad(const char* sName)
             if (strncmp(pDlStrings + UINT4(&export_list[u].name), "main", 4) == 0)
                 {
                     // Enter the symbol "_callmain" for this address
-                    symbols.Add(UINT4(&export_list[u].value), const_cast<char *> ("_callmain"));
+                    m_Symbols.Add(UINT4(&export_list[u].value), const_cast<char *> ("_callmain"));
                     // Found call to main. Extract the offset. See assemble_17
                     // in pa-risc 1.1 manual page 5-9
                     // +--------+--------+--------+----+------------+-+-+
@@ -373,7 +373,7 @@ bool HpSomBinaryFile::RealLoad(const char* sName)
                                   ((bincall & 4) << 8) | // w2@10
                                   ((bincall & 0x1ff8) >> 3)); // w2@0..9
                     // Address of main is st + 8 + offset << 2
-                    symbols.Add(UINT4(&export_list[u].value) + 8 + (offset << 2), const_cast<char *> ("main"));
+                    m_Symbols.Add(UINT4(&export_list[u].value) + 8 + (offset << 2), const_cast<char *> ("main"));
                     break;
                 }
         }
@@ -413,8 +413,8 @@ bool HpSomBinaryFile::RealLoad(const char* sName)
                     //  cout << "main at " << hex << value << " has type " << SYMBOLTY(u) << endl;}
                     // HP's symbol table is crazy. It seems that imports like printf have entries of type 3 with the wrong
                     // value. So we have to check whether the symbol has already been entered (assume first one is correct).
-                    if (symbols.find(pSymName) == NO_ADDRESS)
-                        symbols.Add(value, pSymName);
+                    if (m_Symbols.find(pSymName) == NO_ADDRESS)
+                        m_Symbols.Add(value, pSymName);
                     //cout << "Symbol " << pNames+SYMBOLNM(u) << ", type " << SYMBOLTY(u) << ", value " << hex << value << ", aux " << SYMBOLAUX(u) << endl;  // HACK!
                 }
         } // if (numSym)
@@ -500,23 +500,6 @@ size_t HpSomBinaryFile::getImageSize()
     return UINT4(m_pImage + 0x24);
 }
 
-// We at least need to be able to name the main function and system calls
-
-const char* HpSomBinaryFile::SymbolByAddress(ADDRESS a)
-{
-    return symbols.find(a);
-}
-
-ADDRESS HpSomBinaryFile::GetAddressByName(char* pName, bool bNoTypeOK /* = false */)
-{
-    // For now, we ignore the symbol table and do a linear search of our
-    // SymTab table
-    ADDRESS res = symbols.find(pName);
-    if (res == NO_ADDRESS)
-        return 0; // Till the failure return value is fixed
-    return res;
-}
-
 bool HpSomBinaryFile::IsDynamicLinkedProc(ADDRESS uNative)
 {
     // Look up the address in the set of imports
@@ -612,7 +595,7 @@ std::map<ADDRESS, const char*>* HpSomBinaryFile::GetDynamicGlobalMap()
 
 ADDRESS HpSomBinaryFile::GetMainEntryPoint()
 {
-    return symbols.find("main");
+    return m_Symbols.find("main");
 #if 0
     if (mainExport == 0)
         {
@@ -29,7 +29,6 @@
  *============================================================================*/
 
 #include "BinaryFile.h"
-#include "SymTab.h"
 #include <set>
 
 struct import_entry
@@ -112,10 +111,6 @@ public:
     virtual ADDRESS getImageBase();
     virtual size_t getImageSize();
 
-    // Get a symbol given an address
-    virtual const char* SymbolByAddress(ADDRESS dwAddr);
-    // Lookup the name, return the address
-    virtual ADDRESS GetAddressByName(char* pName, bool bNoTypeOK = false);
     // Return true if the address matches the convention for A-line system calls
     bool IsDynamicLinkedProc(ADDRESS uNative);
 
@@ -154,7 +149,6 @@ private:
     std::pair<ADDRESS, int> getSubspaceInfo(const char* ssname);
 
     unsigned char* m_pImage; // Points to loaded image
-    SymTab symbols; // Symbol table object
     //		ADDRESS		mainExport;					// Export entry for "main"
     std::set<ADDRESS> imports; // Set of imported proc addr's
     const char *m_pFileName;
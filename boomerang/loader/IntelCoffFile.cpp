@@ -433,11 +433,6 @@ extern "C" {
     }
 }
 
-const char* IntelCoffFile::SymbolByAddress(const ADDRESS dwAddr)
-{
-    return m_Symbols.find(dwAddr);
-}
-
 bool IntelCoffFile::IsDynamicLinkedProc(ADDRESS uNative)
 {
     if (uNative >= (unsigned)0xc0000000)
@@ -454,11 +449,6 @@ bool IntelCoffFile::IsRelocationAt(ADDRESS uNative)
     return false;
 }
 
-std::map<ADDRESS, std::string>& IntelCoffFile::getSymbols()
-{
-    return m_Symbols.getAll();
-}
-
 unsigned char* IntelCoffFile::getAddrPtr(ADDRESS a, ADDRESS range)
 {
     for ( int iSection = 0; iSection < m_iNumSections; iSection++ )
@@ -3,7 +3,6 @@
 
 #include <stdint.h>
 #include "BinaryFile.h"
-#include "SymTab.h"
 
 #define PACKED __attribute__((packed))
 
@@ -45,13 +44,8 @@ public:
     virtual ADDRESS     GetEntryPoint();
     virtual std::list<SectionInfo*>& GetEntryPoints(const char* pEntry = "main");
 
-    virtual const char* SymbolByAddress(ADDRESS uNative);
-    // Lookup the name, return the address. If not found, return NO_ADDRESS
-    // virtual ADDRESS         GetAddressByName(const char* pName, bool bNoTypeOK = false);
-    // virtual void            AddSymbol(ADDRESS uNative, const char *pName) { }
     virtual bool IsDynamicLinkedProc(ADDRESS uNative);
     virtual bool IsRelocationAt(ADDRESS uNative);
-    virtual std::map<ADDRESS, std::string> &getSymbols();
 
     virtual int readNative4(ADDRESS a);
     virtual int readNative2(ADDRESS a);
@@ -70,8 +64,6 @@ private:
     PSectionInfo AddSection(SectionInfo*);
     unsigned char* getAddrPtr(ADDRESS a, ADDRESS range);
     int readNative(ADDRESS a, unsigned short n);
-
-    SymTab m_Symbols;
 };
 
 #endif	// !defined(__INTELCOFFFILE_H__)
@@ -606,3 +606,48 @@ void LoaderTest::testElfHash ()
     CPPUNIT_ASSERT_EQUAL(exp, act);
 #endif
 }
+
+/*==============================================================================
+ * FUNCTION:		LoaderTest::testSymTab
+ * OVERVIEW:		Test the symbol table: lookups by address and name, replacing names, nearest symbol, and order
+ *============================================================================*/
+void LoaderTest::testSymTab ()
+{
+    SymTab st;
+    st.reserve(4);
+    st.Add(0x3000, "three");
+    st.Add(0x1000, "one");			// Out of order
+    st.Add(0x2000, "two");
+    st.Add(0x4000, "two");			// Same name again
+    CPPUNIT_ASSERT_EQUAL(std::string("one"), std::string(st.find(0x1000)));
+    CPPUNIT_ASSERT(st.find(0x1004) == NULL);
+    CPPUNIT_ASSERT_EQUAL((ADDRESS)0x3000, st.find("three"));
+    CPPUNIT_ASSERT_EQUAL((ADDRESS)0x2000, st.find("two"));		// The lowest
+    CPPUNIT_ASSERT_EQUAL(NO_ADDRESS, st.find("four"));
+    // Names are interned
+    CPPUNIT_ASSERT(st.find(0x2000) == st.find(0x4000));
+
+    // Renaming 0x2000 leaves 0x4000 as the only "two"
+    st.Add(0x2000, "deux");
+    CPPUNIT_ASSERT_EQUAL((ADDRESS)0x4000, st.find("two"));
+    CPPUNIT_ASSERT_EQUAL((ADDRESS)0x2000, st.find("deux"));
+    CPPUNIT_ASSERT_EQUAL(4, (int)st.size());
+
+    ADDRESS a;
+    CPPUNIT_ASSERT_EQUAL(std::string("deux"), std::string(st.findNearest(0x2ffc, a)));
+    CPPUNIT_ASSERT_EQUAL((ADDRESS)0x2000, a);
+    CPPUNIT_ASSERT_EQUAL(std::string("three"), std::string(st.findNearest(0x3000, a)));
+    CPPUNIT_ASSERT(st.findNearest(0xffc, a) == NULL);
+
+    // In address order
+    ADDRESS last = 0;
+    for (SymTab::iterator it = st.begin(); it != st.end(); ++it)
+        {
+            CPPUNIT_ASSERT(it->addr > last);
+            last = it->addr;
+        }
+    CPPUNIT_ASSERT_EQUAL((ADDRESS)0x4000, last);
+    std::map<ADDRESS, std::string>& all = st.getAll();
+    CPPUNIT_ASSERT_EQUAL(4, (int)all.size());
+    CPPUNIT_ASSERT_EQUAL(std::string("deux"), all[0x2000]);
+}
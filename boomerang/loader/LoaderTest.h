@@ -11,6 +11,7 @@ class LoaderTest : public CPPUNIT_NS::TestFixture
     CPPUNIT_TEST( testMicroDis1 );
     CPPUNIT_TEST( testMicroDis2 );
     CPPUNIT_TEST( testElfHash );
+    CPPUNIT_TEST( testSymTab );
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -28,5 +29,6 @@ protected:
     void testMicroDis2();
 
     void testElfHash();
+    void testSymTab();
 };
 
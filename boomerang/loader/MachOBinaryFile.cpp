@@ -356,12 +356,13 @@ bool MachOBinaryFile::RealLoad(const char* sName)
                     char *name = strtbl + BMMH(symbols[symbol].n_un.n_strx);
                     if (*name == '_')  // we want printf not _printf
                         name++;
-                    m_SymA[addr] = name;
+                    m_Symbols.Add(addr, name);
                     dlprocs[addr] = name;
                 }
         }
 
     // process the remaining symbols
+    m_Symbols.reserve(m_Symbols.size() + symbols.size());
     for (unsigned i = 0; i < symbols.size(); i++)
         {
             char *name = strtbl + BMMH(symbols[i].n_un.n_strx);
@@ -375,7 +376,7 @@ bool MachOBinaryFile::RealLoad(const char* sName)
 #endif
                     if (*name == '_')  // we want main not _main
                         name++;
-                    m_SymA[BMMH(symbols[i].n_value)] = name;
+                    m_Symbols.Add(BMMH(symbols[i].n_value), name);
                 }
         }
 
@@ -455,35 +456,6 @@ bool MachOBinaryFile::PostLoad(void* handle)
     return false;
 }
 
-const char* MachOBinaryFile::SymbolByAddress(ADDRESS dwAddr)
-{
-    std::map<ADDRESS, std::string>::iterator it = m_SymA.find(dwAddr);
-    if (it == m_SymA.end())
-        return 0;
-    return (char*) it->second.c_str();
-}
-
-ADDRESS MachOBinaryFile::GetAddressByName(const char* pName,
-        bool bNoTypeOK /* = false */)
-{
-    // This is "looking up the wrong way" and hopefully is uncommon
-    // Use linear search
-    std::map<ADDRESS, std::string>::iterator it = m_SymA.begin();
-    while (it != m_SymA.end())
-        {
-            // std::cerr << "Symbol: " << it->second.c_str() << " at 0x" << std::hex << it->first << "\n";
-            if (strcmp(it->second.c_str(), pName) == 0)
-                return it->first;
-            it++;
-        }
-    return NO_ADDRESS;
-}
-
-void MachOBinaryFile::AddSymbol(ADDRESS uNative, const char *pName)
-{
-    m_SymA[uNative] = pName;
-}
-
 bool MachOBinaryFile::DisplayDetails(const char* fileName, FILE* f
                                      /* = stdout */)
 {
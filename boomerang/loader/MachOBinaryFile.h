@@ -79,10 +79,6 @@ public:
     virtual ADDRESS		GetMainEntryPoint();
     virtual ADDRESS		GetEntryPoint();
     ptrdiff_t		getDelta();
-    virtual const char*	SymbolByAddress(ADDRESS dwAddr); // Get sym from addr
-    virtual ADDRESS		GetAddressByName(const char* name,
-                                         bool		bNoTypeOK = false);					// Find addr given name
-    virtual void		AddSymbol(ADDRESS uNative, const char *pName);
 
 //
 //		--		--		--		--		--		--		--		--		--
@@ -125,10 +121,6 @@ public:
     }
     virtual const char	*GetDynamicProcName(ADDRESS uNative);
 
-    virtual std::map<ADDRESS, std::string> &getSymbols()
-    {
-        return m_SymA;
-    }
     virtual std::map<std::string, ObjcModule> &getObjcModules()
     {
         return modules;
@@ -149,7 +141,7 @@ private:
     unsigned	loaded_size;
     MACHINE         machine;
     bool            swap_bytes;
-    std::map<ADDRESS, std::string> m_SymA, dlprocs;
+    std::map<ADDRESS, std::string> dlprocs;
     std::map<std::string, ObjcModule> modules;
     std::vector<struct section> sections;
 };
@@ -9,8 +9,8 @@
 
 /*==============================================================================
  * FILE:        SymTab.cpp
- * OVERVIEW:    This file contains the implementation of the class SymTab, a simple class to maintain a pair of maps
- *				so that symbols can be accessed by symbol or by name
+ * OVERVIEW:    This file contains the implementation of the class SymTab, the symbol table of a BinaryFile, which
+ *				can be accessed by address or by name
  *============================================================================*/
 /*
  * $Revision$
@@ -19,34 +19,251 @@
 */
 
 #include "SymTab.h"
+#include <cstring>
+#include <algorithm>
 
-SymTab::SymTab()
+#define POOL_BLOCK 65536				// Size of the blocks of the name pool
+
+static bool symLess(const SymTab::Symbol& x, const SymTab::Symbol& y)
+{
+    return x.addr < y.addr;
+}
+
+static bool symAddrLess(const SymTab::Symbol& x, ADDRESS a)
+{
+    return x.addr < a;
+}
+
+static unsigned hashName(const char* s)
+{
+    // FNV-1a
+    unsigned h = 2166136261u;
+    for (; *s; s++)
+        h = (h ^ (unsigned char)*s) * 16777619u;
+    return h;
+}
+
+static unsigned hashAddr(ADDRESS a)
+{
+    unsigned h = (unsigned)a ^ (unsigned)((unsigned long long)a >> 32);
+    return (h ^ (h >> 16)) * 2654435761u;
+}
+
+SymTab::SymTab() : sorted(true), numNames(0), poolNext(NULL), poolLeft(0), amapValid(false)
 {}
 
 SymTab::~SymTab()
-{}
+{
+    for (unsigned i = 0; i < pool.size(); i++)
+        delete [] pool[i];
+}
+
+// Return the slot for name s with hash h, or the empty slot where it would go
+SymTab::NameSlot* SymTab::findName(const char* s, unsigned h)
+{
+    unsigned mask = nameIndex.size() - 1;
+    for (unsigned i = h & mask; ; i = (i + 1) & mask)
+        {
+            NameSlot *slot = &nameIndex[i];
+            if (slot->name == NULL || (slot->hash == h && strcmp(slot->name, s) == 0))
+                return slot;
+        }
+}
+
+// Return the slot for name s, adding the name to the pool and the table if it is new
+SymTab::NameSlot* SymTab::intern(const char* s)
+{
+    if ((numNames + 1) * 2 > nameIndex.size())
+        {
+            // Grow the table
+            std::vector<NameSlot> old;
+            old.swap(nameIndex);
+            NameSlot empty = {NULL, 0, NO_ADDRESS};
+            nameIndex.assign(old.empty() ? 64 : old.size() * 2, empty);
+            for (unsigned i = 0; i < old.size(); i++)
+                if (old[i].name)
+                    *findName(old[i].name, old[i].hash) = old[i];
+        }
+    unsigned h = hashName(s);
+    NameSlot *slot = findName(s, h);
+    if (slot->name)
+        return slot;
+    unsigned len = strlen(s) + 1;
+    char *p;
+    if (len > POOL_BLOCK / 4)
+        {
+            // Big names get a block of their own, so little of the current block is wasted
+            p = new char[len];
+            pool.push_back(p);
+        }
+    else
+        {
+            if (len > poolLeft)
+                {
+                    poolNext = new char[POOL_BLOCK];
+                    poolLeft = POOL_BLOCK;
+                    pool.push_back(poolNext);
+                }
+            p = poolNext;
+            poolNext += len;
+            poolLeft -= len;
+        }
+    memcpy(p, s, len);
+    slot->name = p;
+    slot->hash = h;
+    slot->addr = NO_ADDRESS;
+    numNames++;
+    return slot;
+}
+
+// Return the index in syms of the symbol at a, or -1 if none
+int SymTab::findAddr(ADDRESS a)
+{
+    if (addrIndex.empty())
+        return -1;
+    unsigned mask = addrIndex.size() - 1;
+    for (unsigned i = hashAddr(a) & mask; ; i = (i + 1) & mask)
+        {
+            int j = addrIndex[i];
+            if (j < 0)
+                return -1;
+            if (syms[j].addr == a)
+                return j;
+        }
+}
+
+void SymTab::insertAddr(ADDRESS a, int j)
+{
+    unsigned mask = addrIndex.size() - 1;
+    unsigned i = hashAddr(a) & mask;
+    while (addrIndex[i] >= 0)
+        i = (i + 1) & mask;
+    addrIndex[i] = j;
+}
 
-void SymTab::Add(ADDRESS a, char* s)
+// Remake the address table with the given number of slots (a power of 2)
+void SymTab::rehashAddrs(unsigned size)
 {
-    amap[a] = s;
-    smap[s] = a;
+    addrIndex.assign(size, -1);
+    for (unsigned j = 0; j < syms.size(); j++)
+        insertAddr(syms[j].addr, j);
+}
+
+// The symbol at a is no longer called slot's name. If that was the lowest address with the name, find the next one
+void SymTab::renamed(NameSlot *slot, ADDRESS a)
+{
+    if (slot->addr != a)
+        return;
+    slot->addr = NO_ADDRESS;
+    for (unsigned j = 0; j < syms.size(); j++)
+        if (syms[j].name == slot->name && syms[j].addr < slot->addr)
+            slot->addr = syms[j].addr;
+}
+
+void SymTab::sort()
+{
+    if (sorted)
+        return;
+    std::sort(syms.begin(), syms.end(), symLess);
+    rehashAddrs(addrIndex.size());
+    sorted = true;
+}
+
+void SymTab::reserve(unsigned n)
+{
+    syms.reserve(n);
+    unsigned size = 64;
+    while (size < n * 2)
+        size *= 2;
+    if (size > addrIndex.size())
+        rehashAddrs(size);
+}
+
+void SymTab::Add(ADDRESS a, const char* s)
+{
+    NameSlot *slot = intern(s);
+    amapValid = false;
+    int j = findAddr(a);
+    if (j >= 0)
+        {
+            // Replace the name of an existing symbol
+            const char *old = syms[j].name;
+            if (old == slot->name)
+                return;
+            syms[j].name = slot->name;
+            if (a < slot->addr)
+                slot->addr = a;
+            renamed(findName(old, hashName(old)), a);
+            return;
+        }
+    if (!syms.empty() && a < syms.back().addr)
+        sorted = false;
+    Symbol sym = {a, slot->name};
+    syms.push_back(sym);
+    if (syms.size() * 2 > addrIndex.size())
+        rehashAddrs(addrIndex.empty() ? 64 : addrIndex.size() * 2);
+    else
+        insertAddr(a, syms.size() - 1);
+    if (a < slot->addr)
+        slot->addr = a;
 }
 
 const char* SymTab::find(ADDRESS a)
 {
-    std::map<ADDRESS, std::string>::iterator ff;
-    ff = amap.find(a);
-    if (ff == amap.end())
+    int j = findAddr(a);
+    if (j < 0)
         return NULL;
-    return ff->second.c_str();
+    return syms[j].name;
 }
 
 ADDRESS SymTab::find(const char* s)
 {
-    std::map<std::string, ADDRESS>::iterator ff;
-    ff = smap.find(s);
-    if (ff == smap.end())
+    if (nameIndex.empty())
+        return NO_ADDRESS;
+    NameSlot *slot = findName(s, hashName(s));
+    if (slot->name == NULL)
         return NO_ADDRESS;
-    return ff->second;
+    return slot->addr;
 }
 
+const char* SymTab::findNearest(ADDRESS a, ADDRESS& symAddr)
+{
+    iterator it = lowerBound(a);
+    if (it == syms.end() || it->addr != a)
+        {
+            if (it == syms.begin())
+                return NULL;
+            --it;
+        }
+    symAddr = it->addr;
+    return it->name;
+}
+
+SymTab::iterator SymTab::begin()
+{
+    sort();
+    return syms.begin();
+}
+
+SymTab::iterator SymTab::end()
+{
+    return syms.end();
+}
+
+SymTab::iterator SymTab::lowerBound(ADDRESS a)
+{
+    sort();
+    return std::lower_bound(syms.begin(), syms.end(), a, symAddrLess);
+}
+
+std::map<ADDRESS, std::string>& SymTab::getAll()
+{
+    if (!amapValid)
+        {
+            amap.clear();
+            for (iterator it = begin(); it != syms.end(); ++it)
+                amap.insert(amap.end(), std::pair<ADDRESS, std::string>(it->addr, it->name));
+            amapValid = true;
+        }
+    return amap;
+}
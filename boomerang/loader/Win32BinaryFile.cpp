@@ -217,9 +217,9 @@ ADDRESS Win32BinaryFile::GetMainEntryPoint()
                             // Opcode FF 15 is indirect call
                             // Get the 4 byte address from the instruction
                             addr = LMMH(*(p + base + 2));
-//					const char *c = dlprocptrs[addr].c_str();
+//					const char *c = m_Symbols.find(addr);
 //					printf("Checking %x finding %s\n", addr, c);
-                            if (dlprocptrs[addr] == "exit")
+                            if (isSymbol(addr, "exit"))
                                 {
                                     if (gap <= 10)
                                         {
@@ -291,12 +291,12 @@ ADDRESS Win32BinaryFile::GetMainEntryPoint()
     if (*(unsigned char*)(p + base + 0x20) == 0xff && *(unsigned char*)(p + base + 0x21) == 0x15)
         {
             unsigned int desti = LMMH(*(p + base + 0x22));
-            if (dlprocptrs.find(desti) != dlprocptrs.end() && dlprocptrs[desti] == "GetVersionExA")
+            if (isSymbol(desti, "GetVersionExA"))
                 {
                     if (*(unsigned char*)(p + base + 0x6d) == 0xff && *(unsigned char*)(p + base + 0x6e) == 0x15)
                         {
                             desti = LMMH(*(p + base + 0x6f));
-                            if (dlprocptrs.find(desti) != dlprocptrs.end() && dlprocptrs[desti] == "GetModuleHandleA")
+                            if (isSymbol(desti, "GetModuleHandleA"))
                                 {
                                     if (*(unsigned char*)(p + base + 0x16e) == 0xe8)
                                         {
@@ -384,7 +384,7 @@ ADDRESS Win32BinaryFile::GetMainEntryPoint()
                             unsigned int desti = LMMH(*(dest + base + 2));
                             // skip all the call statements until we hit a call to an indirect call to ExitProcess
                             // main is the 2nd call before this one
-                            if (op2 == 0xff && op2a == 0x25 && dlprocptrs.find(desti) != dlprocptrs.end() && dlprocptrs[desti] == "ExitProcess")
+                            if (op2 == 0xff && op2a == 0x25 && isSymbol(desti, "ExitProcess"))
                                 {
                                     mingw_main = true;
                                     return lastlastcall + 5 + LMMH(*(lastlastcall + base + 1)) + LMMH(m_pPEHeader->Imagebase);
@@ -424,7 +424,7 @@ ADDRESS Win32BinaryFile::GetMainEntryPoint()
                 {
                     // indirect CALL opcode
                     unsigned int desti = LMMH(*(p + base + 2));
-                    if (dlprocptrs.find(desti) != dlprocptrs.end() && dlprocptrs[desti] == "GetModuleHandleA")
+                    if (isSymbol(desti, "GetModuleHandleA"))
                         {
                             gotGMHA = true;
                         }
@@ -560,17 +560,17 @@ bool Win32BinaryFile::RealLoad(const char* sName)
                                         if (nodots[j] == '.')
                                             nodots[j] = '_';	// Dots can't be in identifiers
                                     ost << nodots << "_" << (iatEntry & 0x7FFFFFFF);
-                                    dlprocptrs[paddr] = ost.str();
+                                    m_Symbols.Add(paddr, ost.str().c_str());
                                     // printf("Added symbol %s value %x\n", ost.str().c_str(), paddr);
                                 }
                             else
                                 {
                                     // Normal case (IMAGE_IMPORT_BY_NAME). Skip the useless hint (2 bytes)
                                     std::string name((const char*)(iatEntry+2+base));
-                                    dlprocptrs[paddr] = name;
+                                    m_Symbols.Add(paddr, name.c_str());
                                     if (paddr != (unsigned char *)iat - base + LMMH(m_pPEHeader->Imagebase))
-                                        dlprocptrs[(unsigned char *)iat - base + LMMH(m_pPEHeader->Imagebase)]
-                                            = std::string("old_") + name; // add both possibilities
+                                        m_Symbols.Add((unsigned char *)iat - base + LMMH(m_pPEHeader->Imagebase),
+                                                      (std::string("old_") + name).c_str()); // add both possibilities
                                     // printf("Added symbol %s value %x\n", name.c_str(), paddr);
                                     // printf("Also added old_%s value %x\n", name.c_str(), (int)iat - (int)base +
                                     // 		LMMH(m_pPEHeader->Imagebase));
@@ -593,9 +593,8 @@ bool Win32BinaryFile::RealLoad(const char* sName)
     ADDRESS entry = GetMainEntryPoint();
     if (entry != NO_ADDRESS)
         {
-            std::map<ADDRESS, std::string>::iterator it = dlprocptrs.find(entry);
-            if (it == dlprocptrs.end())
-                dlprocptrs[entry] = "main";
+            if (m_Symbols.find(entry) == NULL)
+                m_Symbols.Add(entry, "main");
         }
 
     // Give a name to any jumps you find to these import entries
@@ -671,12 +670,10 @@ void Win32BinaryFile::findJumps(ADDRESS curr)
             cnt += 2;
             if (LH(delta+curr) != 0xFF + (0x25<<8)) continue;
             ADDRESS operand = LMMH2(delta+curr+2);
-            std::map<ADDRESS, std::string>::iterator it;
-            it = dlprocptrs.find(operand);
-            if (it == dlprocptrs.end()) continue;
-            std::string sym = it->second;
-            dlprocptrs[operand] = "__imp_" + sym;
-            dlprocptrs[curr] = sym;		 // Add new entry
+            const char *sym = m_Symbols.find(operand);
+            if (sym == NULL) continue;
+            m_Symbols.Add(operand, (std::string("__imp_") + sym).c_str());
+            m_Symbols.Add(curr, sym);		 // Add new entry
             // std::cerr << "Added " << sym << " at 0x" << std::hex << curr << "\n";
             curr -= 4;					// Next match is at least 4+2 bytes away
             cnt = 0;
@@ -939,30 +936,13 @@ const char* Win32BinaryFile::SymbolByAddress(ADDRESS dwAddr)
         return SymbolByAddress(IsJumpToAnotherAddr(dwAddr));
 #endif
 
-    std::map<ADDRESS, std::string>::iterator it = dlprocptrs.find(dwAddr);
-    if (it == dlprocptrs.end())
-        return 0;
-    return (char*) it->second.c_str();
+    return m_Symbols.find(dwAddr);
 }
 
-ADDRESS Win32BinaryFile::GetAddressByName(const char* pName,
-        bool bNoTypeOK /* = false */)
+bool Win32BinaryFile::isSymbol(ADDRESS uNative, const char* name)
 {
-    // This is "looking up the wrong way" and hopefully is uncommon.  Use linear search
-    std::map<ADDRESS, std::string>::iterator it = dlprocptrs.begin();
-    while (it != dlprocptrs.end())
-        {
-            // std::cerr << "Symbol: " << it->second.c_str() << " at 0x" << std::hex << it->first << "\n";
-            if (strcmp(it->second.c_str(), pName) == 0)
-                return it->first;
-            it++;
-        }
-    return NO_ADDRESS;
-}
-
-void Win32BinaryFile::AddSymbol(ADDRESS uNative, const char *pName)
-{
-    dlprocptrs[uNative] = pName;
+    const char *sym = m_Symbols.find(uNative);
+    return sym && strcmp(sym, name) == 0;
 }
 
 bool Win32BinaryFile::DisplayDetails(const char* fileName, FILE* f
@@ -1062,9 +1042,7 @@ double Win32BinaryFile::readNativeFloat8(ADDRESS nat)
 
 bool Win32BinaryFile::IsDynamicLinkedProcPointer(ADDRESS uNative)
 {
-    if (dlprocptrs.find(uNative) != dlprocptrs.end())
-        return true;
-    return false;
+    return m_Symbols.find(uNative) != NULL;
 }
 
 bool Win32BinaryFile::IsStaticLinkedLibProc(ADDRESS uNative)
@@ -1229,7 +1207,8 @@ ADDRESS Win32BinaryFile::IsJumpToAnotherAddr(ADDRESS uNative)
 
 const char *Win32BinaryFile::GetDynamicProcName(ADDRESS uNative)
 {
-    return dlprocptrs[uNative].c_str();
+    const char *name = m_Symbols.find(uNative);
+    return name ? name : "";
 }
 
 LOAD_FMT Win32BinaryFile::GetFormat() const
@@ -1286,10 +1265,10 @@ extern "C"
 
 void Win32BinaryFile::dumpSymbols()
 {
-    std::map<ADDRESS, std::string>::iterator it;
+    SymTab::iterator it;
     std::cerr << std::hex;
-    for (it = dlprocptrs.begin(); it != dlprocptrs.end(); ++it)
-        std::cerr << "0x" << it->first << " " << it->second << "        ";
+    for (it = m_Symbols.begin(); it != m_Symbols.end(); ++it)
+        std::cerr << "0x" << it->addr << " " << it->name << "        ";
     std::cerr << std::dec << "\n";
 }
 
@@ -194,8 +194,6 @@ public:
     virtual ADDRESS		GetEntryPoint();
     ptrdiff_t		getDelta();
     virtual const char* SymbolByAddress(ADDRESS dwAddr); // Get sym from addr
-    virtual ADDRESS		GetAddressByName(const char* name, bool bNoTypeOK = false);		// Find addr given name
-    virtual void		AddSymbol(ADDRESS uNative, const char *pName);
     void		dumpSymbols();					// For debugging
 
 //
@@ -230,11 +228,6 @@ public:
     bool		IsMinGWsCleanupSetup(ADDRESS uNative);
     bool		IsMinGWsMalloc(ADDRESS uNative);
 
-    virtual std::map<ADDRESS, std::string> &getSymbols()
-    {
-        return dlprocptrs;
-    }
-
     bool		hasDebugInfo()
     {
         return haveDebugInfo;
@@ -247,6 +240,7 @@ private:
 
     bool		PostLoad(void* handle); // Called after archive member loaded
     void		findJumps(ADDRESS curr);// Find names for jumps to IATs
+    bool		isSymbol(ADDRESS uNative, const char* name);	// True if the symbol at uNative is name
 
     Header* 	m_pHeader;				// Pointer to header
     PEHeader* 	m_pPEHeader;			// Pointer to pe header
@@ -254,8 +248,6 @@ private:
     int			m_cReloc;				// Number of relocation entries
     DWord*		m_pRelocTable;			// The relocation table
     unsigned char *base;					// Beginning of the loaded image
-    // Map from address of dynamic pointers to library procedure names:
-    std::map<ADDRESS, std::string> dlprocptrs;
     const char	*m_pFileName;
     bool		haveDebugInfo;
     bool        mingw_main;
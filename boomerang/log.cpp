@@ -143,6 +143,40 @@ Log &Log::operator<<(size_t s)
 void Log::tail()
 {}
 
+// Other threads' text is written a line at a time, so that their messages are not interleaved with each other
+Log &FileLogger::operator<<(const char *str)
+{
+    Lock lock(mutex);
+#if HAVE_THREADS
+    pthread_t self = pthread_self();
+    if (!pthread_equal(self, mainThread))
+        {
+            std::string &buf = pending[self];
+            buf += str;
+            std::string::size_type nl = buf.rfind('\n');
+            if (nl != std::string::npos)
+                {
+                    out.write(buf.data(), nl + 1);
+                    out << std::flush;
+                    buf.erase(0, nl + 1);
+                }
+            if (buf.empty())
+                pending.erase(self);
+            return *this;
+        }
+#endif
+    out << str << std::flush;
+    return *this;
+}
+
+FileLogger::~FileLogger()
+{
+#if HAVE_THREADS
+    for (std::map<pthread_t, std::string>::iterator it = pending.begin(); it != pending.end(); it++)
+        out << it->second;
+#endif
+}
+
 void FileLogger::tail()
 {
     out.seekp(-200, std::ios::end);
@@ -0,0 +1,572 @@
+/*
+ * See the file "LICENSE.TERMS" for information on usage and
+ * redistribution of this file, and for a DISCLAIMER OF ALL WARRANTIES.
+ *
+ */
+
+/*==============================================================================
+ * FILE:	   microbench.cpp
+ * OVERVIEW:   Microbenchmarks for the hot primitives of the expression and statement core, so that work on them can be
+ *				measured in isolation. Each benchmark is run for more and more iterations until it has taken at least
+ *				the minimum time, and the time per iteration is printed.
+ *				Usage: MicroBench [-t <min seconds>] [<boomerang directory> [<name substring>]]
+ *				Built when cmake is given -DBUILD_BENCHMARKS=ON.
+ *============================================================================*/
+
+#include <iostream>
+#include <iomanip>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include "config.h"
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#else
+#include <direct.h>
+#endif
+#ifndef _WIN32
+#include <sys/mman.h>		// For MAP_32BIT
+#endif
+#include "types.h"
+#include "exp.h"
+#include "exphelp.h"
+#include "visitor.h"
+#include "managed.h"
+#include "statement.h"
+#include "rtl.h"
+#include "cfg.h"
+#include "dataflow.h"
+#include "proc.h"
+#include "prog.h"
+#include "signature.h"
+#include "boomerang.h"
+#include "log.h"
+#include "BinaryFile.h"
+#include "frontend.h"
+#include "decoder.h"
+#include "pentiumdecoder.h"
+#include "pentiumfrontend.h"
+
+#define HELLO_PENTIUM		"test/pentium/hello"
+#define PENTIUM_SSL			"frontend/machine/pentium/pentium.ssl"
+
+// A benchmark does the operation n times and returns the number of seconds spent in the part being measured, so
+// that it can leave out its setup. It returns a negative time if it can't be run (e.g. missing input files)
+typedef double (*BenchFunc)(int n);
+
+struct Benchmark
+{
+    const char*	name;
+    BenchFunc	func;
+};
+
+static double seconds(clock_t from, clock_t to)
+{
+    return (double)(to - from) / CLOCKS_PER_SEC;
+}
+
+// Free a whole expression tree. The Exp destructors leave the children alone, since the garbage collector normally
+// takes care of them; without it the benchmarks would run out of memory
+static void destroy(Exp* e)
+{
+    switch (e->getArity())
+        {
+        case 3:
+            destroy(((Ternary*)e)->getSubExp3());
+        case 2:
+            destroy(((Binary*)e)->getSubExp2());
+        case 1:
+            destroy(((Unary*)e)->getSubExp1());
+        default:
+            break;
+        }
+    delete e;
+}
+
+// m[r28{1} - 12] + r24{2} * (r25{-} - 4), with d1 and d2 the definitions of r28 and r24
+static Exp* sampleExp(Statement* d1, Statement* d2)
+{
+    return new Binary(opPlus,
+                      Location::memOf(
+                          new Binary(opMinus,
+                                     new RefExp(Location::regOf(28), d1),
+                                     new Const(12))),
+                      new Binary(opMult,
+                                 new RefExp(Location::regOf(24), d2),
+                                 new Binary(opMinus,
+                                            new RefExp(Location::regOf(25), NULL),
+                                            new Const(4))));
+}
+
+/*==============================================================================
+ * Expressions
+ *============================================================================*/
+
+static void destroyAll(std::vector<Exp*>& exps)
+{
+    for (unsigned i = 0; i < exps.size(); i++)
+        destroy(exps[i]);
+}
+
+static double benchClone(int n)
+{
+    Assign d1(Location::regOf(28), new Const(1000)), d2(Location::regOf(24), new Const(5));
+    Exp* e = sampleExp(&d1, &d2);
+    std::vector<Exp*> clones(n);
+    clock_t start = clock();
+    for (int i = 0; i < n; i++)
+        clones[i] = e->clone();
+    clock_t end = clock();
+    destroyAll(clones);
+    return seconds(start, end);
+}
+
+static double benchLessExpStar(int n)
+{
+    Assign d1(Location::regOf(28), new Const(1000)), d2(Location::regOf(24), new Const(5));
+    // Two expressions that only differ at their last leaf, so the whole tree is compared
+    Exp* e1 = sampleExp(&d1, &d2);
+    Exp* e2 = sampleExp(&d1, &d2);
+    ((Const*)((Binary*)((Binary*)((Binary*)e2)->getSubExp2())->getSubExp2())->getSubExp2())->setInt(5);
+    lessExpStar lt;
+    int count = 0;
+    clock_t start = clock();
+    for (int i = 0; i < n; i++)
+        count += lt(e1, e2) + lt(e2, e1);
+    clock_t end = clock();
+    if (count != n) std::cerr << "lessExpStar is not a strict ordering!\n";
+    return seconds(start, end);
+}
+
+// (r24{-} + 8 - 8) * 1 + (m[r28{-} + 4 - 4] & -1): simplifies to r24{-} + m[r28{-}]
+static Exp* simplifiableExp()
+{
+    return new Binary(opPlus,
+                      new Binary(opMult,
+                                 new Binary(opMinus,
+                                            new Binary(opPlus, new RefExp(Location::regOf(24), NULL), new Const(8)),
+                                            new Const(8)),
+                                 new Const(1)),
+                      new Binary(opBitAnd,
+                                 Location::memOf(
+                                     new Binary(opMinus,
+                                                new Binary(opPlus, new RefExp(Location::regOf(28), NULL), new Const(4)),
+                                                new Const(4))),
+                                 new Const(-1)));
+}
+
+static double benchSimplify(int n)
+{
+    std::vector<Exp*> exps(n);
+    for (int i = 0; i < n; i++)
+        exps[i] = simplifiableExp();
+    clock_t start = clock();
+    for (int i = 0; i < n; i++)
+        exps[i] = exps[i]->simplify();
+    clock_t end = clock();
+    destroyAll(exps);
+    return seconds(start, end);
+}
+
+static double benchPolySimplify(int n)
+{
+    std::vector<Exp*> exps(n);
+    for (int i = 0; i < n; i++)
+        exps[i] = simplifiableExp();
+    bool bMod = false;
+    clock_t start = clock();
+    for (int i = 0; i < n; i++)
+        exps[i] = exps[i]->polySimplify(bMod);
+    clock_t end = clock();
+    destroyAll(exps);
+    return seconds(start, end);
+}
+
+static double benchSearchReplace(int n)
+{
+    Assign d1(Location::regOf(28), new Const(1000)), d2(Location::regOf(24), new Const(5));
+    RefExp search(Location::regOf(24), &d2);
+    Exp* replace = Location::local("x", NULL);
+    std::vector<Exp*> exps(n);
+    for (int i = 0; i < n; i++)
+        exps[i] = sampleExp(&d1, &d2);
+    bool change;
+    clock_t start = clock();
+    for (int i = 0; i < n; i++)
+        exps[i] = exps[i]->searchReplaceAll(&search, replace, change);
+    clock_t end = clock();
+    destroyAll(exps);
+    return seconds(start, end);
+}
+
+// The facts propagateTo needs about the RHS of a definition used more than once: one walk each. An iteration is the
+// facts for one definition. The facts are summed into factsFound so that the walks can't be optimised away
+int factsFound = 0;
+static double benchPropagationFactsSeparate(int n)
+{
+    Assign d1(Location::regOf(28), new Const(1000)), d2(Location::regOf(24), new Const(5));
+    Exp* e = sampleExp(&d1, &d2);
+    clock_t start = clock();
+    for (int i = 0; i < n; i++)
+        {
+            BadMemofFinder bmf(NULL);
+            ComplexityFinder cf(NULL);
+            FlagsFinder ff;
+            e->accept(&bmf);
+            e->accept(&cf);
+            e->accept(&ff);
+            factsFound += bmf.isFound() + cf.getDepth() + ff.isFound();
+        }
+    clock_t end = clock();
+    destroy(e);
+    return seconds(start, end);
+}
+
+// As above, in one FusedExpVisitor walk
+static double benchPropagationFactsFused(int n)
+{
+    Assign d1(Location::regOf(28), new Const(1000)), d2(Location::regOf(24), new Const(5));
+    Exp* e = sampleExp(&d1, &d2);
+    clock_t start = clock();
+    for (int i = 0; i < n; i++)
+        {
+            FusedExpVisitor fev;
+            BadMemofFinder bmf(NULL);
+            ComplexityFinder cf(NULL);
+            FlagsFinder ff;
+            fev.add(&bmf);
+            fev.add(&cf);
+            fev.add(&ff);
+            e->accept(&fev);
+            factsFound += bmf.isFound() + cf.getDepth() + ff.isFound();
+        }
+    clock_t end = clock();
+    destroy(e);
+    return seconds(start, end);
+}
+
+/*==============================================================================
+ * Statements and sets
+ *============================================================================*/
+
+static double benchInstantiateRTL(int n)
+{
+    RTLInstDict dict;
+    dict.readSSLFile(PENTIUM_SSL);
+    // As the decoder would for addl $4, -8(%ebp)
+    std::pair<std::string, unsigned> sig = dict.getSignature("ADDiodb");
+    std::vector<Exp*> actuals;
+    actuals.push_back(Location::memOf(new Binary(opPlus, Location::regOf(29), new Const(-8))));
+    actuals.push_back(new Const(4));
+    clock_t start = clock();
+    for (int i = 0; i < n; i++)
+        dict.instantiateRTL(sig.first, 0x8048000, actuals);
+    return seconds(start, clock());
+}
+
+// Two sets of size locations each, half of them in common
+static void makeLocationSets(LocationSet& a, LocationSet& b, int size)
+{
+    for (int i = 0; i < size; i++)
+        {
+            a.insert(Location::regOf(i));
+            b.insert(Location::regOf(i + size/2));
+        }
+}
+
+template <int SIZE>
+double benchLocationSetUnion(int n)
+{
+    LocationSet a, b;
+    makeLocationSets(a, b, SIZE);
+    std::vector<LocationSet> sets(n, a);
+    clock_t start = clock();
+    for (int i = 0; i < n; i++)
+        sets[i].makeUnion(b);
+    return seconds(start, clock());
+}
+
+// Two sets of size statements each, half of them in common. The statements are numbered in order, and are never freed
+static void makeStatementSets(StatementSet& a, StatementSet& b, int size)
+{
+    static std::vector<Statement*> stmts;
+    while ((int)stmts.size() < size + size/2)
+        stmts.push_back(new Assign(Location::regOf(24), new Const((int)stmts.size())));
+    for (int i = 0; i < size; i++)
+        {
+            a.insert(stmts[i]);
+            b.insert(stmts[i + size/2]);
+        }
+}
+
+// Run with and without USE_BITSET_STATEMENTSET to compare the two implementations
+template <int SIZE>
+double benchStatementSetUnion(int n)
+{
+    StatementSet a, b;
+    makeStatementSets(a, b, SIZE);
+    std::vector<StatementSet> sets(n, a);
+    clock_t start = clock();
+    for (int i = 0; i < n; i++)
+        sets[i].makeUnion(b);
+    return seconds(start, clock());
+}
+
+// Look up each statement of b in a; an iteration is one lookup
+template <int SIZE>
+double benchStatementSetExists(int n)
+{
+    StatementSet a, b;
+    makeStatementSets(a, b, SIZE);
+    std::vector<Statement*> look;
+    for (StatementSet::iterator it = b.begin(); it != b.end(); it++)
+        look.push_back(*it);
+    int found = 0;
+    for (int i = 0; i < SIZE; i++)
+        found += a.exists(look[i]);
+    if (found != SIZE/2) std::cerr << "StatementSet::exists is wrong!\n";
+    clock_t start = clock();
+    for (int i = 0; i < n; i++)
+        found += a.exists(look[i % SIZE]);
+    return seconds(start, clock());
+}
+
+/*==============================================================================
+ * Dataflow, on synthetic CFGs: a chain of SIZE diamonds, each arm defining some registers
+ *============================================================================*/
+
+static Prog* benchProg = NULL;
+
+static PBB newBB(Cfg* cfg, ADDRESS addr, BBTYPE type, int numOut, int reg)
+{
+    std::list<RTL*>* pRtls = new std::list<RTL*>;
+    RTL* rtl = new RTL(addr);
+    if (reg >= 0)
+        {
+            rtl->appendStmt(new Assign(Location::regOf(reg), new Binary(opPlus, Location::regOf(reg), new Const(1))));
+            rtl->appendStmt(new Assign(Location::regOf(reg + 1), Location::regOf(reg)));
+        }
+    if (type == RET)
+        rtl->appendStmt(new ReturnStatement);
+    pRtls->push_back(rtl);
+    return cfg->newBB(pRtls, type, numOut);
+}
+
+static UserProc* diamonds(int size)
+{
+    if (benchProg == NULL)
+        benchProg = new Prog;
+    std::string name("diamonds");
+    UserProc* proc = new UserProc(benchProg, name, 0x1000);
+    proc->setSignature(Signature::instantiate(PLAT_PENTIUM, CONV_C, "diamonds"));
+    Cfg* cfg = proc->getCFG();
+    ADDRESS addr = 0x1000;
+    PBB head = newBB(cfg, addr, TWOWAY, 2, 24);
+    cfg->setEntryBB(head);
+    for (int i = 0; i < size; i++)
+        {
+            PBB left = newBB(cfg, addr += 0x10, ONEWAY, 1, 24 + i % 4);
+            PBB right = newBB(cfg, addr += 0x10, ONEWAY, 1, 26 + i % 4);
+            bool last = i == size - 1;
+            PBB join = newBB(cfg, addr += 0x10, last ? RET : TWOWAY, last ? 0 : 2, 28);
+            cfg->addOutEdge(head, left);
+            cfg->addOutEdge(head, right);
+            cfg->addOutEdge(left, join);
+            cfg->addOutEdge(right, join);
+            head = join;
+        }
+    cfg->setExitBB(head);
+    proc->setDecoded();
+    proc->numberStatements();
+    return proc;
+}
+
+template <int SIZE>
+double benchDominators(int n)
+{
+    UserProc* proc = diamonds(SIZE);
+    double t = 0;
+    for (int i = 0; i < n; i++)
+        {
+            DataFlow df;		// Fresh each time: dominators() doesn't reset everything
+            clock_t start = clock();
+            df.dominators(proc->getCFG());
+            t += seconds(start, clock());
+        }
+    return t;
+}
+
+template <int SIZE>
+double benchPlacePhiFunctions(int n)
+{
+    double t = 0;
+    for (int i = 0; i < n; i++)
+        {
+            UserProc* proc = diamonds(SIZE);		// Phis get inserted, so start again each time
+            DataFlow df;
+            df.dominators(proc->getCFG());
+            clock_t start = clock();
+            df.placePhiFunctions(proc);
+            t += seconds(start, clock());
+        }
+    return t;
+}
+
+/*==============================================================================
+ * Decoder
+ *============================================================================*/
+
+static BinaryFileFactory decodeBff;
+static BinaryFile* decodeBF = NULL;
+static FrontEnd* decodeFE = NULL;
+static PentiumDecoder* decoder = NULL;
+static ptrdiff_t decodeDelta;				// From a native address to the host address of its copy, if copied
+
+// Load test/pentium/hello and make a decoder for it. The decoders keep host addresses in 32 bits, so text that was
+// loaded above 4GB is copied below 4GB, where the system allows that. Returns false if the text can't be decoded
+static bool loadDecodeText()
+{
+    static bool unusable = false;
+    if (decodeBF)
+        return true;
+    if (unusable)
+        return false;
+    unusable = true;
+    BinaryFile* pBF = decodeBff.Load(HELLO_PENTIUM);
+    if (pBF == NULL)
+        return false;
+    ADDRESS low = pBF->getLimitTextLow(), high = pBF->getLimitTextHigh();
+    decodeDelta = pBF->getTextDelta();
+    if ((unsigned long long)(low + decodeDelta) >> 32)
+        {
+#ifdef MAP_32BIT
+            void* copy = mmap(NULL, high - low, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+            if (copy == MAP_FAILED)
+                return false;
+            memcpy(copy, (char*)(low + decodeDelta), high - low);
+            decodeDelta = (char*)copy - (char*)low;
+#else
+            std::cerr << "the text of " HELLO_PENTIUM " is loaded above 4GB, where it can't be decoded\n";
+            return false;
+#endif
+        }
+    // The decoder looks up the procs that calls go to, so it needs a Prog with a front end
+    Prog* prog = new Prog;
+    decodeFE = new PentiumFrontEnd(pBF, prog, &decodeBff);
+    prog->setFrontEnd(decodeFE);
+    decoder = (PentiumDecoder*)decodeFE->getDecoder();
+    decodeBF = pBF;
+    unusable = false;
+    return true;
+}
+
+// Decode the whole text section of test/pentium/hello, n times over; a sweep counts as one iteration per instruction
+static double benchDecodeInstruction(int n)
+{
+    if (!loadDecodeText())
+        return -1;
+    ADDRESS low = decodeBF->getLimitTextLow(), high = decodeBF->getLimitTextHigh();
+    ptrdiff_t delta = decodeDelta;
+    ADDRESS pc = low;
+    clock_t start = clock();
+    for (int i = 0; i < n; i++)
+        {
+            DecodeResult& res = decoder->decodeInstruction(pc, delta);
+            pc += (res.valid && res.numBytes > 0) ? res.numBytes : 1;
+            if (pc >= high)
+                pc = low;
+            delete res.rtl;
+        }
+    return seconds(start, clock());
+}
+
+// As above, but take each instruction from a copy decoded beforehand, as FrontEnd does for its decode cache
+static double benchDecodeCacheHit(int n)
+{
+    static std::vector<DecodeResult*> cached;
+    if (!loadDecodeText())
+        return -1;
+    if (cached.empty())
+        {
+            ADDRESS low = decodeBF->getLimitTextLow(), high = decodeBF->getLimitTextHigh();
+            for (ADDRESS pc = low; pc < high; )
+                {
+                    DecodeResult& res = decoder->decodeInstruction(pc, decodeDelta);
+                    pc += (res.valid && res.numBytes > 0) ? res.numBytes : 1;
+                    if (res.valid && res.rtl)
+                        cached.push_back(new DecodeResult(res));
+                }
+        }
+    unsigned i = 0;
+    clock_t start = clock();
+    for (int j = 0; j < n; j++)
+        {
+            DecodeResult& res = decodeFE->reuseDecoded(*cached[i]);
+            if (++i == cached.size())
+                i = 0;
+            delete res.rtl;
+        }
+    return seconds(start, clock());
+}
+
+static Benchmark benchmarks[] =
+{
+    {"Exp::clone",						benchClone},
+    {"lessExpStar",						benchLessExpStar},
+    {"Exp::simplify",					benchSimplify},
+    {"Exp::polySimplify",				benchPolySimplify},
+    {"Exp::searchReplaceAll",			benchSearchReplace},
+    {"propagation facts, separate walks",	benchPropagationFactsSeparate},
+    {"propagation facts, FusedExpVisitor", benchPropagationFactsFused},
+    {"RTLInstDict::instantiateRTL",		benchInstantiateRTL},
+    {"LocationSet::makeUnion/16",		benchLocationSetUnion<16>},
+    {"LocationSet::makeUnion/256",		benchLocationSetUnion<256>},
+    {"StatementSet::makeUnion/16",		benchStatementSetUnion<16>},
+    {"StatementSet::makeUnion/256",		benchStatementSetUnion<256>},
+    {"StatementSet::exists/256",		benchStatementSetExists<256>},
+    {"DataFlow::dominators/16",			benchDominators<16>},
+    {"DataFlow::dominators/256",		benchDominators<256>},
+    {"DataFlow::dominators/4096",		benchDominators<4096>},
+    {"DataFlow::placePhiFunctions/16",	benchPlacePhiFunctions<16>},
+    {"DataFlow::placePhiFunctions/256",	benchPlacePhiFunctions<256>},
+    {"PentiumDecoder::decodeInstruction", benchDecodeInstruction},
+    {"FrontEnd::reuseDecoded",			benchDecodeCacheHit},
+    {NULL, NULL}
+};
+
+int main(int argc, char* argv[])
+{
+    double minTime = 0.2;
+    int arg = 1;
+    if (argc > arg + 1 && strcmp(argv[arg], "-t") == 0)
+        {
+            minTime = atof(argv[arg + 1]);
+            arg += 2;
+        }
+    if (argc > arg)
+        chdir(argv[arg++]);
+    const char* filter = argc > arg ? argv[arg] : NULL;
+    Boomerang::get()->setLogger(new NullLogger());
+
+    std::cout << std::left << std::setw(40) << "Benchmark" << std::right << std::setw(12) << "Iterations" <<
+              std::setw(14) << "ns/iteration" << "\n";
+    for (Benchmark* b = benchmarks; b->name; b++)
+        {
+            if (filter && strstr(b->name, filter) == NULL)
+                continue;
+            // Keep doubling the iterations until the measured part takes long enough to trust
+            int n = 1;
+            double t;
+            while ((t = b->func(n)) < minTime && t >= 0 && n < (1 << 26))
+                n *= t > 0 && t < minTime / 100 ? 16 : 2;
+            if (t < 0)
+                {
+                    std::cout << std::left << std::setw(40) << b->name << " skipped" << std::endl;
+                    continue;
+                }
+            std::cout << std::left << std::setw(40) << b->name << std::right << std::setw(12) << n <<
+                      std::setw(14) << std::fixed << std::setprecision(1) << t * 1e9 / n << std::endl;
+        }
+    return 0;
+}
@@ -24,6 +24,10 @@ protected:
 public:
     GenericExpTransformer(Exp *match, Exp *where, Exp *become) : match(match), where(where), become(become)
     { }
+    virtual Exp *getPattern()
+    {
+        return match;
+    }
     virtual Exp *applyTo(Exp *e, bool &bMod);
 };
 
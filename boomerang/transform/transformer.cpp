@@ -18,6 +18,7 @@
 #include <numeric>			// For accumulate
 #include <algorithm>		// For std::max()
 #include <map>				// In decideType()
+#include <vector>
 #include <sstream>			// Need gcc 3.0 or better
 #include "types.h"
 #include "statement.h"
@@ -30,58 +31,228 @@
 #include "transformer.h"
 #include "rdi.h"
 #include "log.h"
+#include "lock.h"
 #include "transformation-parser.h"
 
 std::list<ExpTransformer*> ExpTransformer::transformers;
 
 ExpTransformer::ExpTransformer()
 {
+    number = transformers.size();
     transformers.push_back(this);
 }
 
-std::list<Exp*> cache;
+/*
+ * The transformers are indexed with a discrimination tree. Each pattern is flattened to the sequence of its operators
+ * in preorder, with a wildcard for each variable (which stands for a whole subexpression), and the sequences are
+ * stored in a trie. Looking up an expression walks the trie with the expression's own operators, following both the
+ * operator's edge and the wildcard edge (which skips the whole subexpression). This finds every transformer whose
+ * pattern could match without trying them all; the transformer's applyTo() still decides.
+ */
+class DiscNode
+{
+public:
+    std::map<OPER, DiscNode*> next;		// Edge for each operator
+    DiscNode			*wild;				// Edge for a pattern variable
+    std::vector<ExpTransformer*> rules;		// Transformers whose patterns end here
+    DiscNode() : wild(NULL)
+    { }
+};
+
+static DiscNode discRoot;
+static unsigned numIndexed = 0;			// Number of transformers in the index (they are only ever added)
+
+// Add the preorder operators of pattern to keys, with opWild for the parts that can match anything
+static void flattenPattern(Exp *pattern, std::vector<OPER> &keys)
+{
+    OPER op = pattern->getOper();
+    switch (op)
+        {
+        case opVar:
+        case opWild:
+        case opWildIntConst:
+        case opWildStrConst:
+        case opWildMemOf:
+        case opWildRegOf:
+        case opWildAddrOf:
+            keys.push_back(opWild);
+            return;
+        default:
+            break;
+        }
+    keys.push_back(op);
+    int arity = pattern->getArity();
+    if (arity >= 1)
+        flattenPattern(pattern->getSubExp1(), keys);
+    if (arity >= 2)
+        flattenPattern(pattern->getSubExp2(), keys);
+    if (arity >= 3)
+        keys.push_back(opWild);		// Exp::match(Exp*) does not look at the third subexpression
+}
+
+static void indexTransformers(std::list<ExpTransformer*> &transformers)
+{
+    std::list<ExpTransformer*>::iterator it = transformers.begin();
+    for (unsigned i = 0; i < numIndexed; i++)
+        it++;
+    for (; it != transformers.end(); it++, numIndexed++)
+        {
+            DiscNode *n = &discRoot;
+            Exp *pattern = (*it)->getPattern();
+            if (pattern)
+                {
+                    std::vector<OPER> keys;
+                    flattenPattern(pattern, keys);
+                    for (unsigned i = 0; i < keys.size(); i++)
+                        {
+                            DiscNode *&child = keys[i] == opWild ? n->wild : n->next[keys[i]];
+                            if (child == NULL)
+                                child = new DiscNode;
+                            n = child;
+                        }
+                }
+            else
+                {
+                    // Could apply to anything: a wildcard for the whole expression
+                    if (n->wild == NULL)
+                        n->wild = new DiscNode;
+                    n = n->wild;
+                }
+            n->rules.push_back(*it);
+        }
+}
+
+// Find the transformers under n that could match the expressions in todo (the next to match is at the back)
+static void findTransformers(DiscNode *n, std::vector<Exp*> &todo, std::vector<ExpTransformer*> &found)
+{
+    if (todo.empty())
+        {
+            found.insert(found.end(), n->rules.begin(), n->rules.end());
+            return;
+        }
+    Exp *e = todo.back();
+    todo.pop_back();
+    if (n->wild)
+        findTransformers(n->wild, todo, found);
+    std::map<OPER, DiscNode*>::iterator it = n->next.find(e->getOper());
+    if (it != n->next.end())
+        {
+            unsigned mark = todo.size();
+            int arity = e->getArity();
+            if (arity >= 3)
+                todo.push_back(e->getSubExp3());
+            if (arity >= 2)
+                todo.push_back(e->getSubExp2());
+            if (arity >= 1)
+                todo.push_back(e->getSubExp1());
+            findTransformers(it->second, todo, found);
+            todo.resize(mark);
+        }
+    todo.push_back(e);
+}
+
+static bool lessNumber(ExpTransformer *a, ExpTransformer *b)
+{
+    return a->getNumber() < b->getNumber();
+}
+
+// The transformers that could change e, in the order they are to be applied
+static void candidates(Exp *e, std::vector<ExpTransformer*> &found)
+{
+    std::vector<Exp*> todo;
+    todo.push_back(e);
+    findTransformers(&discRoot, todo, found);
+    std::sort(found.begin(), found.end(), lessNumber);
+}
+
+// The results of applyAllTo, indexed by the hash of the original expression. When it reaches CACHE_SIZE entries it is
+// emptied, so that it does not grow without bound over a long decompilation
+#define CACHE_SIZE	4096
+struct CacheEntry
+{
+    Exp		*from;
+    Exp		*to;				// NULL if no transformer changed from
+};
+static std::multimap<unsigned, CacheEntry> cache;
+// Guards the index and the cache, since expressions are simplified on the code generation threads too. The index only
+// changes when transformers are added, which is never done on those threads
+static Mutex cacheMutex;
 
 Exp *ExpTransformer::applyAllTo(Exp *p, bool &bMod)
 {
-    for (std::list<Exp*>::iterator it = cache.begin(); it != cache.end(); it++)
-        if (*(*it)->getSubExp1() == *p)
-            return (*it)->getSubExp2()->clone();
-
-    Exp *e = p->clone();
-    Exp *subs[3];
-    subs[0] = e->getSubExp1();
-    subs[1] = e->getSubExp2();
-    subs[2] = e->getSubExp3();
-
-    for (int i = 0; i < 3; i++)
-        if (subs[i])
-            {
-                bool mod = false;
-                subs[i] = applyAllTo(subs[i], mod);
-                if (mod && i == 0)
-                    e->setSubExp1(subs[i]);
-                if (mod && i == 1)
-                    e->setSubExp2(subs[i]);
-                if (mod && i == 2)
-                    e->setSubExp3(subs[i]);
-                bMod |= mod;
-//			if (mod) i--;
-            }
+    unsigned h = p->hash();
+    {
+        Lock lock(cacheMutex);
+        if (numIndexed != transformers.size())
+            indexTransformers(transformers);
+        std::pair<std::multimap<unsigned, CacheEntry>::iterator, std::multimap<unsigned, CacheEntry>::iterator>
+            range = cache.equal_range(h);
+        for (std::multimap<unsigned, CacheEntry>::iterator it = range.first; it != range.second; it++)
+            if (*it->second.from == *p)
+                {
+                    if (it->second.to == NULL)
+                        return p;
+                    bMod = true;
+                    return it->second.to->clone();
+                }
+    }
+
+    // Transform the subexpressions first. p is only copied if one of them changes
+    Exp *e = p;
+    for (int i = 1; i <= e->getArity(); i++)
+        {
+            bool mod = false;
+            Exp *sub = i == 1 ? e->getSubExp1() : i == 2 ? e->getSubExp2() : e->getSubExp3();
+            sub = applyAllTo(sub, mod);
+            if (mod)
+                {
+                    if (e == p)
+                        e = p->clone();
+                    if (i == 1)
+                        e->setSubExp1(sub);
+                    else if (i == 2)
+                        e->setSubExp2(sub);
+                    else
+                        e->setSubExp3(sub);
+                    bMod = true;
+                }
+        }
 
 #if 0
     LOG << "applyAllTo called on " << e << "\n";
 #endif
-    bool mod;
-    //do {
-    mod = false;
-    for (std::list<ExpTransformer *>::iterator it = transformers.begin(); it != transformers.end(); it++)
+    // Each transformer gets one chance, in order. After a change, the transformers still to come are looked up again
+    // for the new expression
+    int last = -1;
+    bool changed = true;
+    while (changed)
         {
-            e = (*it)->applyTo(e, mod);
-            bMod |= mod;
+            changed = false;
+            std::vector<ExpTransformer*> found;
+            candidates(e, found);
+            for (unsigned i = 0; i < found.size(); i++)
+                {
+                    if (found[i]->getNumber() <= last)
+                        continue;
+                    last = found[i]->getNumber();
+                    bool mod = false;
+                    e = found[i]->applyTo(e, mod);
+                    if (mod)
+                        {
+                            bMod = true;
+                            changed = true;
+                            break;
+                        }
+                }
         }
-    //} while (mod);
 
-    cache.push_back(new Binary(opEquals, p->clone(), e->clone()));
+    CacheEntry entry;
+    entry.from = p->clone();
+    entry.to = e == p ? NULL : e->clone();
+    Lock lock(cacheMutex);
+    if (cache.size() >= CACHE_SIZE)
+        cache.clear();
+    cache.insert(std::pair<unsigned, CacheEntry>(h, entry));
     return e;
 }
 
@@ -81,6 +81,33 @@ void TypeTest::testNotEqual()
     CPPUNIT_ASSERT(t2 != t3);
 }
 
+/*==============================================================================
+ * FUNCTION:		TypeTest::testShared
+ * OVERVIEW:		Test that equal simple types share one instance
+ *============================================================================*/
+void TypeTest::testShared()
+{
+    Type* t1 = Type::getShared(IntegerType(32, -1));
+    Type* t2 = Type::getShared(IntegerType(32, -1));
+    Type* t3 = Type::getShared(IntegerType(32, 1));
+    Type* t4 = Type::getShared(FloatType(32));
+    CPPUNIT_ASSERT(t1 == t2);
+    CPPUNIT_ASSERT(t1 != t3);
+    CPPUNIT_ASSERT(t1 != t4);
+    CPPUNIT_ASSERT(*t1 == IntegerType(32, -1));
+    // Types that aren't simple are not shared
+    PointerType p(new CharType());
+    Type* t5 = Type::getShared(p);
+    CPPUNIT_ASSERT(t5 != &p);
+    CPPUNIT_ASSERT(t5 != Type::getShared(p));
+    CPPUNIT_ASSERT(*t5 == p);
+    // Nor are simple types of unusual sizes
+    IntegerType odd(24, 1);
+    Type* t6 = Type::getShared(odd);
+    CPPUNIT_ASSERT(t6 != Type::getShared(odd));
+    CPPUNIT_ASSERT(*t6 == odd);
+}
+
 /*==============================================================================
  * FUNCTION:		TypeTest::testNotEqual
  * OVERVIEW:		Test type inequality
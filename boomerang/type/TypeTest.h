@@ -5,6 +5,7 @@ class TypeTest : public CPPUNIT_NS::TestFixture
     CPPUNIT_TEST_SUITE(TypeTest);
     CPPUNIT_TEST(testTypeLong);
     CPPUNIT_TEST(testNotEqual);
+    CPPUNIT_TEST(testShared);
     CPPUNIT_TEST(testCompound);
     CPPUNIT_TEST(testDataInterval);
     CPPUNIT_TEST(testDataIntervalOverlaps);
@@ -17,6 +18,7 @@ public:
 protected:
     void testTypeLong();
     void testNotEqual();
+    void testShared();
     void testCompound();
 
     void testDataInterval();
@@ -75,7 +75,7 @@ void init_dfa()
 }
 
 
-static int progress = 0;
+static THREAD_LOCAL int progress = 0;
 void UserProc::dfaTypeAnalysis()
 {
     Boomerang::get()->alert_decompile_debug_point(this, "before dfa type analysis");
@@ -83,9 +83,9 @@ void UserProc::dfaTypeAnalysis()
     // First use the type information from the signature. Sometimes needed to split variables (e.g. argc as a
     // int and char* in sparc/switch_gcc)
     bool ch = signature->dfaTypeAnalysis(cfg);
-    StatementList stmts;
+    StatementVec stmts;
     getStatements(stmts);
-    StatementList::iterator it;
+    StatementVec::iterator it;
     int iter;
     for (iter = 1; iter <= DFA_ITER_LIMIT; iter++)
         {
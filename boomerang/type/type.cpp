@@ -36,6 +36,7 @@
 #include "signature.h"
 #include "boomerang.h"
 #include "log.h"
+#include "lock.h"
 #if defined(_MSC_VER) && _MSC_VER >= 1400
 #pragma warning(disable:4996)		// Warnings about e.g. _strdup deprecated in VS 2005
 #endif
@@ -518,14 +519,16 @@ bool FuncType::operator==(const Type& other) const
     return *signature == *((FuncType&)other).signature;
 }
 
-static int pointerCompareNest = 0;
+static THREAD_LOCAL int pointerCompareNest = 0;	// Types are compared on the code generation threads too
 bool PointerType::operator==(const Type& other) const
 {
 //	return other.isPointer() && (*points_to == *((PointerType&)other).points_to);
+    if (this == &other) return true;
     if (!other.isPointer()) return false;
     if (++pointerCompareNest >= 20)
         {
             std::cerr << "PointerType operator== nesting depth exceeded!\n";
+            pointerCompareNest--;
             return true;
         }
     bool ret = (*points_to == *((PointerType&)other).points_to);
@@ -535,6 +538,7 @@ bool PointerType::operator==(const Type& other) const
 
 bool ArrayType::operator==(const Type& other) const
 {
+    if (this == &other) return true;
     return other.isArray() && *base_type == *((ArrayType&)other).base_type &&
            ((ArrayType&)other).length == length;
 }
@@ -546,6 +550,7 @@ bool NamedType::operator==(const Type& other) const
 
 bool CompoundType::operator==(const Type& other) const
 {
+    if (this == &other) return true;
     const CompoundType &cother = (CompoundType&)other;
     if (other.isCompound() && cother.types.size() == types.size())
         {
@@ -559,6 +564,7 @@ bool CompoundType::operator==(const Type& other) const
 
 bool UnionType::operator==(const Type& other) const
 {
+    if (this == &other) return true;
     const UnionType &uother = (UnionType&)other;
     std::list<UnionElement>::const_iterator it1, it2;
     if (other.isUnion() && uother.li.size() == li.size())
@@ -1080,6 +1086,89 @@ Type *Type::getNamedType(const char *name)
     return NULL;
 }
 
+// The shared simple types, indexed by id, size and signedness. All of them are made before main() runs, and the table
+// is never changed after that, so the code generation threads can read it without a lock.
+// This is only a fixed table; types in general are not interned. Pointer, array, compound, union and func types are
+// always cloned, because meetWith changes its type in place (signedness votes, pointer bases, array lengths), and
+// operator< does not order all of them strictly, so they cannot be shared or used as keys
+typedef std::pair<int, std::pair<unsigned, int> > SharedTypeKey;
+class SharedTypes
+{
+    std::map<SharedTypeKey, Type*> types;
+
+    void		add(Type* ty)
+    {
+        SharedTypeKey key;
+        keyOf(*ty, key);
+        types[key] = ty;
+    }
+
+public:
+    SharedTypes();
+    // Set key to the index of ty; false if ty is not a simple type
+    static bool	keyOf(const Type& ty, SharedTypeKey& key);
+    Type*		find(const Type& ty)
+    {
+        SharedTypeKey key;
+        if (!keyOf(ty, key))
+            return NULL;
+        std::map<SharedTypeKey, Type*>::iterator ff = types.find(key);
+        return ff == types.end() ? NULL : ff->second;
+    }
+};
+
+SharedTypes::SharedTypes()
+{
+    add(new VoidType());
+    add(new BooleanType());
+    add(new CharType());
+    static const int intSizes[] = {1, 8, 16, 32, 64};
+    for (unsigned i = 0; i < sizeof(intSizes) / sizeof(intSizes[0]); i++)
+        {
+            for (int sign = -1; sign <= 1; sign++)
+                add(new IntegerType(intSizes[i], sign));
+            add(new SizeType(intSizes[i]));
+        }
+    static const int floatSizes[] = {32, 64, 80, 128};
+    for (unsigned i = 0; i < sizeof(floatSizes) / sizeof(floatSizes[0]); i++)
+        add(new FloatType(floatSizes[i]));
+}
+
+bool SharedTypes::keyOf(const Type& ty, SharedTypeKey& key)
+{
+    unsigned size = 0;
+    int sign = 0;
+    switch (ty.getId())
+        {
+        case eVoid:
+        case eBoolean:
+        case eChar:
+            break;
+        case eInteger:
+            size = ty.getSize();
+            sign = ((IntegerType&)ty).getSignedness();
+            break;
+        case eFloat:
+        case eSize:
+            size = ty.getSize();
+            break;
+        default:
+            return false;
+        }
+    key = SharedTypeKey(ty.getId(), std::pair<unsigned, int>(size, sign));
+    return true;
+}
+
+static SharedTypes sharedTypes;
+
+Type* Type::getShared(const Type& ty)
+{
+    Type* shared = sharedTypes.find(ty);
+    if (shared)
+        return shared;
+    return ty.clone();
+}
+
 void Type::dumpNames()
 {
     std::map<std::string, Type*>::iterator it;
@@ -57,7 +57,7 @@
  *============================================================================*/
 std::string operator+(const std::string& s, int i)
 {
-    static char buf[50];
+    char buf[50];
     std::string ret(s);
 
     sprintf(buf,"%d",i);